@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+
+# Generates the Unicode case mapping tables used by xkb_keysym_to_lower()
+# and friends in keysym.c.
+#
+# Only the simple (one-to-one) mappings are used. If a UnicodeData.txt is
+# given, they are taken from its fields 12 and 13; otherwise they are
+# derived from the unicodedata module of the running Python: the full
+# mappings of str.lower()/str.upper() are the simple ones whenever they
+# produce a single character, and the few exceptions are covered by the
+# titlecase mapping and U+0130.
+#
+# The mappings are stored as (lower - code, upper - code) deltas. Each
+# distinct pair of deltas is stored once; the code points are split into
+# blocks of BLOCK_SIZE, each distinct block of delta indices is stored
+# once, and a first-stage table maps code >> BLOCK_SHIFT to the block.
+
+import sys
+
+BLOCK_SHIFT = 6
+BLOCK_SIZE = 1 << BLOCK_SHIFT
+MAX_CODE = 0x10ffff
+
+
+def mappings_from_unicodedata_txt(path):
+    lower, upper = {}, {}
+    for line in open(path):
+        fields = line.split(';')
+        code = int(fields[0], 16)
+        if fields[12]:
+            upper[code] = int(fields[12], 16)
+        if fields[13]:
+            lower[code] = int(fields[13], 16)
+    return lower, upper
+
+
+def mappings_from_python():
+    import unicodedata
+    lower, upper = {}, {}
+    for code in range(MAX_CODE + 1):
+        if 0xd800 <= code <= 0xdfff:
+            continue
+        c = chr(code)
+        lo, up = c.lower(), c.upper()
+        if len(lo) == 1:
+            lower[code] = ord(lo)
+        elif code == 0x0130:
+            # LATIN CAPITAL LETTER I WITH DOT ABOVE -> i + COMBINING DOT
+            lower[code] = 0x0069
+        if len(up) == 1:
+            upper[code] = ord(up)
+        elif len(c.title()) == 1:
+            # E.g. GREEK SMALL LETTER ALPHA WITH PSILI AND YPOGEGRAMMENI.
+            upper[code] = ord(c.title())
+    return lower, upper, unicodedata.unidata_version
+
+
+if len(sys.argv) > 1:
+    lower, upper = mappings_from_unicodedata_txt(sys.argv[1])
+    source = sys.argv[1]
+else:
+    lower, upper, version = mappings_from_python()
+    source = 'Unicode {}'.format(version)
+
+deltas = [(lower.get(c, c) - c, upper.get(c, c) - c)
+          for c in range(MAX_CODE + 1)]
+last = max(c for c in range(MAX_CODE + 1) if deltas[c] != (0, 0))
+num_blocks = (last >> BLOCK_SHIFT) + 1
+
+pairs = {(0, 0): 0}
+for d in deltas[:num_blocks * BLOCK_SIZE]:
+    pairs.setdefault(d, len(pairs))
+if len(pairs) > 256:
+    sys.exit('too many distinct case mappings')
+
+blocks = {}
+block_index = []
+for b in range(num_blocks):
+    block = tuple(pairs[d]
+                  for d in deltas[b * BLOCK_SIZE:(b + 1) * BLOCK_SIZE])
+    block_index.append(blocks.setdefault(block, len(blocks)))
+if len(blocks) > 256:
+    sys.exit('too many distinct case mapping blocks')
+
+print('''
+/**
+ * This file comes from libxkbcommon and was generated by makecase.py
+ * from {source}.
+ * You can always fetch the latest version from:
+ * https://raw.github.com/xkbcommon/libxkbcommon/master/src/ks_case_tables.h
+ */
+'''.format(source=source))
+
+print('#define CASE_BLOCK_SHIFT {}'.format(BLOCK_SHIFT))
+print('#define CASE_MAX_CODE 0x{:x}'.format(last))
+print()
+
+print('/* { lower - code, upper - code } */')
+print('static const int32_t case_deltas[][2] = {')
+for (lo, up) in sorted(pairs, key=pairs.get):
+    print('    {{ {}, {} }},'.format(lo, up))
+print('};')
+print()
+
+print('static const uint8_t case_block_index[] = {')
+for i in range(0, len(block_index), 16):
+    print('    ' + ' '.join('{},'.format(v) for v in block_index[i:i+16]))
+print('};')
+print()
+
+print('static const uint8_t case_blocks[][{}] = {{'.format(BLOCK_SIZE))
+for block in sorted(blocks, key=blocks.get):
+    print('    {')
+    for i in range(0, BLOCK_SIZE, 16):
+        print('        ' + ' '.join('{},'.format(v) for v in block[i:i+16]))
+    print('    },')
+print('};')
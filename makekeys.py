@@ -1,4 +1,4 @@
-#!/usr/bin/env python
+#!/usr/bin/env python3
 
 import re, sys, itertools
 
@@ -46,6 +46,132 @@ print_entries(sorted(entries, key=lambda e: e[0].lower()))
 print('};\n')
 
 # *.sort() is stable so we always get the first keysym for duplicate
+keysym_to_name = [next(g[1]) for g in itertools.groupby(sorted(entries, key=lambda e: e[1]), key=lambda e: e[1])]
 print('static const struct name_keysym keysym_to_name[] = {')
-print_entries(next(g[1]) for g in itertools.groupby(sorted(entries, key=lambda e: e[1]), key=lambda e: e[1]))
+print_entries(keysym_to_name)
 print('};')
+
+# Minimal perfect hashes of the names, for xkb_keysym_from_name(): one
+# case-sensitive, over all the names, and one case-insensitive, over the
+# case-folded names, which maps to the first of the names that only
+# differ by case. Both must match keysym_name_hash() in keysym.c.
+# See "Hash, displace, and compress" (Belazzougui et al.); the
+# displacement of each bucket is searched in order of decreasing size.
+
+def fnv1a(name, fold):
+    h = 2166136261
+    for c in name.encode('ascii'):
+        if fold and ord('A') <= c <= ord('Z'):
+            c += ord('a') - ord('A')
+        h = ((h ^ c) * 16777619) & 0xffffffff
+    return h
+
+def mix(h):
+    h ^= h >> 16
+    h = (h * 0x85ebca6b) & 0xffffffff
+    h ^= h >> 13
+    h = (h * 0xc2b2ae35) & 0xffffffff
+    h ^= h >> 16
+    return h
+
+def perfect_hash(keys):
+    # keys: list of (hash, value)
+    n = len(keys)
+    num_buckets = (n + 3) // 4
+    buckets = [[] for _ in range(num_buckets)]
+    for (h, value) in keys:
+        buckets[h % num_buckets].append((h, value))
+    displacements = [0] * num_buckets
+    slots = [None] * n
+    for b in sorted(range(num_buckets), key=lambda b: -len(buckets[b])):
+        if not buckets[b]:
+            break
+        for d in range(0x10000):
+            positions = [mix(h ^ d) % n for (h, _) in buckets[b]]
+            if len(set(positions)) == len(positions) and \
+               all(slots[p] is None for p in positions):
+                break
+        else:
+            sys.exit('no displacement found for bucket {}'.format(b))
+        displacements[b] = d
+        for p, (_, value) in zip(positions, buckets[b]):
+            slots[p] = value
+    # Any remaining empty buckets keep displacement 0.
+    return displacements, slots
+
+def print_array(name, values):
+    print('static const uint16_t {}[] = {{'.format(name))
+    for i in range(0, len(values), 10):
+        print('    ' + ' '.join('{},'.format(v) for v in values[i:i+10]))
+    print('};')
+
+sorted_entries = sorted(entries, key=lambda e: e[0].lower())
+
+hashes = [fnv1a(name, False) for (name, _) in sorted_entries]
+if len(set(hashes)) != len(hashes):
+    sys.exit('keysym name hash collision')
+displacements, slots = perfect_hash([(h, i) for (i, h) in enumerate(hashes)])
+
+print()
+print_array('name_hash_displacements', displacements)
+print()
+print_array('name_hash_slots', slots)
+
+# The first name of each case-insensitive group; the groups are adjacent.
+groups = []
+for i, (name, _) in enumerate(sorted_entries):
+    if not groups or sorted_entries[groups[-1]][0].lower() != name.lower():
+        groups.append(i)
+hashes = [fnv1a(sorted_entries[i][0], True) for i in groups]
+if len(set(hashes)) != len(hashes):
+    sys.exit('keysym name hash collision')
+displacements, slots = perfect_hash(list(zip(hashes, groups)))
+
+print()
+print_array('name_icase_hash_displacements', displacements)
+print()
+print_array('name_icase_hash_slots', slots)
+
+# The names of keysym_to_name by keysym, for xkb_keysym_get_name(): the
+# legacy keysyms, below 0x10000, index it through pages by the high
+# byte, with 0 for none and else the index plus 1; the others through a
+# minimal perfect hash of the keysym, which must match keysym_hash() in
+# keysym.c. The lengths of the names are alongside.
+
+if len(keysym_to_name) >= 0x10000 or max(len(n) for (n, _) in entries) > 0xff:
+    sys.exit('keysym_to_name does not fit the indexes')
+
+print()
+print('static const uint8_t keysym_to_name_lengths[] = {')
+lengths = [len(name) for (name, _) in keysym_to_name]
+for i in range(0, len(lengths), 16):
+    print('    ' + ' '.join('{},'.format(v) for v in lengths[i:i+16]))
+print('};')
+
+pages = {}
+for i, (_, keysym) in enumerate(keysym_to_name):
+    if keysym < 0x10000:
+        pages.setdefault(keysym >> 8, []).append((keysym & 0xff, i + 1))
+for page, items in sorted(pages.items()):
+    print()
+    print('static const uint16_t keysym_name_page_{:02x}[256] = {{'.format(page))
+    for (low, value) in items:
+        print('    [0x{:02x}] = {},'.format(low, value))
+    print('};')
+print()
+print('static const uint16_t *const keysym_name_pages[] = {')
+for page in sorted(pages):
+    print('    [0x{0:02x}] = keysym_name_page_{0:02x},'.format(page))
+print('};')
+
+def keysym_hash(keysym):
+    return (keysym * 2654435761) & 0xffffffff
+
+displacements, slots = perfect_hash([(keysym_hash(keysym), i)
+                                     for i, (_, keysym) in enumerate(keysym_to_name)
+                                     if keysym >= 0x10000])
+
+print()
+print_array('keysym_hash_displacements', displacements)
+print()
+print_array('keysym_hash_slots', slots)
@@ -0,0 +1,390 @@
+/*
+ * Copyright © 2014 The libxkbcommon authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "archive.h"
+#include "darray.h"
+
+#define HEADER_SIZE 16
+#define ENTRY_SIZE 16
+
+static uint32_t
+read_le32(const char *p)
+{
+    const unsigned char *u = (const unsigned char *) p;
+    return (uint32_t) u[0] | (uint32_t) u[1] << 8 |
+           (uint32_t) u[2] << 16 | (uint32_t) u[3] << 24;
+}
+
+static void
+write_le32(char *p, uint32_t v)
+{
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+    p[2] = (v >> 16) & 0xff;
+    p[3] = (v >> 24) & 0xff;
+}
+
+struct entry {
+    const char *name;
+    uint32_t name_len;
+    const char *data;
+    uint32_t data_len;
+};
+
+static void
+get_entry(const struct xkb_archive *archive, uint32_t idx, struct entry *entry)
+{
+    const char *p = archive->map + HEADER_SIZE + (size_t) idx * ENTRY_SIZE;
+
+    entry->name = archive->map + read_le32(p);
+    entry->name_len = read_le32(p + 4);
+    entry->data = archive->map + read_le32(p + 8);
+    entry->data_len = read_le32(p + 12);
+}
+
+/* Byte-wise, like strcmp(). */
+static int
+cmp_names(const char *a, size_t a_len, const char *b, size_t b_len)
+{
+    int ret = memcmp(a, b, MIN(a_len, b_len));
+
+    if (ret != 0)
+        return ret;
+    return a_len < b_len ? -1 : a_len > b_len;
+}
+
+static bool
+archive_validate(const struct xkb_archive *archive)
+{
+    struct entry entry, prev;
+    const char *p = archive->map + HEADER_SIZE;
+
+    if ((archive->size - HEADER_SIZE) / ENTRY_SIZE < archive->num_entries)
+        return false;
+
+    for (uint32_t i = 0; i < archive->num_entries; i++, p += ENTRY_SIZE) {
+        uint32_t name_offset = read_le32(p);
+        uint32_t data_offset = read_le32(p + 8);
+
+        get_entry(archive, i, &entry);
+
+        if (name_offset > archive->size ||
+            entry.name_len >= archive->size - name_offset ||
+            entry.name[entry.name_len] != '\0' ||
+            data_offset > archive->size ||
+            entry.data_len > archive->size - data_offset)
+            return false;
+
+        if (i > 0 && cmp_names(prev.name, prev.name_len,
+                               entry.name, entry.name_len) >= 0)
+            return false;
+
+        prev = entry;
+    }
+
+    return true;
+}
+
+struct xkb_archive *
+xkb_archive_open(const char *path)
+{
+    FILE *file;
+    struct stat stat_buf;
+    struct xkb_archive *archive;
+    bool ok;
+
+    archive = calloc(1, sizeof(*archive));
+    if (!archive)
+        return NULL;
+
+    file = fopen(path, "rb");
+    if (!file) {
+        free(archive);
+        return NULL;
+    }
+
+    ok = fstat(fileno(file), &stat_buf) == 0 &&
+         map_file(file, &archive->map, &archive->size);
+    fclose(file);
+    if (!ok) {
+        free(archive);
+        return NULL;
+    }
+
+    archive->mtime = stat_buf.st_mtime;
+
+    if (archive->size < HEADER_SIZE ||
+        memcmp(archive->map, XKB_ARCHIVE_MAGIC, 8) != 0 ||
+        read_le32(archive->map + 8) != XKB_ARCHIVE_VERSION)
+        goto err;
+
+    archive->num_entries = read_le32(archive->map + 12);
+    if (!archive_validate(archive))
+        goto err;
+
+    return archive;
+
+err:
+    xkb_archive_close(archive);
+    return NULL;
+}
+
+void
+xkb_archive_close(struct xkb_archive *archive)
+{
+    if (!archive)
+        return;
+    unmap_file(archive->map, archive->size);
+    free(archive);
+}
+
+bool
+xkb_archive_find(const struct xkb_archive *archive, const char *dir,
+                 const char *name, const char **data_out, size_t *len_out)
+{
+    char key[PATH_MAX];
+    int key_len;
+    uint32_t lo = 0, hi = archive->num_entries;
+    struct entry entry;
+
+    key_len = snprintf(key, sizeof(key), "%s/%s", dir, name);
+    if (key_len < 0 || (size_t) key_len >= sizeof(key))
+        return false;
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        int cmp;
+
+        get_entry(archive, mid, &entry);
+        cmp = cmp_names(key, key_len, entry.name, entry.name_len);
+        if (cmp == 0) {
+            *data_out = entry.data;
+            *len_out = entry.data_len;
+            return true;
+        }
+
+        if (cmp < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    return false;
+}
+
+/***====================================================================***/
+
+struct pack_file {
+    /* Relative to the packed directory. */
+    char *name;
+    char *path;
+    uint32_t size;
+};
+
+typedef darray(struct pack_file) darray_pack_file;
+
+static int
+cmp_pack_files(const void *a, const void *b)
+{
+    return strcmp(((const struct pack_file *) a)->name,
+                  ((const struct pack_file *) b)->name);
+}
+
+static bool
+collect_files(darray_pack_file *files, const char *path,
+              const char *prefix)
+{
+    DIR *dir;
+    struct dirent *ent;
+    bool ok = true;
+
+    dir = opendir(path);
+    if (!dir)
+        return false;
+
+    while (ok && (ent = readdir(dir))) {
+        struct stat stat_buf;
+        struct pack_file file;
+
+        /* Also skips "." and "..". */
+        if (ent->d_name[0] == '.')
+            continue;
+
+        if (asprintf(&file.path, "%s/%s", path, ent->d_name) < 0) {
+            ok = false;
+            break;
+        }
+        if (asprintf(&file.name, "%s%s%s", prefix, prefix[0] ? "/" : "",
+                     ent->d_name) < 0) {
+            free(file.path);
+            ok = false;
+            break;
+        }
+
+        /*
+         * Only pack what could be included. Skip e.g. the "compiled" link
+         * of xkeyboard-config, which is often dangling, and don't follow
+         * links to directories, which may loop.
+         */
+        if (lstat(file.path, &stat_buf) != 0 ||
+            (S_ISLNK(stat_buf.st_mode) &&
+             (stat(file.path, &stat_buf) != 0 ||
+              !S_ISREG(stat_buf.st_mode))) ||
+            (S_ISREG(stat_buf.st_mode) && access(file.path, R_OK) != 0)) {
+            /* Skipped. */
+        }
+        else if (S_ISDIR(stat_buf.st_mode)) {
+            ok = collect_files(files, file.path, file.name);
+        }
+        else if (S_ISREG(stat_buf.st_mode)) {
+            if (stat_buf.st_size > UINT32_MAX) {
+                errno = EFBIG;
+                ok = false;
+            }
+            else {
+                file.size = stat_buf.st_size;
+                darray_append(*files, file);
+                continue;
+            }
+        }
+
+        free(file.path);
+        free(file.name);
+    }
+
+    closedir(dir);
+    return ok;
+}
+
+static bool
+copy_file(FILE *out, const char *path, uint32_t size)
+{
+    FILE *in;
+    const char *string;
+    size_t string_size;
+    bool ok;
+
+    /* Can't map an empty file. */
+    if (size == 0)
+        return true;
+
+    in = fopen(path, "rb");
+    if (!in)
+        return false;
+
+    ok = map_file(in, &string, &string_size);
+    fclose(in);
+    if (!ok)
+        return false;
+
+    /* The file must not have changed since it was stat'ed. */
+    if (string_size != size) {
+        errno = EAGAIN;
+        ok = false;
+    }
+    else {
+        ok = fwrite(string, size, 1, out) == 1;
+    }
+
+    unmap_file(string, string_size);
+    return ok;
+}
+
+bool
+xkb_archive_pack(const char *dir_path, const char *archive_path)
+{
+    darray_pack_file files = darray_new();
+    struct pack_file *file;
+    FILE *out = NULL;
+    char buf[ENTRY_SIZE];
+    uint64_t offset;
+    bool ok;
+
+    ok = collect_files(&files, dir_path, "");
+    if (!ok)
+        goto out;
+
+    if (!darray_empty(files))
+        qsort(darray_mem(files, 0), darray_size(files),
+              sizeof(struct pack_file), cmp_pack_files);
+
+    out = fopen(archive_path, "wb");
+    if (!out) {
+        ok = false;
+        goto out;
+    }
+
+    memcpy(buf, XKB_ARCHIVE_MAGIC, 8);
+    write_le32(buf + 8, XKB_ARCHIVE_VERSION);
+    ok = fwrite(buf, 12, 1, out) == 1;
+    write_le32(buf, darray_size(files));
+    ok = ok && fwrite(buf, 4, 1, out) == 1;
+
+    /* The names come after the entries, then the data. */
+    offset = HEADER_SIZE + (uint64_t) darray_size(files) * ENTRY_SIZE;
+    darray_foreach(file, files)
+        offset += strlen(file->name) + 1;
+
+    {
+        uint64_t name_offset =
+            HEADER_SIZE + (uint64_t) darray_size(files) * ENTRY_SIZE;
+        uint64_t data_offset = offset;
+
+        darray_foreach(file, files) {
+            write_le32(buf, name_offset);
+            write_le32(buf + 4, strlen(file->name));
+            write_le32(buf + 8, data_offset);
+            write_le32(buf + 12, file->size);
+            ok = ok && fwrite(buf, ENTRY_SIZE, 1, out) == 1;
+            name_offset += strlen(file->name) + 1;
+            data_offset += file->size;
+        }
+
+        if (data_offset > UINT32_MAX) {
+            errno = EFBIG;
+            ok = false;
+        }
+    }
+
+    darray_foreach(file, files)
+        ok = ok && fwrite(file->name, strlen(file->name) + 1, 1, out) == 1;
+
+    darray_foreach(file, files)
+        ok = ok && copy_file(out, file->path, file->size);
+
+out:
+    if (out && fclose(out) != 0)
+        ok = false;
+    if (!ok && out)
+        unlink(archive_path);
+    darray_foreach(file, files) {
+        free(file->name);
+        free(file->path);
+    }
+    darray_free(files);
+    return ok;
+}
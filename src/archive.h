@@ -0,0 +1,77 @@
+/*
+ * Copyright © 2014 The libxkbcommon authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include "utils.h"
+
+/*
+ * A packed archive of XKB data files, which may be added to the include
+ * path instead of a directory. It is mapped once, and the files are read
+ * directly from the mapping.
+ *
+ * All integers are 32 bit little endian. The file starts with a header:
+ *
+ *     magic "xkbarchv", version, number of entries
+ *
+ * followed by the entries, sorted by name (byte-wise):
+ *
+ *     name offset, name length, data offset, data length
+ *
+ * The offsets are from the start of the file. The names are paths relative
+ * to the include directory, e.g. "symbols/us" or "rules/evdev", and are
+ * followed by a NUL byte.
+ */
+
+#define XKB_ARCHIVE_MAGIC "xkbarchv"
+#define XKB_ARCHIVE_VERSION 1
+
+struct xkb_archive {
+    const char *map;
+    size_t size;
+    /* The mtime of the archive file when it was opened. */
+    int64_t mtime;
+    uint32_t num_entries;
+};
+
+/* Returns NULL if @path is not a valid archive. */
+struct xkb_archive *
+xkb_archive_open(const char *path);
+
+void
+xkb_archive_close(struct xkb_archive *archive);
+
+/* Find the file @dir/@name in the archive. */
+bool
+xkb_archive_find(const struct xkb_archive *archive, const char *dir,
+                 const char *name, const char **data_out, size_t *len_out);
+
+/*
+ * Pack all the files under the directory @dir_path into a new archive at
+ * @archive_path. On failure, errno is set.
+ */
+bool
+xkb_archive_pack(const char *dir_path, const char *archive_path);
+
+#endif
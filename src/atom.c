@@ -73,16 +73,61 @@
 #include "utils.h"
 #include "atom.h"
 
+/*
+ * The strings are stored NUL-terminated in blocks which are allocated as
+ * needed and never move, so that atom_text() stays valid. A string which
+ * is too long for a block gets a block of its own.
+ */
+#define ATOM_BLOCK_SIZE 4096
+
 struct atom_node {
-    xkb_atom_t left, right;
-    xkb_atom_t atom;
-    unsigned int fingerprint;
-    char *string;
+    uint32_t hash;
+    uint32_t len;
+    /* The block index and offset of the string in the arena. */
+    uint32_t block;
+    uint32_t offset;
 };
 
 struct atom_table {
-    xkb_atom_t root;
+    /* Indexed by atom. */
     darray(struct atom_node) table;
+    /* Open addressing with linear probing; XKB_ATOM_NONE is empty. */
+    xkb_atom_t *slots;
+    size_t slots_mask;
+    darray(char *) blocks;
+    /* Of the last block. */
+    size_t block_used, block_size;
+};
+
+static const char *const builtin_atoms[_ATOM_NUM_BUILTIN] = {
+    [ATOM_SHIFT] = "Shift",
+    [ATOM_LOCK] = "Lock",
+    [ATOM_CONTROL] = "Control",
+    [ATOM_MOD1] = "Mod1",
+    [ATOM_MOD2] = "Mod2",
+    [ATOM_MOD3] = "Mod3",
+    [ATOM_MOD4] = "Mod4",
+    [ATOM_MOD5] = "Mod5",
+    [ATOM_ONE_LEVEL] = "ONE_LEVEL",
+    [ATOM_TWO_LEVEL] = "TWO_LEVEL",
+    [ATOM_ALPHABETIC] = "ALPHABETIC",
+    [ATOM_KEYPAD] = "KEYPAD",
+    [ATOM_FOUR_LEVEL] = "FOUR_LEVEL",
+    [ATOM_FOUR_LEVEL_ALPHABETIC] = "FOUR_LEVEL_ALPHABETIC",
+    [ATOM_FOUR_LEVEL_SEMIALPHABETIC] = "FOUR_LEVEL_SEMIALPHABETIC",
+    [ATOM_FOUR_LEVEL_KEYPAD] = "FOUR_LEVEL_KEYPAD",
+    [ATOM_ACTION] = "action",
+    [ATOM_INTERPRET] = "interpret",
+    [ATOM_TYPE] = "type",
+    [ATOM_KEY] = "key",
+    [ATOM_GROUP] = "group",
+    [ATOM_MODIFIER_MAP] = "modifier_map",
+    [ATOM_INDICATOR] = "indicator",
+    [ATOM_DEFAULT] = "default",
+    [ATOM_STAR] = "*",
+    [ATOM_CAPS_LOCK] = "Caps Lock",
+    [ATOM_NUM_LOCK] = "Num Lock",
+    [ATOM_SCROLL_LOCK] = "Scroll Lock",
 };
 
 struct atom_table *
@@ -94,132 +139,206 @@ atom_table_new(void)
     if (!table)
         return NULL;
 
+    table->slots = calloc(256, sizeof(*table->slots));
+    if (!table->slots) {
+        free(table);
+        return NULL;
+    }
+    table->slots_mask = 256 - 1;
+
     darray_init(table->table);
-    /* The original throw-away root is here, at the illegal atom 0. */
+    darray_init(table->blocks);
+    /* The illegal atom 0. */
     darray_resize0(table->table, 1);
 
+    /* Atoms are numbered in order, so these get their enum values. */
+    for (xkb_atom_t atom = 1; atom < _ATOM_NUM_BUILTIN; atom++) {
+        const char *string = builtin_atoms[atom];
+
+        if (atom_intern(table, string, strlen(string), false) != atom) {
+            atom_table_free(table);
+            return NULL;
+        }
+    }
+
     return table;
 }
 
 void
 atom_table_free(struct atom_table *table)
 {
-    struct atom_node *node;
+    char **block;
 
     if (!table)
         return;
 
-    darray_foreach(node, table->table)
-        free(node->string);
+    darray_foreach(block, table->blocks)
+        free(*block);
+    darray_free(table->blocks);
     darray_free(table->table);
+    free(table->slots);
     free(table);
 }
 
+static inline const char *
+node_string(struct atom_table *table, const struct atom_node *node)
+{
+    return darray_item(table->blocks, node->block) + node->offset;
+}
+
 const char *
 atom_text(struct atom_table *table, xkb_atom_t atom)
 {
     if (atom == XKB_ATOM_NONE || atom >= darray_size(table->table))
         return NULL;
 
-    return darray_item(table->table, atom).string;
+    return node_string(table, &darray_item(table->table, atom));
+}
+
+/* FNV-1a, with a final avalanche since the low bits index the slots. */
+static uint32_t
+hash_string(const char *string, size_t len)
+{
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < len; i++)
+        hash = (hash ^ (unsigned char) string[i]) * 16777619u;
+
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    return hash;
+}
+
+/* Returns the slot of the atom, or the empty slot where it would go. */
+static xkb_atom_t *
+find_slot(struct atom_table *table, const char *string, size_t len,
+          uint32_t hash)
+{
+    size_t pos = hash & table->slots_mask;
+
+    while (table->slots[pos] != XKB_ATOM_NONE) {
+        const struct atom_node *node =
+            &darray_item(table->table, table->slots[pos]);
+
+        if (node->hash == hash && node->len == len &&
+            memcmp(node_string(table, node), string, len) == 0)
+            break;
+
+        pos = (pos + 1) & table->slots_mask;
+    }
+
+    return &table->slots[pos];
 }
 
 static bool
-find_atom_pointer(struct atom_table *table, const char *string, size_t len,
-                  xkb_atom_t **atomp_out, unsigned int *fingerprint_out)
+grow_slots(struct atom_table *table)
 {
-    xkb_atom_t *atomp = &table->root;
-    unsigned int fingerprint = 0;
-    bool found = false;
+    size_t new_mask = table->slots_mask * 2 + 1;
+    xkb_atom_t *new_slots;
+
+    new_slots = calloc(new_mask + 1, sizeof(*new_slots));
+    if (!new_slots)
+        return false;
 
-    for (size_t i = 0; i < (len + 1) / 2; i++) {
-        fingerprint = fingerprint * 27 + string[i];
-        fingerprint = fingerprint * 27 + string[len - 1 - i];
+    for (xkb_atom_t atom = 1; atom < darray_size(table->table); atom++) {
+        size_t pos = darray_item(table->table, atom).hash & new_mask;
+
+        while (new_slots[pos] != XKB_ATOM_NONE)
+            pos = (pos + 1) & new_mask;
+        new_slots[pos] = atom;
     }
 
-    while (*atomp != XKB_ATOM_NONE) {
-        struct atom_node *node = &darray_item(table->table, *atomp);
+    free(table->slots);
+    table->slots = new_slots;
+    table->slots_mask = new_mask;
+    return true;
+}
 
-        if (fingerprint < node->fingerprint) {
-            atomp = &node->left;
-        }
-        else if (fingerprint > node->fingerprint) {
-            atomp = &node->right;
-        }
-        else {
-            /* Now start testing the strings. */
-            const int cmp = strncmp(string, node->string, len);
-            if (cmp < 0 || (cmp == 0 && len < strlen(node->string))) {
-                atomp = &node->left;
-            }
-            else if (cmp > 0) {
-                atomp = &node->right;
-            }
-            else {
-                found = true;
-                break;
-            }
-        }
+/* Copy the string into the arena. */
+static bool
+store_string(struct atom_table *table, const char *string, size_t len,
+             struct atom_node *node)
+{
+    char *block;
+
+    if (len + 1 > table->block_size - table->block_used) {
+        size_t size = MAX(len + 1, ATOM_BLOCK_SIZE);
+
+        block = malloc(size);
+        if (!block)
+            return false;
+
+        darray_append(table->blocks, block);
+        table->block_used = 0;
+        table->block_size = size;
     }
 
-    if (fingerprint_out)
-        *fingerprint_out = fingerprint;
-    if (atomp_out)
-        *atomp_out = atomp;
-    return found;
+    node->block = darray_size(table->blocks) - 1;
+    node->offset = table->block_used;
+    block = darray_item(table->blocks, node->block);
+    memcpy(block + node->offset, string, len);
+    block[node->offset + len] = '\0';
+    table->block_used += len + 1;
+
+    return true;
 }
 
 xkb_atom_t
 atom_lookup(struct atom_table *table, const char *string, size_t len)
 {
-    xkb_atom_t *atomp;
-
     if (!string)
         return XKB_ATOM_NONE;
 
-    if (!find_atom_pointer(table, string, len, &atomp, NULL))
-        return XKB_ATOM_NONE;
-
-    return *atomp;
+    return *find_slot(table, string, len, hash_string(string, len));
 }
 
 /*
  * If steal is true, we do not strdup @string; therefore it must be
  * dynamically allocated, NUL-terminated, not be free'd by the caller
  * and not be used afterwards. Use to avoid some redundant allocations.
+ * (It is copied into the arena nonetheless, but freed right away.)
  */
 xkb_atom_t
 atom_intern(struct atom_table *table, const char *string, size_t len,
             bool steal)
 {
-    xkb_atom_t *atomp;
+    xkb_atom_t *slot;
     struct atom_node node;
-    unsigned int fingerprint;
+    uint32_t hash;
 
     if (!string)
         return XKB_ATOM_NONE;
 
-    if (find_atom_pointer(table, string, len, &atomp, &fingerprint)) {
+    hash = hash_string(string, len);
+    slot = find_slot(table, string, len, hash);
+    if (*slot != XKB_ATOM_NONE) {
         if (steal)
             free(UNCONSTIFY(string));
-        return *atomp;
+        return *slot;
     }
 
-    if (steal) {
-        node.string = UNCONSTIFY(string);
-    }
-    else {
-        node.string = strndup(string, len);
-        if (!node.string)
-            return XKB_ATOM_NONE;
+    /* Keep the load factor at most 1/2. */
+    if ((darray_size(table->table) + 1) * 2 > table->slots_mask + 1) {
+        if (!grow_slots(table))
+            goto err;
+        slot = find_slot(table, string, len, hash);
     }
 
-    node.left = node.right = XKB_ATOM_NONE;
-    node.fingerprint = fingerprint;
-    node.atom = darray_size(table->table);
-    /* Do this before the append, as it may realloc and change the offsets. */
-    *atomp = node.atom;
+    node.hash = hash;
+    node.len = len;
+    if (!store_string(table, string, len, &node))
+        goto err;
+
+    *slot = darray_size(table->table);
     darray_append(table->table, node);
 
-    return node.atom;
+    if (steal)
+        free(UNCONSTIFY(string));
+    return *slot;
+
+err:
+    if (steal)
+        free(UNCONSTIFY(string));
+    return XKB_ATOM_NONE;
 }
@@ -28,6 +28,47 @@ typedef uint32_t xkb_atom_t;
 
 #define XKB_ATOM_NONE 0
 
+/*
+ * Well-known names, which are interned first in every atom table, so they
+ * can be used as constants without a lookup.
+ */
+enum builtin_atom {
+    /* The real modifiers, in order. */
+    ATOM_SHIFT = 1,
+    ATOM_LOCK,
+    ATOM_CONTROL,
+    ATOM_MOD1,
+    ATOM_MOD2,
+    ATOM_MOD3,
+    ATOM_MOD4,
+    ATOM_MOD5,
+    /* The automatic key types. */
+    ATOM_ONE_LEVEL,
+    ATOM_TWO_LEVEL,
+    ATOM_ALPHABETIC,
+    ATOM_KEYPAD,
+    ATOM_FOUR_LEVEL,
+    ATOM_FOUR_LEVEL_ALPHABETIC,
+    ATOM_FOUR_LEVEL_SEMIALPHABETIC,
+    ATOM_FOUR_LEVEL_KEYPAD,
+    /* Statement keywords. */
+    ATOM_ACTION,
+    ATOM_INTERPRET,
+    ATOM_TYPE,
+    ATOM_KEY,
+    ATOM_GROUP,
+    ATOM_MODIFIER_MAP,
+    ATOM_INDICATOR,
+    ATOM_DEFAULT,
+    /* The default key name. */
+    ATOM_STAR,
+    /* Common LED names. */
+    ATOM_CAPS_LOCK,
+    ATOM_NUM_LOCK,
+    ATOM_SCROLL_LOCK,
+    _ATOM_NUM_BUILTIN
+};
+
 struct atom_table;
 
 struct atom_table *
@@ -32,6 +32,7 @@
 #include "xkbcommon/xkbcommon.h"
 #include "utils.h"
 #include "context.h"
+#include "keymap.h"
 
 unsigned int
 xkb_context_num_failed_include_paths(struct xkb_context *ctx)
@@ -49,28 +50,67 @@ xkb_context_failed_include_path_get(struct xkb_context *ctx,
     return darray_item(ctx->failed_includes, idx);
 }
 
+static inline void
+atom_lock(struct xkb_context *ctx)
+{
+    if (ctx->thread_safe)
+        pthread_mutex_lock(&ctx->atom_lock);
+}
+
+static inline void
+atom_unlock(struct xkb_context *ctx)
+{
+    if (ctx->thread_safe)
+        pthread_mutex_unlock(&ctx->atom_lock);
+}
+
 xkb_atom_t
 xkb_atom_lookup(struct xkb_context *ctx, const char *string)
 {
-    return atom_lookup(ctx->atom_table, string, strlen(string));
+    xkb_atom_t atom;
+
+    atom_lock(ctx);
+    atom = atom_lookup(ctx->atom_table, string, strlen(string));
+    atom_unlock(ctx);
+
+    return atom;
 }
 
 xkb_atom_t
 xkb_atom_intern(struct xkb_context *ctx, const char *string, size_t len)
 {
-    return atom_intern(ctx->atom_table, string, len, false);
+    xkb_atom_t atom;
+
+    atom_lock(ctx);
+    atom = atom_intern(ctx->atom_table, string, len, false);
+    atom_unlock(ctx);
+
+    return atom;
 }
 
 xkb_atom_t
 xkb_atom_steal(struct xkb_context *ctx, char *string)
 {
-    return atom_intern(ctx->atom_table, string, strlen(string), true);
+    xkb_atom_t atom;
+
+    atom_lock(ctx);
+    atom = atom_intern(ctx->atom_table, string, strlen(string), true);
+    atom_unlock(ctx);
+
+    return atom;
 }
 
+/* The strings never move, so they can be used after unlocking. */
 const char *
 xkb_atom_text(struct xkb_context *ctx, xkb_atom_t atom)
 {
-    return atom_text(ctx->atom_table, atom);
+    const char *text;
+
+    atom_lock(ctx);
+    text = atom_text(ctx->atom_table, atom);
+    atom_unlock(ctx);
+
+    return text;
 }
 
 void
@@ -87,19 +127,33 @@ xkb_log(struct xkb_context *ctx, enum xkb_log_level level, int verbosity,
     va_end(args);
 }
 
+#ifdef THREAD_LOCAL
+static THREAD_LOCAL char thread_text_buffer[2048];
+static THREAD_LOCAL size_t thread_text_next;
+#endif
+
 char *
 xkb_context_get_buffer(struct xkb_context *ctx, size_t size)
 {
+    char *buffer = ctx->text_buffer;
+    size_t *next = &ctx->text_next;
     char *rtrn;
 
+#ifdef THREAD_LOCAL
+    if (ctx->thread_safe) {
+        buffer = thread_text_buffer;
+        next = &thread_text_next;
+    }
+#endif
+
     if (size >= sizeof(ctx->text_buffer))
         return NULL;
 
-    if (sizeof(ctx->text_buffer) - ctx->text_next <= size)
-        ctx->text_next = 0;
+    if (sizeof(ctx->text_buffer) - *next <= size)
+        *next = 0;
 
-    rtrn = &ctx->text_buffer[ctx->text_next];
-    ctx->text_next += size;
+    rtrn = &buffer[*next];
+    *next += size;
 
     return rtrn;
 }
@@ -188,3 +242,198 @@ xkb_context_sanitize_rule_names(struct xkb_context *ctx,
     if (rmlvo->options == NULL)
         rmlvo->options = xkb_context_get_default_options(ctx);
 }
+
+static int
+cmp_strings(const void *a, const void *b)
+{
+    return strcmp(*(char *const *) a, *(char *const *) b);
+}
+
+/*
+ * Normalize a comma-separated RMLVO value, such that values which the rules
+ * treat the same compare equal: spaces are stripped, and if @is_set (as for
+ * the options, whose order does not matter), the entries are also sorted
+ * and empty and duplicate entries are dropped.
+ */
+static char *
+normalize_rmlvo_list(const char *value, bool is_set)
+{
+    darray(char *) entries = darray_new();
+    darray_char out = darray_new();
+    char **entry;
+    const char *s, *end;
+
+    if (!value)
+        value = "";
+
+    for (s = value; ; s = end + 1) {
+        const char *start;
+        char *tmp;
+
+        end = strchr(s, ',');
+        if (!end)
+            end = s + strlen(s);
+
+        while (s < end && *s == ' ')
+            s++;
+        start = s;
+        s = end;
+        while (s > start && s[-1] == ' ')
+            s--;
+
+        if (!is_set || s > start) {
+            tmp = strndup(start, s - start);
+            if (!tmp)
+                goto err;
+            darray_append(entries, tmp);
+        }
+
+        if (*end == '\0')
+            break;
+    }
+
+    if (is_set && !darray_empty(entries))
+        qsort(darray_mem(entries, 0), darray_size(entries),
+              sizeof(char *), cmp_strings);
+
+    darray_foreach(entry, entries) {
+        if (is_set && entry != &darray_item(entries, 0) &&
+            streq(*entry, entry[-1]))
+            continue;
+        /* Not by whether out is empty, as leading entries may be. */
+        if (entry != &darray_item(entries, 0))
+            darray_append(out, ',');
+        darray_append_string(out, *entry);
+    }
+    darray_append(out, '\0');
+
+    darray_foreach(entry, entries)
+        free(*entry);
+    darray_free(entries);
+    return out.item;
+
+err:
+    darray_foreach(entry, entries)
+        free(*entry);
+    darray_free(entries);
+    darray_free(out);
+    return NULL;
+}
+
+static void
+keymap_cache_entry_free(struct keymap_cache_entry *entry)
+{
+    free(entry->rules);
+    free(entry->model);
+    free(entry->layout);
+    free(entry->variant);
+    free(entry->options);
+}
+
+static bool
+keymap_cache_entry_init(struct keymap_cache_entry *entry,
+                        const struct xkb_rule_names *rmlvo,
+                        enum xkb_keymap_compile_flags flags)
+{
+    entry->rules = strdup(rmlvo->rules ? rmlvo->rules : "");
+    entry->model = normalize_rmlvo_list(rmlvo->model, false);
+    entry->layout = normalize_rmlvo_list(rmlvo->layout, false);
+    entry->variant = normalize_rmlvo_list(rmlvo->variant, false);
+    entry->options = normalize_rmlvo_list(rmlvo->options, true);
+    entry->flags = flags;
+    entry->keymap = NULL;
+
+    if (!entry->rules || !entry->model || !entry->layout ||
+        !entry->variant || !entry->options) {
+        keymap_cache_entry_free(entry);
+        return false;
+    }
+
+    return true;
+}
+
+struct xkb_keymap *
+xkb_context_find_cached_keymap(struct xkb_context *ctx,
+                               const struct xkb_rule_names *rmlvo,
+                               enum xkb_keymap_compile_flags flags)
+{
+    struct keymap_cache_entry key, *entry;
+    struct xkb_keymap *keymap = NULL;
+
+    if (!keymap_cache_entry_init(&key, rmlvo, flags))
+        return NULL;
+
+    xkb_context_lock(ctx);
+
+    darray_foreach(entry, ctx->keymap_cache) {
+        if (entry->flags == key.flags &&
+            streq(entry->rules, key.rules) &&
+            streq(entry->model, key.model) &&
+            streq(entry->layout, key.layout) &&
+            streq(entry->variant, key.variant) &&
+            streq(entry->options, key.options) &&
+            /* Skip a keymap whose last reference is being dropped. */
+            refcnt_inc_not_zero(&entry->keymap->refcnt)) {
+            keymap = entry->keymap;
+            break;
+        }
+    }
+
+    xkb_context_unlock(ctx);
+
+    keymap_cache_entry_free(&key);
+    return keymap;
+}
+
+void
+xkb_context_cache_keymap(struct xkb_context *ctx,
+                         const struct xkb_rule_names *rmlvo,
+                         enum xkb_keymap_compile_flags flags,
+                         struct xkb_keymap *keymap)
+{
+    struct keymap_cache_entry entry;
+
+    /* Not being able to cache is not an error. */
+    if (!keymap_cache_entry_init(&entry, rmlvo, flags))
+        return;
+
+    entry.keymap = keymap;
+    xkb_context_lock(ctx);
+    darray_append(ctx->keymap_cache, entry);
+    xkb_context_unlock(ctx);
+}
+
+void
+xkb_context_uncache_keymap(struct xkb_context *ctx,
+                           struct xkb_keymap *keymap)
+{
+    unsigned i;
+
+    xkb_context_lock(ctx);
+
+    for (i = 0; i < darray_size(ctx->keymap_cache); i++) {
+        struct keymap_cache_entry *entry = &darray_item(ctx->keymap_cache, i);
+
+        if (entry->keymap != keymap)
+            continue;
+
+        keymap_cache_entry_free(entry);
+        /* Order doesn't matter, so move the last entry into the hole. */
+        *entry = darray_item(ctx->keymap_cache,
+                             darray_size(ctx->keymap_cache) - 1);
+        darray_resize(ctx->keymap_cache, darray_size(ctx->keymap_cache) - 1);
+        break;
+    }
+
+    xkb_context_unlock(ctx);
+}
+
+void
+xkb_context_clear_keymap_cache(struct xkb_context *ctx)
+{
+    struct keymap_cache_entry *entry;
+
+    darray_foreach(entry, ctx->keymap_cache)
+        keymap_cache_entry_free(entry);
+    darray_free(ctx->keymap_cache);
+}
@@ -32,9 +32,10 @@
 #include "xkbcommon/xkbcommon.h"
 #include "utils.h"
 #include "context.h"
+#include "archive.h"
 
 /**
- * Append one directory to the context's include path.
+ * Append one directory, or packed archive, to the context's include path.
  */
 XKB_EXPORT int
 xkb_context_include_path_append(struct xkb_context *ctx, const char *path)
@@ -42,6 +43,7 @@ xkb_context_include_path_append(struct xkb_context *ctx, const char *path)
     struct stat stat_buf;
     int err;
     char *tmp;
+    struct xkb_archive *archive = NULL;
 
     tmp = strdup(path);
     if (!tmp)
@@ -50,18 +52,31 @@ xkb_context_include_path_append(struct xkb_context *ctx, const char *path)
     err = stat(path, &stat_buf);
     if (err != 0)
         goto err;
-    if (!S_ISDIR(stat_buf.st_mode))
-        goto err;
+
+    if (S_ISREG(stat_buf.st_mode)) {
+        archive = xkb_archive_open(path);
+        if (!archive) {
+            log_err(ctx, "%s is not a valid XKB archive\n", path);
+            goto err;
+        }
+    }
+    else {
+        if (!S_ISDIR(stat_buf.st_mode))
+            goto err;
 
 #if defined(HAVE_EACCESS)
-    if (eaccess(path, R_OK | X_OK) != 0)
-        goto err;
+        if (eaccess(path, R_OK | X_OK) != 0)
+            goto err;
 #elif defined(HAVE_EUIDACCESS)
-    if (euidaccess(path, R_OK | X_OK) != 0)
-        goto err;
+        if (euidaccess(path, R_OK | X_OK) != 0)
+            goto err;
 #endif
+    }
 
     darray_append(ctx->includes, tmp);
+    darray_append(ctx->include_archives, archive);
+    /* Cached keymaps may now resolve differently. */
+    xkb_context_clear_keymap_cache(ctx);
     return 1;
 
 err:
@@ -101,6 +116,7 @@ XKB_EXPORT void
 xkb_context_include_path_clear(struct xkb_context *ctx)
 {
     char **path;
+    struct xkb_archive **archive;
 
     darray_foreach(path, ctx->includes)
         free(*path);
@@ -109,6 +125,13 @@ xkb_context_include_path_clear(struct xkb_context *ctx)
     darray_foreach(path, ctx->failed_includes)
         free(*path);
     darray_free(ctx->failed_includes);
+
+    darray_foreach(archive, ctx->include_archives)
+        xkb_archive_close(*archive);
+    darray_free(ctx->include_archives);
+
+    xkb_context_clear_include_dirs(ctx);
+    xkb_context_clear_keymap_cache(ctx);
 }
 
 /**
@@ -143,13 +166,29 @@ xkb_context_include_path_get(struct xkb_context *ctx, unsigned int idx)
     return darray_item(ctx->includes, idx);
 }
 
+/**
+ * Set the function which provides files before the include path is
+ * searched.
+ */
+XKB_EXPORT void
+xkb_context_set_include_fn(struct xkb_context *ctx,
+                           int (*include_fn)(struct xkb_context *ctx,
+                                             const char *type,
+                                             const char *name,
+                                             const char **buffer_out,
+                                             size_t *length_out))
+{
+    ctx->include_fn = include_fn;
+    xkb_context_clear_keymap_cache(ctx);
+}
+
 /**
  * Take a new reference on the context.
  */
 XKB_EXPORT struct xkb_context *
 xkb_context_ref(struct xkb_context *ctx)
 {
-    ctx->refcnt++;
+    refcnt_inc(&ctx->refcnt);
     return ctx;
 }
 
@@ -160,11 +199,17 @@ xkb_context_ref(struct xkb_context *ctx)
 XKB_EXPORT void
 xkb_context_unref(struct xkb_context *ctx)
 {
-    if (!ctx || --ctx->refcnt > 0)
+    if (!ctx || !refcnt_dec(&ctx->refcnt))
         return;
 
     xkb_context_include_path_clear(ctx);
+    xkb_context_clear_rules_cache(ctx);
     atom_table_free(ctx->atom_table);
+    free(ctx->x11_atom_cache);
+    if (ctx->thread_safe) {
+        pthread_mutex_destroy(&ctx->lock);
+        pthread_mutex_destroy(&ctx->atom_lock);
+    }
     free(ctx);
 }
 
@@ -241,13 +286,42 @@ XKB_EXPORT struct xkb_context *
 xkb_context_new(enum xkb_context_flags flags)
 {
     const char *env;
-    struct xkb_context *ctx = calloc(1, sizeof(*ctx));
+    struct xkb_context *ctx;
 
+#ifndef THREAD_LOCAL
+    /* The *Text() functions need a buffer per thread. */
+    if (flags & XKB_CONTEXT_THREAD_SAFE)
+        return NULL;
+#endif
+
+    ctx = calloc(1, sizeof(*ctx));
     if (!ctx)
         return NULL;
 
     ctx->refcnt = 1;
     ctx->log_fn = default_log_fn;
+
+    if (flags & XKB_CONTEXT_THREAD_SAFE) {
+        pthread_mutexattr_t attr;
+
+        /* The log function may be called with the lock held. */
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+        if (pthread_mutex_init(&ctx->lock, &attr) != 0) {
+            pthread_mutexattr_destroy(&attr);
+            free(ctx);
+            return NULL;
+        }
+        pthread_mutexattr_destroy(&attr);
+
+        if (pthread_mutex_init(&ctx->atom_lock, NULL) != 0) {
+            pthread_mutex_destroy(&ctx->lock);
+            free(ctx);
+            return NULL;
+        }
+
+        ctx->thread_safe = true;
+    }
     ctx->log_level = XKB_LOG_LEVEL_ERROR;
     ctx->log_verbosity = 0;
 
@@ -269,6 +343,7 @@ xkb_context_new(enum xkb_context_flags flags)
     }
 
     ctx->use_environment_names = !(flags & XKB_CONTEXT_NO_ENVIRONMENT_NAMES);
+    ctx->cache_keymaps = !!(flags & XKB_CONTEXT_CACHE_KEYMAPS);
 
     ctx->atom_table = atom_table_new();
     if (!ctx->atom_table) {
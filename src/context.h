@@ -26,8 +26,32 @@
 #ifndef CONTEXT_H
 #define CONTEXT_H
 
+#include <pthread.h>
+
 #include "atom.h"
 
+/* A compiled rules file; see xkbcomp/rules.c. */
+struct rules_db;
+
+/* A packed archive of XKB data files; see archive.h. */
+struct xkb_archive;
+
+/* An index of an include directory; see xkbcomp/include.c. */
+struct include_dir;
+
+/* A keymap compiled from RMLVO names, as kept by the keymap cache. */
+struct keymap_cache_entry {
+    /* Normalized names; see normalize_rmlvo_list(). */
+    char *rules;
+    char *model;
+    char *layout;
+    char *variant;
+    char *options;
+    enum xkb_keymap_compile_flags flags;
+    /* Not referenced; removed from the cache when freed. */
+    struct xkb_keymap *keymap;
+};
+
 struct xkb_context {
     int refcnt;
 
@@ -41,17 +65,60 @@ struct xkb_context {
     struct xkb_rule_names names_dflt;
 
     darray(char *) includes;
+    int (*include_fn)(struct xkb_context *ctx, const char *type,
+                      const char *name, const char **buffer_out,
+                      size_t *length_out);
     darray(char *) failed_includes;
+    /* By include path index; NULL if the entry is a directory. */
+    darray(struct xkb_archive *) include_archives;
+    /* By include path index * _FILE_TYPE_NUM_ENTRIES + file type. */
+    darray(struct include_dir *) include_dirs;
+    unsigned int include_generation;
 
     struct atom_table *atom_table;
 
-    /* Buffer for the *Text() functions. */
+    /*
+     * Buffer for the *Text() functions. Thread-safe contexts use a buffer
+     * per thread instead.
+     */
     char text_buffer[2048];
     size_t text_next;
 
+    darray(struct keymap_cache_entry) keymap_cache;
+
+    /* Rules files compiled so far, so that each is only parsed once. */
+    darray(struct rules_db *) rules_dbs;
+
+    /* Used and allocated by libxkbcommon-x11, free()d here. */
+    void *x11_atom_cache;
+
+    /*
+     * If thread_safe, @lock protects the keymap cache, the include
+     * directory indexes, the rules files and the X11 atom cache, and
+     * @atom_lock the atom table. The atom lock is never held while taking the other.
+     */
+    pthread_mutex_t lock;
+    pthread_mutex_t atom_lock;
+
     unsigned int use_environment_names : 1;
+    unsigned int cache_keymaps : 1;
+    unsigned int thread_safe : 1;
 };
 
+static inline void
+xkb_context_lock(struct xkb_context *ctx)
+{
+    if (ctx->thread_safe)
+        pthread_mutex_lock(&ctx->lock);
+}
+
+static inline void
+xkb_context_unlock(struct xkb_context *ctx)
+{
+    if (ctx->thread_safe)
+        pthread_mutex_unlock(&ctx->lock);
+}
+
 unsigned int
 xkb_context_num_failed_include_paths(struct xkb_context *ctx);
 
@@ -95,6 +162,45 @@ void
 xkb_context_sanitize_rule_names(struct xkb_context *ctx,
                                 struct xkb_rule_names *rmlvo);
 
+/*
+ * Returns a keymap previously compiled from the same (sanitized) names and
+ * flags, if one is still alive, with a new reference; otherwise NULL.
+ */
+struct xkb_keymap *
+xkb_context_find_cached_keymap(struct xkb_context *ctx,
+                               const struct xkb_rule_names *rmlvo,
+                               enum xkb_keymap_compile_flags flags);
+
+void
+xkb_context_cache_keymap(struct xkb_context *ctx,
+                         const struct xkb_rule_names *rmlvo,
+                         enum xkb_keymap_compile_flags flags,
+                         struct xkb_keymap *keymap);
+
+/* Does nothing if @keymap is not in the cache. */
+void
+xkb_context_uncache_keymap(struct xkb_context *ctx,
+                           struct xkb_keymap *keymap);
+
+/* Forget all cached keymaps; they stay valid, but are not shared anymore. */
+void
+xkb_context_clear_keymap_cache(struct xkb_context *ctx);
+
+/* Free the include directory indexes. */
+void
+xkb_context_clear_include_dirs(struct xkb_context *ctx);
+
+/*
+ * Make the include directory indexes be revalidated against the file
+ * system the next time they are used. Called before each compilation.
+ */
+void
+xkb_context_invalidate_include_dirs(struct xkb_context *ctx);
+
+/* Free the rules files compiled with this context. */
+void
+xkb_context_clear_rules_cache(struct xkb_context *ctx);
+
 /*
  * The format is not part of the argument list in order to avoid the
  * "ISO C99 requires rest arguments to be used" warning when only the
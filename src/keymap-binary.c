@@ -0,0 +1,915 @@
+/*
+ * Copyright © 2014 The libxkbcommon authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * The XKB_KEYMAP_FORMAT_BINARY_V1 format: a compiled keymap, stored field
+ * by field, so that it can be loaded back without going through the
+ * parser and compiler.
+ *
+ * All numbers are unsigned LEB128 varints (signed ones zigzag-encoded),
+ * so the format does not depend on the byte order or the word size. The
+ * layout is:
+ *
+ *      "xkbB" version:uint size:uint strings body
+ *
+ * where size is the number of bytes in strings and body. The strings
+ * are a count followed by that many length-prefixed strings, and hold the
+ * atoms of the keymap; the body refers to them by their index plus one,
+ * with 0 standing for XKB_ATOM_NONE. The body follows the order of the
+ * fields in struct xkb_keymap; see write_keymap().
+ *
+ * Groups which share their levels with an earlier group are stored as a
+ * reference to that group, so that the loaded keymap shares them too.
+ */
+
+#include "keymap.h"
+#include "darray.h"
+
+#define BINARY_MAGIC "xkbB"
+#define BINARY_MAGIC_SIZE 4
+#define BINARY_VERSION 1
+
+#define GROUP_EXPLICIT_TYPE (1 << 0)
+#define GROUP_SHARED_LEVELS (1 << 1)
+
+struct writer {
+    darray_char body;
+    /* The atoms in the order they are first used. */
+    darray(xkb_atom_t) atoms;
+    /* Index + 1 into atoms, by atom. */
+    darray(uint32_t) atom_refs;
+};
+
+static void
+write_uint(struct writer *w, uint32_t value)
+{
+    char bytes[5];
+    unsigned n = 0;
+
+    while (value >= 0x80) {
+        bytes[n++] = (char) (value | 0x80);
+        value >>= 7;
+    }
+    bytes[n++] = (char) value;
+
+    darray_append_items(w->body, bytes, n);
+}
+
+static void
+write_int(struct writer *w, int32_t value)
+{
+    write_uint(w, value < 0 ? ((uint32_t) ~value << 1) | 1
+                            : (uint32_t) value << 1);
+}
+
+static void
+write_atom(struct writer *w, xkb_atom_t atom)
+{
+    if (atom == XKB_ATOM_NONE) {
+        write_uint(w, 0);
+        return;
+    }
+
+    if (atom >= darray_size(w->atom_refs))
+        darray_resize0(w->atom_refs, atom + 1);
+
+    if (darray_item(w->atom_refs, atom) == 0) {
+        darray_append(w->atoms, atom);
+        darray_item(w->atom_refs, atom) = darray_size(w->atoms);
+    }
+
+    write_uint(w, darray_item(w->atom_refs, atom));
+}
+
+/* Section names are not atoms; they are stored in place, or as 0 if NULL. */
+static void
+write_string(struct writer *w, const char *string)
+{
+    size_t len;
+
+    if (!string) {
+        write_uint(w, 0);
+        return;
+    }
+
+    len = strlen(string);
+    write_uint(w, len + 1);
+    darray_append_items(w->body, string, len);
+}
+
+static void
+write_mods(struct writer *w, const struct xkb_mods *mods)
+{
+    write_uint(w, mods->mods);
+    write_uint(w, mods->mask);
+}
+
+static void
+write_action(struct writer *w, const union xkb_action *action)
+{
+    write_uint(w, action->type);
+
+    switch (action->type) {
+    case ACTION_TYPE_NONE:
+    case ACTION_TYPE_TERMINATE:
+        break;
+    case ACTION_TYPE_MOD_SET:
+    case ACTION_TYPE_MOD_LATCH:
+    case ACTION_TYPE_MOD_LOCK:
+        write_uint(w, action->mods.flags);
+        write_mods(w, &action->mods.mods);
+        break;
+    case ACTION_TYPE_GROUP_SET:
+    case ACTION_TYPE_GROUP_LATCH:
+    case ACTION_TYPE_GROUP_LOCK:
+        write_uint(w, action->group.flags);
+        write_int(w, action->group.group);
+        break;
+    case ACTION_TYPE_PTR_MOVE:
+        write_uint(w, action->ptr.flags);
+        write_int(w, action->ptr.x);
+        write_int(w, action->ptr.y);
+        break;
+    case ACTION_TYPE_PTR_BUTTON:
+    case ACTION_TYPE_PTR_LOCK:
+        write_uint(w, action->btn.flags);
+        write_uint(w, action->btn.count);
+        write_uint(w, action->btn.button);
+        break;
+    case ACTION_TYPE_PTR_DEFAULT:
+        write_uint(w, action->dflt.flags);
+        write_int(w, action->dflt.value);
+        break;
+    case ACTION_TYPE_SWITCH_VT:
+        write_uint(w, action->screen.flags);
+        write_int(w, action->screen.screen);
+        break;
+    case ACTION_TYPE_CTRL_SET:
+    case ACTION_TYPE_CTRL_LOCK:
+        write_uint(w, action->ctrls.flags);
+        write_uint(w, action->ctrls.ctrls);
+        break;
+    case ACTION_TYPE_PRIVATE:
+    default:
+        darray_append_items(w->body, (const char *) action->priv.data,
+                            sizeof(action->priv.data));
+        break;
+    }
+}
+
+static void
+write_level(struct writer *w, const struct xkb_level *level)
+{
+    union xkb_action action;
+
+    XkbUnpackAction(&action, &level->action);
+    write_action(w, &action);
+
+    write_uint(w, level->num_syms);
+    if (level->num_syms == 1)
+        write_uint(w, level->u.sym);
+    else
+        for (unsigned i = 0; i < level->num_syms; i++)
+            write_uint(w, level->u.syms[i]);
+}
+
+struct level_owner {
+    const struct xkb_level *levels;
+    xkb_keycode_t keycode;
+    xkb_layout_index_t group;
+};
+
+static void
+write_keys(struct writer *w, const struct xkb_keymap *keymap)
+{
+    darray(struct level_owner) owners = darray_new();
+    const struct level_owner *owner;
+    const struct xkb_key *key;
+
+    write_uint(w, keymap->min_key_code);
+    write_uint(w, keymap->max_key_code);
+
+    xkb_keys_foreach(key, keymap) {
+        write_atom(w, key->name);
+        write_uint(w, key->explicit);
+        write_uint(w, key->modmap);
+        write_uint(w, key->vmodmap);
+        write_uint(w, key->repeats);
+        write_uint(w, key->out_of_range_group_action);
+        /* A redirect to a group the key doesn't have goes to the first. */
+        write_uint(w, key->out_of_range_group_number < key->num_groups ?
+                      key->out_of_range_group_number : 0);
+
+        write_uint(w, key->num_groups);
+        for (xkb_layout_index_t i = 0; i < key->num_groups; i++) {
+            const struct xkb_group *group = &key->groups[i];
+            unsigned flags = 0;
+
+            /* The owner is the first group with these levels. */
+            owner = NULL;
+            if (group->shared_levels)
+                darray_foreach(owner, owners)
+                    if (owner->levels == group->levels)
+                        break;
+            if (owner == darray_mem(owners, darray_size(owners)))
+                owner = NULL;
+
+            if (group->explicit_type)
+                flags |= GROUP_EXPLICIT_TYPE;
+            if (owner)
+                flags |= GROUP_SHARED_LEVELS;
+            write_uint(w, flags);
+            write_uint(w, group->type - keymap->types);
+
+            if (owner) {
+                write_uint(w, owner->keycode);
+                write_uint(w, owner->group);
+                continue;
+            }
+
+            for (xkb_level_index_t j = 0; j < XkbKeyGroupWidth(key, i); j++)
+                write_level(w, &group->levels[j]);
+
+            darray_append(owners, (struct level_owner) {
+                group->levels, key->keycode, i
+            });
+        }
+    }
+
+    darray_free(owners);
+}
+
+static void
+write_keymap(struct writer *w, const struct xkb_keymap *keymap)
+{
+    const struct xkb_mod *mod;
+    const struct xkb_led *led;
+
+    write_uint(w, keymap->enabled_ctrls);
+
+    write_string(w, keymap->keycodes_section_name);
+    write_string(w, keymap->types_section_name);
+    write_string(w, keymap->compat_section_name);
+    write_string(w, keymap->symbols_section_name);
+
+    write_uint(w, keymap->mods.num_mods);
+    xkb_mods_foreach(mod, &keymap->mods) {
+        write_atom(w, mod->name);
+        write_uint(w, mod->type);
+        write_uint(w, mod->mapping);
+    }
+
+    write_uint(w, keymap->num_types);
+    for (unsigned i = 0; i < keymap->num_types; i++) {
+        const struct xkb_key_type *type = &keymap->types[i];
+
+        write_atom(w, type->name);
+        write_mods(w, &type->mods);
+        write_uint(w, type->num_levels);
+        for (xkb_level_index_t j = 0; j < type->num_levels; j++)
+            write_atom(w, type->level_names ?
+                          type->level_names[j] : XKB_ATOM_NONE);
+        write_uint(w, type->num_entries);
+        for (unsigned j = 0; j < type->num_entries; j++) {
+            write_uint(w, type->entries[j].level);
+            write_mods(w, &type->entries[j].mods);
+            write_mods(w, &type->entries[j].preserve);
+        }
+    }
+
+    write_uint(w, keymap->num_sym_interprets);
+    for (unsigned i = 0; i < keymap->num_sym_interprets; i++) {
+        const struct xkb_sym_interpret *interp = &keymap->sym_interprets[i];
+
+        write_uint(w, interp->sym);
+        write_uint(w, interp->match);
+        write_uint(w, interp->mods);
+        write_uint(w, interp->virtual_mod);
+        write_action(w, &interp->action);
+        write_uint(w, interp->level_one_only);
+        write_uint(w, interp->repeat);
+    }
+
+    write_uint(w, keymap->num_leds);
+    xkb_leds_foreach(led, keymap) {
+        write_atom(w, led->name);
+        write_uint(w, led->which_groups);
+        write_uint(w, led->groups);
+        write_uint(w, led->which_mods);
+        write_mods(w, &led->mods);
+        write_uint(w, led->ctrls);
+    }
+
+    write_uint(w, keymap->num_groups);
+    write_uint(w, keymap->num_group_names);
+    for (xkb_layout_index_t i = 0; i < keymap->num_group_names; i++)
+        write_atom(w, keymap->group_names[i]);
+
+    write_uint(w, keymap->num_key_aliases);
+    for (unsigned i = 0; i < keymap->num_key_aliases; i++) {
+        write_atom(w, keymap->key_aliases[i].real);
+        write_atom(w, keymap->key_aliases[i].alias);
+    }
+
+    write_keys(w, keymap);
+}
+
+static bool
+binary_v1_keymap_write(struct xkb_keymap *keymap,
+                       int (*write_fn)(void *user_data, const char *data,
+                                       size_t length),
+                       void *user_data)
+{
+    struct writer w = { darray_new(), darray_new(), darray_new() };
+    darray_char head, strings, body;
+    xkb_atom_t *atom;
+    bool ok;
+
+    write_keymap(&w, keymap);
+    body = w.body;
+
+    /* Now that all of the atoms are known, they can go in front. */
+    darray_init(w.body);
+    write_uint(&w, darray_size(w.atoms));
+    darray_foreach(atom, w.atoms) {
+        const char *text = xkb_atom_text(keymap->ctx, *atom);
+        size_t len = strlen(text);
+
+        write_uint(&w, len);
+        darray_append_items(w.body, text, len);
+    }
+    strings = w.body;
+
+    darray_init(w.body);
+    darray_append_items(w.body, BINARY_MAGIC, BINARY_MAGIC_SIZE);
+    write_uint(&w, BINARY_VERSION);
+    write_uint(&w, darray_size(strings) + darray_size(body));
+    head = w.body;
+
+    ok = write_fn(user_data, darray_mem(head, 0), darray_size(head)) &&
+         write_fn(user_data, darray_mem(strings, 0), darray_size(strings)) &&
+         write_fn(user_data, darray_mem(body, 0), darray_size(body));
+
+    darray_free(head);
+    darray_free(strings);
+    darray_free(body);
+    darray_free(w.atoms);
+    darray_free(w.atom_refs);
+    return ok;
+}
+
+struct binary_string {
+    const char *data;
+    uint32_t len;
+    xkb_atom_t atom;
+};
+
+/*
+ * The keymap may come from another process, so nothing is trusted. Every
+ * read past the end or of a bad value sets the error flag, after which
+ * the reads return 0 and the loading fails.
+ */
+struct reader {
+    struct xkb_context *ctx;
+    const unsigned char *pos;
+    const unsigned char *end;
+    bool error;
+    struct binary_string *strings;
+    uint32_t num_strings;
+};
+
+static uint32_t
+read_uint(struct reader *r)
+{
+    uint32_t value = 0;
+
+    for (unsigned shift = 0; shift < 32 && r->pos < r->end; shift += 7) {
+        uint8_t byte = *r->pos++;
+
+        /* The last byte only has room for 4 bits. */
+        if (shift == 28 && byte > 0x0f)
+            break;
+
+        value |= (uint32_t) (byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+
+    r->error = true;
+    r->pos = r->end;
+    return 0;
+}
+
+static int32_t
+read_int(struct reader *r)
+{
+    uint32_t value = read_uint(r);
+
+    return value & 1 ? ~(int32_t) (value >> 1) : (int32_t) (value >> 1);
+}
+
+/*
+ * Read the number of some items which follow. Every item takes at least
+ * one byte, which bounds what the allocations can be made to take.
+ */
+static uint32_t
+read_count(struct reader *r)
+{
+    uint32_t count = read_uint(r);
+
+    if (count > (size_t) (r->end - r->pos)) {
+        r->error = true;
+        r->pos = r->end;
+        return 0;
+    }
+
+    return count;
+}
+
+static bool
+read_bool(struct reader *r)
+{
+    uint32_t value = read_uint(r);
+
+    if (value > 1)
+        r->error = true;
+
+    return value;
+}
+
+static xkb_atom_t
+read_atom(struct reader *r)
+{
+    struct binary_string *string;
+    uint32_t ref = read_uint(r);
+
+    if (ref == 0)
+        return XKB_ATOM_NONE;
+
+    if (ref > r->num_strings) {
+        r->error = true;
+        return XKB_ATOM_NONE;
+    }
+
+    string = &r->strings[ref - 1];
+    if (string->atom == XKB_ATOM_NONE)
+        string->atom = xkb_atom_intern(r->ctx, string->data, string->len);
+
+    return string->atom;
+}
+
+static char *
+read_string(struct reader *r)
+{
+    uint32_t len = read_count(r);
+    char *string;
+
+    if (len == 0)
+        return NULL;
+
+    string = strndup((const char *) r->pos, len - 1);
+    r->pos += len - 1;
+    return string;
+}
+
+static void
+read_mods(struct reader *r, struct xkb_mods *mods)
+{
+    mods->mods = read_uint(r);
+    mods->mask = read_uint(r);
+}
+
+static void
+read_action(struct reader *r, union xkb_action *action)
+{
+    uint32_t type = read_uint(r);
+
+    memset(action, 0, sizeof(*action));
+
+    /* Private actions may have any type which fits in a byte. */
+    if (type > 255) {
+        r->error = true;
+        return;
+    }
+    action->type = type;
+
+    switch (action->type) {
+    case ACTION_TYPE_NONE:
+    case ACTION_TYPE_TERMINATE:
+        break;
+    case ACTION_TYPE_MOD_SET:
+    case ACTION_TYPE_MOD_LATCH:
+    case ACTION_TYPE_MOD_LOCK:
+        action->mods.flags = read_uint(r);
+        read_mods(r, &action->mods.mods);
+        break;
+    case ACTION_TYPE_GROUP_SET:
+    case ACTION_TYPE_GROUP_LATCH:
+    case ACTION_TYPE_GROUP_LOCK:
+        action->group.flags = read_uint(r);
+        action->group.group = read_int(r);
+        break;
+    case ACTION_TYPE_PTR_MOVE:
+        action->ptr.flags = read_uint(r);
+        action->ptr.x = read_int(r);
+        action->ptr.y = read_int(r);
+        break;
+    case ACTION_TYPE_PTR_BUTTON:
+    case ACTION_TYPE_PTR_LOCK:
+        action->btn.flags = read_uint(r);
+        action->btn.count = read_uint(r);
+        action->btn.button = read_uint(r);
+        break;
+    case ACTION_TYPE_PTR_DEFAULT:
+        action->dflt.flags = read_uint(r);
+        action->dflt.value = read_int(r);
+        break;
+    case ACTION_TYPE_SWITCH_VT:
+        action->screen.flags = read_uint(r);
+        action->screen.screen = read_int(r);
+        break;
+    case ACTION_TYPE_CTRL_SET:
+    case ACTION_TYPE_CTRL_LOCK:
+        action->ctrls.flags = read_uint(r);
+        action->ctrls.ctrls = read_uint(r);
+        break;
+    case ACTION_TYPE_PRIVATE:
+    default:
+        if (sizeof(action->priv.data) > (size_t) (r->end - r->pos)) {
+            r->error = true;
+            break;
+        }
+        memcpy(action->priv.data, r->pos, sizeof(action->priv.data));
+        r->pos += sizeof(action->priv.data);
+        break;
+    }
+}
+
+static bool
+read_level(struct reader *r, struct xkb_level *level)
+{
+    union xkb_action action;
+    unsigned int num_syms;
+
+    read_action(r, &action);
+    XkbPackAction(&level->action, &action);
+
+    num_syms = read_count(r);
+    if (num_syms == 1) {
+        level->u.sym = read_uint(r);
+    }
+    else if (num_syms > 1) {
+        level->u.syms = calloc(num_syms, sizeof(*level->u.syms));
+        if (!level->u.syms)
+            return false;
+        for (unsigned i = 0; i < num_syms; i++)
+            level->u.syms[i] = read_uint(r);
+    }
+    level->num_syms = num_syms;
+
+    return !r->error;
+}
+
+static bool
+read_group(struct reader *r, struct xkb_keymap *keymap,
+           struct xkb_key *key, xkb_layout_index_t idx)
+{
+    struct xkb_group *group = &key->groups[idx];
+    uint32_t flags, type;
+    xkb_level_index_t width;
+
+    flags = read_uint(r);
+    type = read_uint(r);
+    if (r->error || type >= keymap->num_types ||
+        (flags & ~(GROUP_EXPLICIT_TYPE | GROUP_SHARED_LEVELS)))
+        return false;
+
+    group->explicit_type = (flags & GROUP_EXPLICIT_TYPE);
+    group->type = &keymap->types[type];
+    width = group->type->num_levels;
+
+    if (flags & GROUP_SHARED_LEVELS) {
+        /* Must be an earlier group, which owns its levels. */
+        xkb_keycode_t kc = read_uint(r);
+        xkb_layout_index_t owner_idx = read_uint(r);
+        const struct xkb_key *owner_key;
+        const struct xkb_group *owner;
+
+        if (r->error || kc < keymap->min_key_code || kc > key->keycode ||
+            (kc == key->keycode && owner_idx >= idx))
+            return false;
+
+        owner_key = &keymap->keys[kc];
+        if (owner_idx >= owner_key->num_groups)
+            return false;
+
+        owner = &owner_key->groups[owner_idx];
+        if (!owner->levels || owner->shared_levels ||
+            owner->type->num_levels != width)
+            return false;
+
+        group->levels = owner->levels;
+        group->shared_levels = true;
+        return true;
+    }
+
+    group->levels = calloc(width, sizeof(*group->levels));
+    if (!group->levels)
+        return false;
+
+    for (xkb_level_index_t i = 0; i < width; i++)
+        if (!read_level(r, &group->levels[i]))
+            return false;
+
+    return true;
+}
+
+static bool
+read_keys(struct reader *r, struct xkb_keymap *keymap)
+{
+    xkb_keycode_t min_key_code, max_key_code;
+    struct xkb_key *key;
+
+    min_key_code = read_uint(r);
+    max_key_code = read_uint(r);
+    if (r->error || min_key_code > max_key_code ||
+        max_key_code > XKB_KEYCODE_MAX ||
+        max_key_code - min_key_code >= (size_t) (r->end - r->pos))
+        return false;
+
+    keymap->keys = calloc((size_t) max_key_code + 1, sizeof(*keymap->keys));
+    if (!keymap->keys)
+        return false;
+    keymap->min_key_code = min_key_code;
+    keymap->max_key_code = max_key_code;
+
+    xkb_keys_foreach(key, keymap) {
+        key->keycode = key - keymap->keys;
+        key->name = read_atom(r);
+        key->explicit = read_uint(r);
+        key->modmap = read_uint(r);
+        key->vmodmap = read_uint(r);
+        key->repeats = read_bool(r);
+        key->out_of_range_group_action = read_uint(r);
+        key->out_of_range_group_number = read_uint(r);
+        if (key->out_of_range_group_action > RANGE_REDIRECT)
+            return false;
+
+        key->num_groups = read_count(r);
+        if (r->error || key->num_groups > keymap->num_groups ||
+            (key->out_of_range_group_number > 0 &&
+             key->out_of_range_group_number >= key->num_groups))
+            return false;
+        if (key->num_groups == 0)
+            continue;
+
+        key->groups = calloc(key->num_groups, sizeof(*key->groups));
+        if (!key->groups)
+            return false;
+
+        for (xkb_layout_index_t i = 0; i < key->num_groups; i++)
+            if (!read_group(r, keymap, key, i))
+                return false;
+    }
+
+    return !r->error;
+}
+
+static bool
+read_keymap(struct reader *r, struct xkb_keymap *keymap)
+{
+    struct xkb_mod *mod;
+    struct xkb_led *led;
+    uint32_t count;
+
+    keymap->enabled_ctrls = read_uint(r);
+
+    keymap->keycodes_section_name = read_string(r);
+    keymap->types_section_name = read_string(r);
+    keymap->compat_section_name = read_string(r);
+    keymap->symbols_section_name = read_string(r);
+
+    count = read_count(r);
+    if (count > XKB_MAX_MODS)
+        return false;
+    keymap->mods.num_mods = count;
+    xkb_mods_foreach(mod, &keymap->mods) {
+        mod->name = read_atom(r);
+        mod->type = read_uint(r);
+        mod->mapping = read_uint(r);
+        if (mod->type != MOD_REAL && mod->type != MOD_VIRT)
+            return false;
+    }
+
+    count = read_count(r);
+    if (count > 0) {
+        keymap->types = calloc(count, sizeof(*keymap->types));
+        if (!keymap->types)
+            return false;
+        keymap->num_types = count;
+    }
+    for (unsigned i = 0; i < keymap->num_types; i++) {
+        struct xkb_key_type *type = &keymap->types[i];
+
+        type->name = read_atom(r);
+        read_mods(r, &type->mods);
+
+        /* Every type has at least one level. */
+        count = read_count(r);
+        if (count == 0)
+            return false;
+        type->level_names = calloc(count, sizeof(*type->level_names));
+        if (!type->level_names)
+            return false;
+        type->num_levels = count;
+        for (xkb_level_index_t j = 0; j < type->num_levels; j++)
+            type->level_names[j] = read_atom(r);
+
+        count = read_count(r);
+        if (count > 0) {
+            type->entries = calloc(count, sizeof(*type->entries));
+            if (!type->entries)
+                return false;
+            type->num_entries = count;
+        }
+        for (unsigned j = 0; j < type->num_entries; j++) {
+            type->entries[j].level = read_uint(r);
+            read_mods(r, &type->entries[j].mods);
+            read_mods(r, &type->entries[j].preserve);
+            if (type->entries[j].level >= type->num_levels)
+                return false;
+        }
+    }
+
+    count = read_count(r);
+    if (count > 0) {
+        keymap->sym_interprets = calloc(count,
+                                        sizeof(*keymap->sym_interprets));
+        if (!keymap->sym_interprets)
+            return false;
+        keymap->num_sym_interprets = count;
+    }
+    for (unsigned i = 0; i < keymap->num_sym_interprets; i++) {
+        struct xkb_sym_interpret *interp = &keymap->sym_interprets[i];
+
+        interp->sym = read_uint(r);
+        interp->match = read_uint(r);
+        interp->mods = read_uint(r);
+        interp->virtual_mod = read_uint(r);
+        read_action(r, &interp->action);
+        interp->level_one_only = read_bool(r);
+        interp->repeat = read_bool(r);
+        if (interp->match > MATCH_EXACTLY ||
+            (interp->virtual_mod != XKB_MOD_INVALID &&
+             interp->virtual_mod >= keymap->mods.num_mods))
+            return false;
+    }
+
+    count = read_count(r);
+    if (count > XKB_MAX_LEDS)
+        return false;
+    keymap->num_leds = count;
+    xkb_leds_foreach(led, keymap) {
+        led->name = read_atom(r);
+        led->which_groups = read_uint(r);
+        led->groups = read_uint(r);
+        led->which_mods = read_uint(r);
+        read_mods(r, &led->mods);
+        led->ctrls = read_uint(r);
+    }
+
+    keymap->num_groups = read_uint(r);
+    if (keymap->num_groups > XKB_MAX_GROUPS)
+        return false;
+
+    count = read_count(r);
+    if (count > 0) {
+        keymap->group_names = calloc(count, sizeof(*keymap->group_names));
+        if (!keymap->group_names)
+            return false;
+        keymap->num_group_names = count;
+    }
+    for (xkb_layout_index_t i = 0; i < keymap->num_group_names; i++)
+        keymap->group_names[i] = read_atom(r);
+
+    count = read_count(r);
+    if (count > 0) {
+        keymap->key_aliases = calloc(count, sizeof(*keymap->key_aliases));
+        if (!keymap->key_aliases)
+            return false;
+        keymap->num_key_aliases = count;
+    }
+    for (unsigned i = 0; i < keymap->num_key_aliases; i++) {
+        keymap->key_aliases[i].real = read_atom(r);
+        keymap->key_aliases[i].alias = read_atom(r);
+    }
+
+    if (r->error)
+        return false;
+
+    return read_keys(r, keymap);
+}
+
+static bool
+binary_v1_keymap_new_from_string(struct xkb_keymap *keymap,
+                                 const char *string, size_t length)
+{
+    struct reader r = {
+        keymap->ctx,
+        (const unsigned char *) string,
+        (const unsigned char *) string + length,
+        false, NULL, 0,
+    };
+    uint32_t version, size;
+    bool ok;
+
+    if (length < BINARY_MAGIC_SIZE ||
+        memcmp(string, BINARY_MAGIC, BINARY_MAGIC_SIZE) != 0) {
+        log_err(keymap->ctx, "Not a binary keymap\n");
+        return false;
+    }
+    r.pos += BINARY_MAGIC_SIZE;
+
+    version = read_uint(&r);
+    if (version != BINARY_VERSION) {
+        log_err(keymap->ctx, "Unsupported binary keymap version %u\n",
+                version);
+        return false;
+    }
+
+    /* Anything after the keymap, such as a NUL terminator, is ignored. */
+    size = read_uint(&r);
+    if (r.error || size > (size_t) (r.end - r.pos)) {
+        log_err(keymap->ctx, "Truncated binary keymap\n");
+        return false;
+    }
+    r.end = r.pos + size;
+
+    r.num_strings = read_count(&r);
+    if (r.num_strings > 0) {
+        r.strings = calloc(r.num_strings, sizeof(*r.strings));
+        if (!r.strings) {
+            log_err(keymap->ctx, "Couldn't allocate binary keymap strings\n");
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < r.num_strings; i++) {
+        r.strings[i].len = read_count(&r);
+        r.strings[i].data = (const char *) r.pos;
+        r.pos += r.strings[i].len;
+    }
+
+    ok = !r.error && read_keymap(&r, keymap);
+    free(r.strings);
+
+    if (!ok) {
+        log_err(keymap->ctx, "Invalid binary keymap\n");
+        return false;
+    }
+
+    return true;
+}
+
+static bool
+binary_v1_keymap_new_from_file(struct xkb_keymap *keymap, FILE *file)
+{
+    const char *string;
+    size_t size;
+    bool ok;
+
+    if (!map_file(file, &string, &size)) {
+        log_err(keymap->ctx, "Couldn't read binary keymap file: %s\n",
+                strerror(errno));
+        return false;
+    }
+
+    ok = binary_v1_keymap_new_from_string(keymap, string, size);
+    unmap_file(string, size);
+    return ok;
+}
+
+const struct xkb_keymap_format_ops binary_v1_keymap_format_ops = {
+    .keymap_new_from_string = binary_v1_keymap_new_from_string,
+    .keymap_new_from_file = binary_v1_keymap_new_from_file,
+    .keymap_write = binary_v1_keymap_write,
+};
@@ -30,21 +30,19 @@ static void
 update_builtin_keymap_fields(struct xkb_keymap *keymap)
 {
     /* Predefined (AKA real, core, X11) modifiers. The order is important! */
-    static const char *const builtin_mods[] = {
-        [0] = "Shift",
-        [1] = "Lock",
-        [2] = "Control",
-        [3] = "Mod1",
-        [4] = "Mod2",
-        [5] = "Mod3",
-        [6] = "Mod4",
-        [7] = "Mod5"
+    static const xkb_atom_t builtin_mods[] = {
+        [0] = ATOM_SHIFT,
+        [1] = ATOM_LOCK,
+        [2] = ATOM_CONTROL,
+        [3] = ATOM_MOD1,
+        [4] = ATOM_MOD2,
+        [5] = ATOM_MOD3,
+        [6] = ATOM_MOD4,
+        [7] = ATOM_MOD5
     };
 
     for (unsigned i = 0; i < ARRAY_SIZE(builtin_mods); i++) {
-        keymap->mods.mods[i].name = xkb_atom_intern(keymap->ctx,
-                                                    builtin_mods[i],
-                                                    strlen(builtin_mods[i]));
+        keymap->mods.mods[i].name = builtin_mods[i];
         keymap->mods.mods[i].type = MOD_REAL;
     }
     keymap->mods.num_mods = ARRAY_SIZE(builtin_mods);
@@ -66,6 +64,8 @@ xkb_keymap_new(struct xkb_context *ctx,
 
     keymap->format = format;
     keymap->flags = flags;
+    for (unsigned i = 0; i < ARRAY_SIZE(keymap->as_fd); i++)
+        keymap->as_fd[i] = -1;
 
     update_builtin_keymap_fields(keymap);
 
@@ -137,3 +137,116 @@ XkbModNameToIndex(const struct xkb_mod_set *mods, xkb_atom_t name,
 
     return XKB_MOD_INVALID;
 }
+
+void
+XkbPackAction(union xkb_packed_action *packed,
+              const union xkb_action *action)
+{
+    /* Clear the padding too, so that packed actions can be compared. */
+    memset(packed, 0, sizeof(*packed));
+    packed->type = action->type;
+
+    switch (action->type) {
+    case ACTION_TYPE_NONE:
+    case ACTION_TYPE_TERMINATE:
+        break;
+    case ACTION_TYPE_MOD_SET:
+    case ACTION_TYPE_MOD_LATCH:
+    case ACTION_TYPE_MOD_LOCK:
+        packed->mods.flags = action->mods.flags;
+        packed->mods.mods = action->mods.mods.mods;
+        packed->mods.mask = action->mods.mods.mask & MOD_REAL_MASK_ALL;
+        break;
+    case ACTION_TYPE_GROUP_SET:
+    case ACTION_TYPE_GROUP_LATCH:
+    case ACTION_TYPE_GROUP_LOCK:
+        packed->group.flags = action->group.flags;
+        packed->group.group = action->group.group;
+        break;
+    case ACTION_TYPE_PTR_MOVE:
+        packed->ptr.flags = action->ptr.flags;
+        packed->ptr.x = action->ptr.x;
+        packed->ptr.y = action->ptr.y;
+        break;
+    case ACTION_TYPE_PTR_BUTTON:
+    case ACTION_TYPE_PTR_LOCK:
+        packed->btn.flags = action->btn.flags;
+        packed->btn.count = action->btn.count;
+        packed->btn.button = action->btn.button;
+        break;
+    case ACTION_TYPE_PTR_DEFAULT:
+        packed->dflt.flags = action->dflt.flags;
+        packed->dflt.value = action->dflt.value;
+        break;
+    case ACTION_TYPE_SWITCH_VT:
+        packed->screen.flags = action->screen.flags;
+        packed->screen.screen = action->screen.screen;
+        break;
+    case ACTION_TYPE_CTRL_SET:
+    case ACTION_TYPE_CTRL_LOCK:
+        packed->ctrls.flags = action->ctrls.flags;
+        packed->ctrls.ctrls = action->ctrls.ctrls;
+        break;
+    case ACTION_TYPE_PRIVATE:
+    default:
+        memcpy(packed->priv.data, action->priv.data,
+               sizeof(packed->priv.data));
+        break;
+    }
+}
+
+void
+XkbUnpackAction(union xkb_action *action,
+                const union xkb_packed_action *packed)
+{
+    memset(action, 0, sizeof(*action));
+    action->type = packed->type;
+
+    switch (packed->type) {
+    case ACTION_TYPE_NONE:
+    case ACTION_TYPE_TERMINATE:
+        break;
+    case ACTION_TYPE_MOD_SET:
+    case ACTION_TYPE_MOD_LATCH:
+    case ACTION_TYPE_MOD_LOCK:
+        action->mods.flags = packed->mods.flags;
+        action->mods.mods.mods = packed->mods.mods;
+        action->mods.mods.mask = packed->mods.mask;
+        break;
+    case ACTION_TYPE_GROUP_SET:
+    case ACTION_TYPE_GROUP_LATCH:
+    case ACTION_TYPE_GROUP_LOCK:
+        action->group.flags = packed->group.flags;
+        action->group.group = packed->group.group;
+        break;
+    case ACTION_TYPE_PTR_MOVE:
+        action->ptr.flags = packed->ptr.flags;
+        action->ptr.x = packed->ptr.x;
+        action->ptr.y = packed->ptr.y;
+        break;
+    case ACTION_TYPE_PTR_BUTTON:
+    case ACTION_TYPE_PTR_LOCK:
+        action->btn.flags = packed->btn.flags;
+        action->btn.count = packed->btn.count;
+        action->btn.button = packed->btn.button;
+        break;
+    case ACTION_TYPE_PTR_DEFAULT:
+        action->dflt.flags = packed->dflt.flags;
+        action->dflt.value = packed->dflt.value;
+        break;
+    case ACTION_TYPE_SWITCH_VT:
+        action->screen.flags = packed->screen.flags;
+        action->screen.screen = packed->screen.screen;
+        break;
+    case ACTION_TYPE_CTRL_SET:
+    case ACTION_TYPE_CTRL_LOCK:
+        action->ctrls.flags = packed->ctrls.flags;
+        action->ctrls.ctrls = packed->ctrls.ctrls;
+        break;
+    case ACTION_TYPE_PRIVATE:
+    default:
+        memcpy(action->priv.data, packed->priv.data,
+               sizeof(action->priv.data));
+        break;
+    }
+}
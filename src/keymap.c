@@ -50,28 +50,39 @@
  *
  * ********************************************************/
 
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef HAVE_MEMFD_CREATE
+#include <sys/mman.h>
+#endif
+
 #include "keymap.h"
+#include "darray.h"
 #include "text.h"
 
 XKB_EXPORT struct xkb_keymap *
 xkb_keymap_ref(struct xkb_keymap *keymap)
 {
-    keymap->refcnt++;
+    refcnt_inc(&keymap->refcnt);
     return keymap;
 }
 
 XKB_EXPORT void
 xkb_keymap_unref(struct xkb_keymap *keymap)
 {
-    if (!keymap || --keymap->refcnt > 0)
+    if (!keymap || !refcnt_dec(&keymap->refcnt))
         return;
 
+    xkb_context_uncache_keymap(keymap->ctx, keymap);
+
     if (keymap->keys) {
         struct xkb_key *key;
         xkb_keys_foreach(key, keymap) {
             if (key->groups) {
                 for (unsigned i = 0; i < key->num_groups; i++) {
-                    if (key->groups[i].levels) {
+                    if (key->groups[i].levels &&
+                        !key->groups[i].shared_levels) {
                         for (unsigned j = 0; j < XkbKeyGroupWidth(key, i); j++)
                             if (key->groups[i].levels[j].num_syms > 1)
                                 free(key->groups[i].levels[j].u.syms);
@@ -83,20 +94,37 @@ xkb_keymap_unref(struct xkb_keymap *keymap)
         }
         free(keymap->keys);
     }
-    if (keymap->types) {
-        for (unsigned i = 0; i < keymap->num_types; i++) {
-            free(keymap->types[i].entries);
-            free(keymap->types[i].level_names);
+    if (keymap->base) {
+        xkb_keymap_unref(keymap->base);
+    }
+    else {
+        if (keymap->types) {
+            for (unsigned i = 0; i < keymap->num_types; i++) {
+                free(keymap->types[i].entries);
+                free(keymap->types[i].level_names);
+            }
+            free(keymap->types);
         }
-        free(keymap->types);
+        free(keymap->sym_interprets);
     }
-    free(keymap->sym_interprets);
     free(keymap->key_aliases);
     free(keymap->group_names);
     free(keymap->keycodes_section_name);
     free(keymap->symbols_section_name);
     free(keymap->types_section_name);
     free(keymap->compat_section_name);
+    if (keymap->origin) {
+        free(keymap->origin->keycodes);
+        free(keymap->origin->types);
+        free(keymap->origin->compat);
+        free(keymap->origin->symbols);
+        free(keymap->origin);
+    }
+    for (unsigned i = 0; i < ARRAY_SIZE(keymap->as_string); i++) {
+        free(keymap->as_string[i]);
+        if (keymap->as_fd[i] >= 0)
+            close(keymap->as_fd[i]);
+    }
     xkb_context_unref(keymap->ctx);
     free(keymap);
 }
@@ -106,6 +134,7 @@ get_keymap_format_ops(enum xkb_keymap_format format)
 {
     static const struct xkb_keymap_format_ops *keymap_format_ops[] = {
         [XKB_KEYMAP_FORMAT_TEXT_V1] = &text_v1_keymap_format_ops,
+        [XKB_KEYMAP_FORMAT_BINARY_V1] = &binary_v1_keymap_format_ops,
     };
 
     if ((int) format < 0 || (int) format >= (int) ARRAY_SIZE(keymap_format_ops))
@@ -135,17 +164,69 @@ xkb_keymap_new_from_names(struct xkb_context *ctx,
         return NULL;
     }
 
+    if (rmlvo_in)
+        rmlvo = *rmlvo_in;
+    else
+        memset(&rmlvo, 0, sizeof(rmlvo));
+    xkb_context_sanitize_rule_names(ctx, &rmlvo);
+
+    if (ctx->cache_keymaps) {
+        keymap = xkb_context_find_cached_keymap(ctx, &rmlvo, flags);
+        if (keymap)
+            return keymap;
+    }
+
     keymap = xkb_keymap_new(ctx, format, flags);
     if (!keymap)
         return NULL;
 
+    if (!ops->keymap_new_from_names(keymap, &rmlvo)) {
+        xkb_keymap_unref(keymap);
+        return NULL;
+    }
+
+    if (ctx->cache_keymaps)
+        xkb_context_cache_keymap(ctx, &rmlvo, flags, keymap);
+
+    return keymap;
+}
+
+XKB_EXPORT struct xkb_keymap *
+xkb_keymap_new_from_names_derived(struct xkb_keymap *base,
+                                  const struct xkb_rule_names *rmlvo_in,
+                                  enum xkb_keymap_compile_flags flags)
+{
+    struct xkb_keymap *keymap;
+    struct xkb_rule_names rmlvo;
+    const struct xkb_keymap_format_ops *ops;
+
+    ops = get_keymap_format_ops(base->format);
+    if (!ops) {
+        log_err_func(base->ctx, "unsupported keymap format: %d\n",
+                     base->format);
+        return NULL;
+    }
+
+    /* Nothing to share with the base; compile from scratch. */
+    if (!ops->keymap_new_from_names_derived)
+        return xkb_keymap_new_from_names(base->ctx, rmlvo_in, flags);
+
+    if (flags & ~(XKB_KEYMAP_COMPILE_NO_FLAGS)) {
+        log_err_func(base->ctx, "unrecognized flags: %#x\n", flags);
+        return NULL;
+    }
+
+    keymap = xkb_keymap_new(base->ctx, base->format, flags);
+    if (!keymap)
+        return NULL;
+
     if (rmlvo_in)
         rmlvo = *rmlvo_in;
     else
         memset(&rmlvo, 0, sizeof(rmlvo));
-    xkb_context_sanitize_rule_names(ctx, &rmlvo);
+    xkb_context_sanitize_rule_names(base->ctx, &rmlvo);
 
-    if (!ops->keymap_new_from_names(keymap, &rmlvo)) {
+    if (!ops->keymap_new_from_names_derived(keymap, base, &rmlvo)) {
         xkb_keymap_unref(keymap);
         return NULL;
     }
@@ -237,22 +318,208 @@ xkb_keymap_new_from_file(struct xkb_context *ctx,
     return keymap;
 }
 
+static int
+append_to_darray(void *user_data, const char *data, size_t length)
+{
+    darray_char *buf = user_data;
+
+    darray_append_items(*buf, data, length);
+    return 1;
+}
+
+/*
+ * The keymap never changes, so it is serialized once per format, and
+ * kept. Several threads may race to do it; the first to finish
+ * publishes its copy.
+ */
+static const struct xkb_keymap_string *
+get_cached_string(struct xkb_keymap *keymap, enum xkb_keymap_format format,
+                  const struct xkb_keymap_format_ops *ops)
+{
+    struct xkb_keymap_string *cached;
+    darray_char buf = darray_new();
+
+    cached = __atomic_load_n(&keymap->as_string[format], __ATOMIC_ACQUIRE);
+    if (cached)
+        return cached;
+
+    if (!ops->keymap_write(keymap, append_to_darray, &buf)) {
+        darray_free(buf);
+        return NULL;
+    }
+
+    /* NUL-terminated, even if the format is not text. */
+    cached = malloc(sizeof(*cached) + darray_size(buf) + 1);
+    if (!cached) {
+        darray_free(buf);
+        return NULL;
+    }
+    cached->length = darray_size(buf);
+    if (cached->length > 0)
+        memcpy(cached->data, darray_mem(buf, 0), cached->length);
+    cached->data[cached->length] = '\0';
+    darray_free(buf);
+
+    if (!__sync_bool_compare_and_swap(&keymap->as_string[format],
+                                      NULL, cached)) {
+        free(cached);
+        cached = __atomic_load_n(&keymap->as_string[format], __ATOMIC_ACQUIRE);
+    }
+
+    return cached;
+}
+
 XKB_EXPORT char *
 xkb_keymap_get_as_string(struct xkb_keymap *keymap,
                          enum xkb_keymap_format format)
 {
     const struct xkb_keymap_format_ops *ops;
+    const struct xkb_keymap_string *cached;
+    char *string;
 
     if (format == XKB_KEYMAP_USE_ORIGINAL_FORMAT)
         format = keymap->format;
 
+    /* Formats which are not text can't be returned as a string. */
     ops = get_keymap_format_ops(format);
-    if (!ops || !ops->keymap_get_as_string) {
+    if (!ops || !ops->is_text) {
         log_err_func(keymap->ctx, "unsupported keymap format: %d\n", format);
         return NULL;
     }
 
-    return ops->keymap_get_as_string(keymap);
+    cached = get_cached_string(keymap, format, ops);
+    if (!cached)
+        return NULL;
+
+    string = malloc(cached->length + 1);
+    if (!string)
+        return NULL;
+
+    memcpy(string, cached->data, cached->length + 1);
+    return string;
+}
+
+XKB_EXPORT int
+xkb_keymap_write(struct xkb_keymap *keymap, enum xkb_keymap_format format,
+                 int (*write_fn)(void *user_data, const char *data,
+                                 size_t length),
+                 void *user_data)
+{
+    const struct xkb_keymap_format_ops *ops;
+
+    if (format == XKB_KEYMAP_USE_ORIGINAL_FORMAT)
+        format = keymap->format;
+
+    ops = get_keymap_format_ops(format);
+    if (!ops || !ops->keymap_write) {
+        log_err_func(keymap->ctx, "unsupported keymap format: %d\n", format);
+        return 0;
+    }
+
+    if (!write_fn) {
+        log_err_func1(keymap->ctx, "no write function provided\n");
+        return 0;
+    }
+
+    return ops->keymap_write(keymap, write_fn, user_data);
+}
+
+static int
+write_to_fd(void *user_data, const char *data, size_t length)
+{
+    int fd = *(int *) user_data;
+
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return 0;
+        }
+        data += written;
+        length -= written;
+    }
+
+    return 1;
+}
+
+XKB_EXPORT int
+xkb_keymap_write_to_fd(struct xkb_keymap *keymap,
+                       enum xkb_keymap_format format, int fd)
+{
+    return xkb_keymap_write(keymap, format, write_to_fd, &fd);
+}
+
+#if defined(HAVE_MEMFD_CREATE) && defined(F_ADD_SEALS)
+static int
+create_sealed_memfd(const struct xkb_keymap_string *cached)
+{
+    int fd;
+
+    fd = memfd_create("xkb-keymap", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0)
+        return -1;
+
+    /* Including the NUL byte, which clients expect to map. */
+    if (!write_to_fd(&fd, cached->data, cached->length + 1) ||
+        fcntl(fd, F_ADD_SEALS,
+              F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) < 0) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+
+    return fd;
+}
+#else
+static int
+create_sealed_memfd(const struct xkb_keymap_string *cached)
+{
+    errno = ENOSYS;
+    return -1;
+}
+#endif
+
+XKB_EXPORT int
+xkb_keymap_get_as_fd(struct xkb_keymap *keymap, enum xkb_keymap_format format,
+                     size_t *size_out)
+{
+    const struct xkb_keymap_format_ops *ops;
+    const struct xkb_keymap_string *cached;
+    int fd;
+
+    if (format == XKB_KEYMAP_USE_ORIGINAL_FORMAT)
+        format = keymap->format;
+
+    ops = get_keymap_format_ops(format);
+    if (!ops || !ops->keymap_write) {
+        log_err_func(keymap->ctx, "unsupported keymap format: %d\n", format);
+        errno = EINVAL;
+        return -1;
+    }
+
+    cached = get_cached_string(keymap, format, ops);
+    if (!cached) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    fd = __atomic_load_n(&keymap->as_fd[format], __ATOMIC_ACQUIRE);
+    if (fd < 0) {
+        fd = create_sealed_memfd(cached);
+        if (fd < 0)
+            return -1;
+
+        if (!__sync_bool_compare_and_swap(&keymap->as_fd[format], -1, fd)) {
+            close(fd);
+            fd = __atomic_load_n(&keymap->as_fd[format], __ATOMIC_ACQUIRE);
+        }
+    }
+
+    if (size_out)
+        *size_out = cached->length + 1;
+    return fd;
 }
 
 /**
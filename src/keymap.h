@@ -109,6 +109,9 @@
 /* Don't allow more leds than we can hold in xkb_led_mask_t. */
 #define XKB_MAX_LEDS ((xkb_led_index_t) (sizeof(xkb_led_mask_t) * 8))
 
+/* The last value of enum xkb_keymap_format. */
+#define XKB_KEYMAP_FORMAT_MAX XKB_KEYMAP_FORMAT_BINARY_V1
+
 /* These should all go away. */
 enum mod_type {
     MOD_REAL = (1 << 0),
@@ -244,6 +247,61 @@ union xkb_action {
     struct xkb_private_action priv;
 };
 
+/*
+ * A compact form of union xkb_action, 8 bytes in size, used where actions
+ * are stored in bulk (the key levels) and by the state filters. Use
+ * XkbPackAction() and XkbUnpackAction() to convert.
+ *
+ * The effective modifier mask only ever contains real modifiers, so 8 bits
+ * are enough for it. Private actions have no flags, and store their data
+ * in their place instead.
+ */
+union xkb_packed_action {
+    uint8_t type;
+    struct {
+        uint8_t type;
+        uint8_t mask;
+        uint16_t flags;
+        xkb_mod_mask_t mods;
+    } mods;
+    struct {
+        uint8_t type;
+        uint16_t flags;
+        int32_t group;
+    } group;
+    struct {
+        uint8_t type;
+        uint16_t flags;
+        uint16_t ctrls;
+    } ctrls;
+    struct {
+        uint8_t type;
+        uint16_t flags;
+        int8_t value;
+    } dflt;
+    struct {
+        uint8_t type;
+        uint16_t flags;
+        int8_t screen;
+    } screen;
+    struct {
+        uint8_t type;
+        uint16_t flags;
+        int16_t x;
+        int16_t y;
+    } ptr;
+    struct {
+        uint8_t type;
+        uint16_t flags;
+        uint8_t count;
+        uint8_t button;
+    } btn;
+    struct {
+        uint8_t type;
+        uint8_t data[7];
+    } priv;
+};
+
 struct xkb_key_type_entry {
     xkb_level_index_t level;
     struct xkb_mods mods;
@@ -313,7 +371,7 @@ enum xkb_explicit_components {
 };
 
 struct xkb_level {
-    union xkb_action action;
+    union xkb_packed_action action;
     unsigned int num_syms;
     union {
         xkb_keysym_t sym;       /* num_syms == 1 */
@@ -323,6 +381,8 @@ struct xkb_level {
 
 struct xkb_group {
     bool explicit_type;
+    /* The levels are owned by another group with identical levels. */
+    bool shared_levels;
     /* Points to a type in keymap->types. */
     const struct xkb_key_type *type;
     /* Use XkbKeyGroupWidth for the number of levels. */
@@ -358,6 +418,25 @@ struct xkb_mod_set {
     unsigned int num_mods;
 };
 
+/*
+ * Kept for keymaps compiled from RMLVO names, so that the sections which
+ * are unchanged can be reused by a keymap derived from this one; see
+ * xkb_keymap_new_from_names_derived().
+ */
+struct xkb_keymap_origin {
+    /* The KcCGST components the keymap was compiled from. */
+    char *keycodes;
+    char *types;
+    char *compat;
+    char *symbols;
+
+    /* What the later sections overwrite, as left by the earlier ones. */
+    xkb_atom_t keycodes_led_names[XKB_MAX_LEDS];
+    xkb_led_index_t keycodes_num_leds;
+    struct xkb_mod_set types_mods;
+    struct xkb_mod_set compat_mods;
+};
+
 /* Common keyboard description structure */
 struct xkb_keymap {
     struct xkb_context *ctx;
@@ -397,6 +476,30 @@ struct xkb_keymap {
     char *symbols_section_name;
     char *types_section_name;
     char *compat_section_name;
+
+    /* NULL unless compiled from RMLVO names. */
+    struct xkb_keymap_origin *origin;
+
+    /*
+     * NULL unless updated from an X event; see
+     * xkb_x11_keymap_new_from_event(). Then the types, the interprets
+     * and the levels of the groups with shared_levels belong to this
+     * keymap, which is referenced.
+     */
+    struct xkb_keymap *base;
+
+    /*
+     * The keymap serialized in each format, and in a sealed memfd, made
+     * on first use; see xkb_keymap_get_as_fd(). Set atomically, since
+     * the keymap may be shared between threads.
+     */
+    struct xkb_keymap_string *as_string[XKB_KEYMAP_FORMAT_MAX + 1];
+    int as_fd[XKB_KEYMAP_FORMAT_MAX + 1];
+};
+
+struct xkb_keymap_string {
+    size_t length;
+    char data[];
 };
 
 #define xkb_keys_foreach(iter, keymap) \
@@ -456,6 +559,14 @@ xkb_mod_index_t
 XkbModNameToIndex(const struct xkb_mod_set *mods, xkb_atom_t name,
                   enum mod_type type);
 
+void
+XkbPackAction(union xkb_packed_action *packed,
+              const union xkb_action *action);
+
+void
+XkbUnpackAction(union xkb_action *action,
+                const union xkb_packed_action *packed);
+
 xkb_layout_index_t
 XkbWrapGroupIntoRange(int32_t group,
                       xkb_layout_index_t num_groups,
@@ -463,14 +574,23 @@ XkbWrapGroupIntoRange(int32_t group,
                       xkb_layout_index_t out_of_range_group_number);
 
 struct xkb_keymap_format_ops {
+    /* Whether xkb_keymap_get_as_string() supports the format. */
+    bool is_text;
     bool (*keymap_new_from_names)(struct xkb_keymap *keymap,
                                   const struct xkb_rule_names *names);
+    bool (*keymap_new_from_names_derived)(struct xkb_keymap *keymap,
+                                          const struct xkb_keymap *base,
+                                          const struct xkb_rule_names *names);
     bool (*keymap_new_from_string)(struct xkb_keymap *keymap,
                                    const char *string, size_t length);
     bool (*keymap_new_from_file)(struct xkb_keymap *keymap, FILE *file);
-    char *(*keymap_get_as_string)(struct xkb_keymap *keymap);
+    bool (*keymap_write)(struct xkb_keymap *keymap,
+                         int (*write_fn)(void *user_data, const char *data,
+                                         size_t length),
+                         void *user_data);
 };
 
 extern const struct xkb_keymap_format_ops text_v1_keymap_format_ops;
+extern const struct xkb_keymap_format_ops binary_v1_keymap_format_ops;
 
 #endif
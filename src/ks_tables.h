@@ -7102,3 +7102,2229 @@ static const struct name_keysym keysym_to_name[] = {
     { 0x1008ffb1, 28716 }, /* XF86TouchpadOff */
     { 0x1008ffb2, 26785 }, /* XF86AudioMicMute */
 };
+
+static const uint16_t name_hash_displacements[] = {
+    15, 4, 13, 85, 35, 2, 0, 51, 61, 24,
+    157, 31, 2, 158, 4, 50, 57, 0, 1, 313,
+    15, 2, 67, 2, 36, 0, 13, 0, 21, 55,
+    88, 168, 102, 8, 57, 16, 0, 7, 3, 228,
+    94, 280, 10, 31, 2, 70, 6, 8, 42, 0,
+    1, 20, 67, 2, 5, 42, 0, 51, 8, 0,
+    2, 1, 13, 2, 0, 111, 111, 0, 121, 6,
+    2, 68, 24, 1, 28, 17, 56, 117, 5, 3,
+    3, 20, 34, 14, 63, 54, 66, 448, 134, 4,
+    77, 16, 107, 28, 6, 14, 139, 2, 0, 39,
+    85, 54, 32, 223, 134, 16, 54, 4, 167, 5,
+    10, 7, 107, 284, 42, 3, 12, 0, 104, 57,
+    39, 13, 1, 325, 2, 108, 0, 18, 12, 12,
+    120, 102, 18, 98, 0, 53, 14, 11, 291, 75,
+    1009, 40, 0, 14, 0, 1, 50, 27, 171, 4,
+    164, 51, 121, 3, 26, 2, 4, 353, 3, 3,
+    305, 72, 53, 20, 303, 1, 43, 0, 12, 174,
+    61, 1, 17, 1, 0, 25, 66, 113, 61, 27,
+    15, 161, 9, 158, 0, 105, 43, 52, 265, 2,
+    395, 185, 64, 76, 236, 2, 11, 38, 7, 101,
+    4, 39, 0, 0, 18, 227, 147, 15, 11, 0,
+    3, 3, 29, 434, 10, 5, 13, 117, 4, 25,
+    42, 24, 63, 10, 595, 18, 215, 83, 41, 56,
+    0, 48, 0, 0, 3, 0, 0, 111, 17, 10,
+    3, 92, 99, 0, 5, 2, 16, 16, 91, 251,
+    15, 305, 28, 2, 32, 6, 923, 0, 775, 7,
+    0, 3, 0, 506, 16, 1, 165, 3, 107, 3,
+    0, 316, 96, 10, 77, 291, 0, 210, 12, 20,
+    2, 1, 0, 23, 3, 33, 134, 3, 94, 49,
+    20, 2, 67, 161, 49, 0, 58, 107, 391, 302,
+    0, 42, 0, 117, 160, 49, 26, 12, 0, 531,
+    0, 11, 159, 25, 0, 41, 339, 121, 0, 6,
+    80, 248, 323, 8, 258, 36, 27, 24, 5, 4,
+    356, 9, 995, 179, 109, 36, 2, 17, 0, 115,
+    211, 3, 89, 39, 327, 4, 325, 1125, 9, 33,
+    0, 50, 0, 30, 306, 290, 3, 1179, 31, 794,
+    10, 31, 10, 2814, 1, 17, 1, 2, 2, 533,
+    114, 26, 18, 8, 485, 0, 106, 46, 100, 167,
+    30, 18, 54, 43, 24, 126, 100, 533, 41, 52,
+    276, 1, 7, 77, 4, 72, 37, 0, 489, 147,
+    142, 0, 0, 603, 0, 37, 5, 223, 336, 508,
+    2, 22, 987, 53, 63, 454, 0, 379, 1, 175,
+    6, 97, 625, 4, 1, 2, 344, 0, 5, 19,
+    46, 218, 728, 72, 24, 0, 65, 348, 786, 639,
+    548, 520, 7, 169, 7, 2, 16, 40, 0, 360,
+    6, 4, 61, 16, 0, 696, 222, 9, 292, 14,
+    84, 81, 58, 761, 165, 5, 265, 351, 1027, 443,
+    0, 11, 394, 117, 1068, 514, 151, 1849, 91, 514,
+    55, 690, 1, 15, 11, 1594, 262, 8, 57, 0,
+    123, 788, 2, 85, 4, 4, 0, 347, 16, 1,
+    594, 41, 5, 32, 77, 177, 68, 259, 251, 0,
+    114, 242, 963, 461, 1273, 15, 200, 6, 899, 5,
+    609, 0, 445, 195, 1, 40, 43, 161, 2341, 13,
+    5, 1896, 19, 1542, 123, 1269, 2101, 217, 213, 724,
+    151, 43, 275, 4, 21, 123, 356, 30, 3016, 197,
+    430, 0, 7, 0, 2, 460, 26, 471, 521, 298,
+    738, 403, 327, 559, 118, 15, 49, 286, 538, 4922,
+    2, 1441, 211, 1830, 4689, 1504, 41, 3, 10, 2239,
+    179, 31, 45, 1056, 0, 16001, 1134, 43, 63, 25,
+    6, 348, 6225, 2444, 798, 17, 338, 5, 336, 813,
+    22,
+};
+
+static const uint16_t name_hash_slots[] = {
+    1244, 2216, 381, 209, 1831, 2090, 1717, 637, 1839, 979,
+    1304, 2218, 1320, 1858, 2324, 1270, 506, 886, 2008, 786,
+    1172, 1627, 2012, 959, 739, 746, 200, 484, 635, 31,
+    1253, 5, 367, 969, 2287, 1045, 2114, 219, 1767, 1018,
+    2246, 2129, 182, 1255, 1619, 452, 1694, 222, 562, 273,
+    126, 382, 279, 961, 2265, 1350, 2045, 976, 2116, 644,
+    24, 322, 1857, 172, 915, 1446, 416, 1195, 2087, 464,
+    1535, 1381, 2329, 863, 1637, 1734, 1565, 1710, 1383, 1862,
+    1946, 2167, 166, 1156, 214, 4, 1517, 1545, 114, 1709,
+    2053, 1813, 895, 1897, 1109, 2156, 1091, 1692, 628, 1919,
+    1030, 454, 630, 1326, 966, 585, 1961, 567, 1731, 1982,
+    2389, 1953, 453, 2135, 1395, 705, 877, 2, 2161, 2292,
+    697, 1733, 882, 2261, 955, 109, 1677, 1947, 1312, 238,
+    429, 2034, 626, 1567, 677, 951, 1796, 1053, 1994, 1010,
+    253, 1774, 206, 1267, 735, 368, 1532, 1182, 2242, 766,
+    2176, 634, 1157, 2207, 1840, 459, 2327, 385, 203, 360,
+    1003, 2201, 1820, 1151, 1753, 233, 608, 1004, 147, 1192,
+    7, 840, 1968, 1079, 393, 846, 624, 178, 407, 1361,
+    2004, 1562, 1088, 1367, 1672, 867, 2047, 2151, 794, 207,
+    1816, 86, 1008, 1113, 65, 1297, 1187, 297, 805, 2121,
+    762, 1648, 988, 1663, 493, 1027, 2394, 2254, 462, 1467,
+    243, 1815, 1170, 1401, 2284, 271, 252, 695, 1996, 721,
+    710, 425, 1587, 1150, 1494, 136, 211, 822, 401, 82,
+    2276, 651, 474, 2203, 327, 573, 490, 948, 1271, 306,
+    1069, 2172, 1164, 1896, 1110, 2182, 1076, 1408, 1979, 542,
+    1028, 33, 956, 2272, 376, 1216, 1145, 460, 137, 1907,
+    1923, 2112, 2040, 196, 1679, 1735, 2210, 2219, 379, 370,
+    1866, 594, 217, 789, 1819, 2164, 1507, 1581, 2181, 2290,
+    2391, 1359, 1072, 1794, 1181, 11, 2091, 1881, 412, 756,
+    941, 337, 1629, 1165, 1980, 13, 2283, 247, 2306, 334,
+    1602, 1673, 769, 1134, 292, 1317, 883, 715, 1882, 1476,
+    1167, 3, 106, 760, 851, 1204, 930, 1049, 791, 465,
+    69, 1894, 1551, 2275, 53, 939, 1093, 1240, 2134, 468,
+    911, 116, 521, 2037, 912, 1184, 1478, 489, 411, 1407,
+    919, 1374, 369, 1989, 1355, 80, 977, 227, 154, 1583,
+    1783, 1048, 2236, 1964, 2073, 90, 1715, 712, 1983, 547,
+    1227, 1066, 1515, 2378, 1722, 853, 1248, 1096, 1258, 151,
+    598, 1462, 1333, 1065, 140, 2110, 173, 2297, 289, 1973,
+    1177, 1797, 896, 1483, 310, 267, 1704, 1344, 1422, 582,
+    2379, 1861, 180, 1883, 1918, 2142, 2191, 157, 391, 755,
+    2098, 898, 2355, 1852, 16, 2240, 2253, 1864, 1115, 2347,
+    311, 1078, 1364, 1416, 2388, 1105, 1871, 2006, 0, 1668,
+    1943, 1691, 341, 2099, 1060, 2281, 1702, 579, 498, 685,
+    1955, 1714, 1798, 1313, 1929, 2307, 2315, 782, 1558, 2257,
+    2396, 75, 1700, 1580, 1306, 110, 1098, 433, 278, 568,
+    1433, 950, 358, 2175, 817, 1351, 1203, 2140, 168, 1738,
+    1631, 1497, 1426, 1617, 1569, 1116, 802, 1879, 1526, 35,
+    605, 1449, 1035, 1680, 625, 2010, 1308, 2083, 1921, 2228,
+    2320, 564, 1044, 1616, 2372, 1112, 1675, 1268, 1469, 1442,
+    576, 328, 237, 2294, 1284, 1031, 26, 1334, 467, 1529,
+    1809, 2373, 2125, 1289, 675, 1435, 689, 351, 475, 711,
+    936, 645, 303, 1223, 1453, 1878, 2146, 967, 1533, 1466,
+    1358, 388, 2171, 202, 1933, 2184, 123, 1873, 1540, 2063,
+    1445, 2250, 272, 960, 550, 974, 1412, 973, 1418, 1482,
+    422, 860, 111, 2279, 121, 133, 820, 1286, 1296, 2046,
+    1775, 1302, 812, 751, 1366, 305, 1865, 72, 1140, 1870,
+    2106, 1233, 150, 138, 1828, 1117, 1144, 2309, 97, 1788,
+    1309, 518, 916, 2079, 982, 2398, 1500, 323, 81, 1642,
+    47, 1650, 2382, 1762, 1001, 992, 486, 682, 1656, 1124,
+    1336, 212, 1238, 1452, 124, 2165, 34, 1867, 103, 400,
+    27, 922, 2119, 503, 658, 827, 167, 593, 839, 2149,
+    716, 1741, 924, 734, 235, 1353, 1822, 1024, 673, 1932,
+    2095, 1287, 2009, 1763, 254, 2234, 516, 1898, 1340, 350,
+    2071, 1022, 2313, 868, 20, 149, 2353, 1773, 317, 601,
+    1784, 1068, 36, 899, 530, 229, 299, 1936, 553, 1701,
+    887, 1573, 1937, 339, 1325, 1934, 2021, 1967, 738, 1792,
+    2080, 878, 1838, 798, 2081, 1566, 170, 240, 842, 1987,
+    2126, 2108, 610, 2041, 2359, 480, 1057, 2332, 1413, 2239,
+    1729, 2187, 1147, 792, 1062, 1541, 2154, 1917, 108, 314,
+    1845, 666, 2039, 1687, 1211, 71, 2074, 1205, 1013, 2331,
+    724, 732, 1160, 1190, 1420, 257, 134, 236, 869, 1523,
+    1590, 1624, 42, 962, 525, 1506, 1473, 2229, 1732, 784,
+    723, 1486, 1492, 2266, 1608, 92, 417, 1711, 321, 1970,
+    2361, 2247, 1574, 2069, 590, 1525, 1459, 1489, 978, 2220,
+    418, 176, 155, 808, 1052, 355, 648, 2260, 2001, 1750,
+    1089, 281, 1266, 1752, 661, 1695, 2400, 1854, 1812, 1319,
+    1557, 483, 1498, 1758, 215, 1295, 1931, 197, 244, 512,
+    1825, 502, 984, 1905, 218, 2255, 1843, 1571, 1298, 1095,
+    569, 932, 701, 122, 1697, 1601, 1527, 2015, 618, 741,
+    1984, 89, 837, 2248, 1058, 1073, 392, 1977, 2052, 1403,
+    99, 538, 501, 2016, 668, 745, 1563, 1721, 885, 1362,
+    57, 1639, 1220, 1986, 30, 2214, 807, 1902, 1848, 1633,
+    641, 2198, 1352, 1198, 1772, 1292, 1585, 2230, 1516, 670,
+    1291, 529, 578, 566, 654, 63, 1026, 88, 804, 141,
+    1743, 810, 1480, 1432, 523, 614, 2375, 800, 549, 139,
+    1175, 1605, 1842, 520, 541, 1393, 1017, 774, 819, 255,
+    1564, 879, 2085, 617, 1976, 910, 1046, 1786, 282, 1261,
+    158, 736, 84, 2076, 2366, 1948, 2070, 1015, 395, 606,
+    2193, 509, 2185, 2057, 1146, 1277, 1047, 2092, 1397, 58,
+    2143, 1604, 1438, 747, 1006, 195, 2296, 2269, 66, 1465,
+    970, 944, 1470, 1084, 1496, 669, 2285, 744, 1951, 1440,
+    722, 1196, 1185, 2020, 2120, 476, 152, 437, 43, 2387,
+    704, 1521, 280, 764, 537, 1087, 787, 725, 342, 1061,
+    2235, 79, 773, 687, 536, 1021, 1808, 940, 1716, 2319,
+    534, 1206, 1396, 94, 399, 1162, 2383, 905, 726, 771,
+    758, 1625, 1129, 631, 1402, 1348, 2104, 1903, 1080, 1363,
+    1327, 1477, 1833, 986, 1543, 1218, 301, 1912, 2333, 332,
+    427, 1630, 165, 1094, 850, 1251, 348, 603, 266, 1009,
+    2377, 283, 225, 1655, 1988, 2325, 1339, 2212, 2262, 434,
+    2226, 2202, 691, 907, 1945, 847, 699, 1368, 1612, 874,
+    638, 1539, 2128, 1706, 1916, 1197, 424, 765, 1824, 2381,
+    1257, 1360, 1349, 1538, 1634, 1077, 2145, 1023, 947, 2102,
+    2141, 1836, 2282, 93, 438, 1036, 1121, 1169, 1632, 1439,
+    1985, 1168, 2082, 1667, 2042, 1522, 1606, 703, 1133, 51,
+    1200, 482, 728, 1455, 1002, 928, 841, 1054, 1922, 2277,
+    829, 1188, 2227, 443, 1901, 2350, 405, 420, 1493, 1782,
+    772, 1122, 1273, 488, 519, 2048, 2344, 1909, 1210, 2064,
+    313, 1247, 2385, 754, 681, 307, 1915, 1559, 750, 2013,
+    312, 1600, 524, 1892, 1548, 1614, 862, 999, 2078, 2314,
+    1654, 1835, 925, 2340, 659, 485, 517, 1868, 384, 855,
+    1791, 2358, 761, 1911, 1371, 796, 1300, 1609, 1823, 326,
+    1400, 505, 1468, 74, 1737, 2367, 1895, 364, 1596, 1769,
+    1042, 1530, 23, 828, 1638, 1669, 320, 1505, 432, 621,
+    1070, 1877, 2243, 1855, 383, 1457, 1718, 2298, 1830, 12,
+    599, 2397, 44, 656, 2189, 406, 373, 1938, 2326, 107,
+    1900, 1924, 291, 2301, 28, 1511, 1241, 481, 2066, 561,
+    752, 2077, 1074, 17, 1688, 1086, 156, 1237, 1460, 1372,
+    1082, 2384, 1369, 783, 2147, 2232, 943, 1682, 816, 888,
+    101, 1085, 2393, 875, 85, 1837, 37, 1504, 1279, 1126,
+    295, 586, 258, 1119, 1183, 535, 575, 1398, 609, 2256,
+    1849, 67, 1671, 1904, 780, 1891, 1748, 1509, 1576, 2107,
+    1373, 859, 1846, 471, 1755, 1193, 1405, 1960, 461, 671,
+    1014, 2392, 1744, 548, 533, 515, 1411, 1958, 1299, 1963,
+    1618, 1826, 1872, 647, 1354, 643, 1641, 2088, 876, 865,
+    220, 1419, 1579, 1935, 1703, 2111, 1051, 145, 1884, 365,
+    1800, 1178, 2244, 1032, 776, 2386, 265, 372, 574, 333,
+    113, 2199, 904, 818, 177, 2280, 1520, 1285, 415, 2017,
+    87, 41, 884, 1966, 1461, 148, 1999, 2399, 59, 921,
+    2342, 1552, 1640, 1817, 316, 2192, 1636, 353, 1337, 91,
+    2380, 463, 2274, 814, 2310, 942, 213, 1081, 923, 2197,
+    662, 302, 2005, 731, 128, 622, 1790, 1649, 565, 727,
+    971, 2311, 629, 546, 2097, 1841, 1514, 1696, 1259, 1125,
+    1342, 797, 1549, 845, 1693, 1415, 1043, 1795, 709, 2137,
+    650, 1276, 2136, 1064, 1050, 239, 1236, 61, 1025, 652,
+    1245, 335, 430, 2206, 649, 135, 2158, 1269, 1345, 1519,
+    1698, 953, 242, 1726, 1213, 1429, 2368, 1059, 104, 300,
+    132, 1972, 1428, 909, 1099, 2237, 508, 1719, 2003, 287,
+    1231, 1274, 50, 1626, 2118, 2061, 627, 823, 1723, 2343,
+    1322, 162, 563, 893, 934, 270, 439, 2000, 1754, 1613,
+    403, 231, 56, 844, 1330, 2249, 260, 1471, 2209, 2035,
+    607, 1194, 763, 421, 1651, 1280, 742, 557, 226, 801,
+    527, 1885, 1225, 1645, 2303, 340, 1683, 2195, 785, 2263,
+    163, 2157, 1101, 142, 1137, 2131, 2062, 551, 848, 1434,
+    120, 1141, 1000, 2322, 1067, 684, 2364, 2173, 500, 1040,
+    1740, 1906, 1534, 458, 642, 1832, 1749, 1436, 2018, 428,
+    914, 902, 2036, 1554, 2200, 2365, 2339, 1720, 2194, 1730,
+    1644, 826, 1423, 1037, 1577, 2401, 995, 838, 1502, 1464,
+    1365, 448, 1034, 1528, 249, 2055, 1880, 694, 858, 1760,
+    1811, 228, 706, 96, 972, 528, 892, 793, 1531, 2330,
+    223, 361, 1592, 843, 615, 2032, 115, 1887, 680, 2395,
+    455, 1572, 1689, 246, 583, 1665, 795, 1997, 374, 589,
+    2067, 354, 1431, 62, 1584, 2084, 2321, 1475, 1705, 1229,
+    640, 472, 2138, 1404, 52, 707, 14, 1623, 1875, 1335,
+    571, 580, 436, 1785, 76, 1806, 2188, 343, 664, 753,
+    1962, 1925, 1331, 1778, 2374, 1926, 1930, 815, 1853, 189,
+    250, 1139, 1100, 1208, 788, 577, 1582, 19, 2334, 435,
+    1201, 929, 2318, 390, 1920, 2065, 620, 446, 1388, 245,
+    690, 161, 1803, 1674, 169, 1766, 1424, 1780, 1736, 2130,
+    160, 1142, 83, 1265, 2028, 1323, 1670, 394, 825, 1484,
+    187, 419, 171, 806, 1275, 2349, 873, 1681, 775, 2215,
+    131, 1290, 1382, 1759, 1332, 1378, 1346, 679, 185, 2376,
+    1607, 469, 1595, 221, 2170, 450, 581, 98, 269, 1387,
+    293, 190, 1219, 1410, 1174, 1293, 40, 1971, 1075, 676,
+    1771, 1950, 1975, 918, 2159, 1272, 526, 813, 1055, 194,
+    1158, 179, 186, 1653, 2038, 208, 309, 1546, 660, 1713,
+    1652, 633, 181, 1978, 1821, 952, 1256, 193, 2251, 1658,
+    1234, 1376, 2241, 983, 2300, 2186, 174, 1487, 1491, 284,
+    1610, 733, 678, 478, 1222, 1379, 1844, 1685, 1041, 410,
+    1252, 294, 653, 2051, 2169, 2293, 2217, 698, 1807, 1635,
+    946, 1888, 409, 261, 45, 2054, 494, 1283, 2289, 700,
+    688, 1992, 657, 2007, 1246, 1942, 748, 1643, 778, 363,
+    473, 1007, 2024, 757, 1603, 304, 1876, 2323, 1495, 1209,
+    359, 22, 1159, 2305, 216, 1646, 338, 2213, 890, 917,
+    1910, 1699, 510, 1191, 204, 477, 1316, 146, 1392, 2044,
+    440, 1550, 2223, 362, 470, 1556, 799, 39, 980, 1890,
+    836, 201, 1102, 1262, 398, 1260, 1394, 127, 402, 268,
+    1555, 1747, 1038, 1542, 2337, 1801, 2369, 1859, 1090, 832,
+    1123, 544, 449, 834, 2259, 2370, 1011, 2109, 330, 1341,
+    2351, 288, 1315, 1787, 2316, 2288, 881, 125, 1385, 954,
+    730, 1799, 1250, 1869, 1490, 1914, 1513, 1860, 1615, 70,
+    1224, 1597, 1969, 2023, 729, 852, 623, 2179, 1131, 1242,
+    2094, 1384, 2174, 129, 993, 987, 511, 2286, 2049, 2264,
+    275, 159, 371, 1356, 130, 298, 1874, 344, 1599, 1889,
+    1278, 1974, 1226, 1757, 1995, 1745, 1409, 2357, 1512, 2225,
+    1215, 833, 1176, 1303, 408, 903, 199, 2268, 1377, 872,
+    2019, 768, 1851, 2221, 1448, 702, 1944, 1347, 1421, 290,
+    2096, 1547, 1746, 1756, 613, 1777, 636, 1802, 2163, 1899,
+    296, 1779, 991, 1553, 1510, 1827, 366, 396, 118, 572,
+    445, 2338, 1012, 1724, 2050, 740, 378, 965, 1230, 144,
+    119, 426, 1417, 413, 6, 188, 1660, 1180, 2336, 945,
+    1128, 1578, 183, 1990, 1886, 1107, 1621, 2093, 1818, 8,
+    2231, 1725, 1016, 2148, 779, 1488, 1136, 276, 263, 1149,
+    397, 1104, 900, 597, 2075, 2162, 1029, 2360, 1959, 2060,
+    539, 870, 319, 927, 232, 1443, 1375, 2113, 1390, 1908,
+    558, 1850, 2204, 1690, 1537, 1991, 1913, 1678, 224, 559,
+    117, 346, 1103, 686, 1501, 861, 1039, 1814, 1264, 1391,
+    2011, 308, 824, 600, 1357, 1957, 1810, 871, 2208, 1662,
+    77, 990, 2144, 1450, 1659, 1430, 423, 1676, 2068, 285,
+    105, 545, 2346, 1770, 1628, 781, 48, 2072, 619, 495,
+    696, 1154, 451, 1829, 1451, 2273, 2153, 1588, 1083, 2345,
+    632, 2002, 1952, 1063, 935, 38, 1472, 18, 1518, 507,
+    1111, 73, 901, 487, 1307, 1456, 325, 29, 1310, 514,
+    1965, 184, 1594, 102, 210, 1202, 1561, 1458, 997, 2356,
+    989, 1171, 1591, 2160, 1235, 357, 1804, 897, 1071, 2348,
+    1481, 1425, 1179, 2252, 560, 713, 1207, 2124, 444, 95,
+    1568, 264, 1447, 1661, 2270, 584, 1712, 1005, 587, 1463,
+    1130, 749, 2033, 345, 2211, 2304, 329, 2127, 1727, 1742,
+    2043, 938, 1454, 556, 386, 2014, 1941, 889, 1305, 389,
+    531, 1708, 646, 347, 262, 380, 1132, 612, 1281, 2302,
+    591, 2026, 1318, 1575, 1940, 854, 998, 2155, 504, 1764,
+    1186, 1657, 1622, 352, 2238, 336, 256, 10, 2029, 835,
+    1311, 1834, 1118, 1993, 2308, 968, 720, 1707, 1863, 1301,
+    1856, 2177, 153, 737, 994, 1243, 387, 1939, 1324, 492,
+    1329, 1789, 2117, 315, 2233, 891, 112, 234, 1728, 1485,
+    963, 864, 277, 908, 2166, 570, 602, 21, 1221, 1768,
+    441, 1321, 1508, 1928, 1189, 274, 1524, 1503, 54, 1239,
+    2183, 2100, 1998, 497, 55, 692, 9, 821, 414, 143,
+    2295, 1148, 1338, 2152, 1153, 714, 1611, 1981, 2105, 1199,
+    2122, 683, 2150, 1893, 356, 1793, 1620, 1114, 2291, 767,
+    25, 46, 447, 809, 770, 286, 1686, 1479, 1232, 32,
+    866, 1570, 2312, 1288, 1589, 906, 2299, 1343, 920, 830,
+    1949, 2089, 431, 15, 1161, 1254, 2101, 2139, 1739, 513,
+    2178, 1647, 543, 2196, 894, 555, 1138, 1097, 1954, 975,
+    857, 331, 318, 937, 1249, 663, 931, 996, 639, 1152,
+    1765, 1389, 1294, 1106, 1414, 803, 1108, 2058, 2030, 2363,
+    78, 1444, 1666, 198, 1544, 849, 2245, 1282, 2059, 1328,
+    2115, 672, 1120, 404, 1173, 717, 693, 1163, 1143, 595,
+    1847, 655, 856, 1020, 1427, 913, 1560, 1166, 1406, 554,
+    1228, 667, 324, 611, 1751, 1033, 1474, 2328, 248, 2205,
+    540, 241, 985, 552, 205, 442, 1437, 68, 1956, 377,
+    251, 2025, 1593, 349, 1127, 933, 191, 1370, 596, 1761,
+    743, 981, 2335, 2222, 1927, 1019, 1781, 1263, 2354, 2103,
+    2168, 811, 1499, 790, 880, 1441, 949, 616, 926, 665,
+    2132, 1664, 964, 2022, 64, 2190, 1056, 2278, 674, 499,
+    777, 708, 1314, 2267, 2224, 718, 192, 759, 1, 49,
+    1684, 522, 604, 60, 466, 496, 2317, 1380, 175, 2371,
+    100, 1135, 1214, 2133, 2056, 491, 2180, 2258, 164, 375,
+    259, 1399, 588, 457, 2027, 2271, 479, 456, 532, 719,
+    1212, 1776, 2031, 958, 1586, 957, 1386, 2390, 2341, 230,
+    1598, 1092, 1155, 592, 1217, 2352, 1805, 2362, 2086, 831,
+    2123, 1536,
+};
+
+static const uint16_t name_icase_hash_displacements[] = {
+    44, 40, 1, 3, 5, 11, 0, 4, 1, 20,
+    2, 17, 0, 152, 119, 12, 12, 211, 3, 3,
+    4, 23, 29, 0, 34, 0, 5, 4, 6, 89,
+    261, 7, 125, 3, 0, 5, 0, 139, 5, 3,
+    192, 10, 2, 84, 26, 162, 52, 69, 51, 5,
+    25, 0, 0, 3, 3, 101, 431, 63, 15, 24,
+    171, 2, 9, 4, 24, 0, 2, 18, 90, 18,
+    0, 22, 13, 5, 0, 12, 0, 14, 4, 5,
+    21, 21, 109, 117, 95, 26, 16, 8, 2, 8,
+    10, 5, 6, 3, 49, 4, 3, 58, 0, 33,
+    1, 2, 202, 99, 11, 0, 0, 3, 126, 45,
+    39, 34, 30, 24, 262, 3, 38, 2, 61, 7,
+    107, 43, 10, 17, 26, 0, 28, 9, 358, 30,
+    40, 298, 36, 135, 1, 0, 45, 23, 0, 7,
+    169, 2, 30, 3, 75, 158, 320, 31, 35, 61,
+    0, 57, 46, 31, 3, 329, 17, 18, 338, 0,
+    55, 9, 38, 30, 100, 3, 12, 106, 33, 503,
+    42, 62, 60, 63, 20, 0, 5, 120, 224, 2,
+    45, 13, 0, 17, 197, 14, 2, 1, 111, 38,
+    81, 6, 34, 34, 12, 32, 100, 8, 12, 20,
+    53, 30, 0, 64, 39, 16, 7, 41, 1, 33,
+    9, 70, 103, 9, 136, 44, 1, 57, 875, 80,
+    108, 732, 108, 1, 4, 2, 105, 52, 89, 72,
+    167, 0, 2, 216, 6, 84, 12, 0, 126, 285,
+    83, 3, 7, 3, 1, 61, 1, 69, 43, 3,
+    181, 626, 82, 1, 4, 6, 9, 611, 0, 2,
+    123, 134, 0, 15, 99, 0, 165, 5, 52, 8,
+    16, 76, 451, 15, 0, 16, 669, 35, 2040, 206,
+    157, 144, 44, 67, 0, 121, 90, 50, 231, 45,
+    182, 219, 6, 10, 98, 306, 399, 0, 180, 43,
+    18, 14, 228, 1421, 367, 0, 14, 157, 24, 6,
+    47, 391, 0, 185, 96, 738, 398, 11, 642, 617,
+    0, 69, 49, 3, 2, 1, 14, 94, 38, 387,
+    188, 0, 347, 18, 14, 148, 213, 338, 630, 503,
+    109, 17, 88, 31, 0, 68, 17, 2217, 106, 12,
+    1215, 6, 2676, 72, 573, 191, 0, 707, 2232, 1057,
+    0, 1, 14, 218, 121, 656, 1633, 447, 20, 146,
+    674, 107, 0, 7, 4, 539, 1, 1, 1, 407,
+    5, 1, 0, 46, 0, 66, 348, 1927, 7, 3,
+    28, 2, 36, 141, 9, 1, 0, 479, 106, 0,
+    10, 1190, 1, 307, 116, 752, 32, 34, 3, 958,
+    11, 0, 554, 35, 320, 2962, 1264, 159, 1, 543,
+    22, 9, 385, 33, 4, 53, 27, 1, 486, 2,
+    534, 371, 0, 36, 15, 33, 7, 3, 21, 366,
+    0, 526, 0, 123, 1147, 591, 1308, 22, 719, 16,
+    1742, 167, 261, 22, 313, 89, 39, 71, 502, 993,
+    2427, 1530, 240, 8, 183, 208, 486, 1440, 7, 19,
+    2133, 2384, 2511, 1, 700, 30, 335, 44, 0, 2,
+    698, 475, 131, 34, 0, 146, 1041, 1659, 23, 11,
+    320, 1109, 1, 3477, 697, 15, 6, 534, 2328, 1822,
+    266, 1491, 2205, 135, 6, 3445, 17, 35, 7344, 87,
+    21, 255, 667, 7, 363,
+};
+
+static const uint16_t name_icase_hash_slots[] = {
+    439, 1114, 618, 513, 478, 377, 817, 1307, 2269, 786,
+    1516, 972, 1727, 2249, 1731, 2345, 722, 2265, 1083, 229,
+    1695, 733, 922, 318, 1752, 868, 1837, 595, 936, 904,
+    2301, 690, 2227, 379, 240, 1806, 560, 708, 300, 1667,
+    2287, 1543, 1960, 1478, 445, 1760, 1433, 517, 1152, 381,
+    141, 428, 1398, 804, 1979, 995, 758, 759, 1215, 464,
+    102, 1733, 358, 1848, 778, 69, 1382, 339, 1501, 337,
+    920, 1929, 353, 1673, 143, 2012, 1387, 2281, 1792, 1873,
+    1709, 980, 876, 2262, 1441, 1205, 2232, 2194, 351, 1260,
+    601, 449, 1674, 2305, 2054, 11, 1977, 450, 1914, 2056,
+    1816, 12, 716, 114, 59, 2040, 119, 596, 2218, 1172,
+    2016, 1589, 2263, 2214, 1209, 1337, 489, 1482, 540, 1064,
+    1973, 2099, 2250, 1121, 2038, 2044, 1563, 2202, 96, 1541,
+    1330, 2141, 1210, 1754, 395, 674, 760, 1739, 897, 165,
+    852, 2355, 523, 1795, 498, 284, 1422, 417, 1953, 135,
+    1934, 320, 1109, 982, 834, 1156, 1955, 2164, 1738, 1161,
+    1549, 543, 16, 1703, 853, 415, 1181, 2372, 2319, 2149,
+    1339, 658, 855, 884, 145, 1144, 152, 1378, 463, 581,
+    1166, 2204, 357, 361, 359, 224, 1104, 2365, 2259, 2135,
+    1869, 545, 628, 686, 965, 1310, 1356, 1770, 2302, 1862,
+    1829, 2077, 2234, 132, 1301, 424, 303, 1559, 190, 2312,
+    1697, 1115, 488, 1520, 1587, 98, 1881, 997, 1799, 2306,
+    1728, 28, 2396, 292, 1112, 1410, 1699, 1480, 35, 1268,
+    1020, 1008, 1607, 1443, 2237, 2092, 712, 1040, 2060, 1167,
+    1579, 2223, 1197, 1001, 1475, 1491, 162, 809, 547, 334,
+    422, 1847, 2009, 2022, 220, 1678, 416, 878, 1044, 1807,
+    945, 2374, 1685, 518, 1853, 1591, 656, 957, 2212, 1237,
+    2081, 964, 660, 457, 862, 566, 1577, 2046, 1663, 1851,
+    1913, 1962, 1786, 556, 1419, 1576, 1584, 1171, 305, 504,
+    1954, 2231, 2278, 2095, 966, 1687, 492, 978, 18, 1314,
+    977, 2205, 1706, 2253, 1325, 1681, 1560, 1244, 1500, 2039,
+    1404, 561, 125, 2230, 2050, 1726, 2350, 1341, 1481, 407,
+    739, 1462, 1495, 1904, 1417, 1759, 1556, 1308, 502, 743,
+    117, 891, 1447, 2289, 1963, 2276, 1744, 2066, 156, 2311,
+    495, 863, 520, 1090, 1100, 1118, 2173, 279, 1440, 2352,
+    387, 877, 766, 893, 1014, 2400, 122, 1249, 2254, 283,
+    60, 2072, 1534, 384, 1523, 1354, 1365, 776, 159, 784,
+    107, 2023, 525, 1791, 1613, 1896, 1262, 2098, 458, 606,
+    600, 386, 186, 13, 917, 394, 1032, 546, 1022, 2304,
+    1080, 1831, 1126, 1277, 1086, 38, 7, 1323, 979, 10,
+    640, 1948, 479, 385, 213, 1722, 2035, 413, 1824, 1002,
+    1508, 1972, 1263, 1429, 92, 1071, 455, 2225, 1581, 1414,
+    2193, 1185, 555, 2158, 558, 1720, 175, 1864, 167, 1542,
+    2045, 375, 1241, 1229, 1990, 2160, 1800, 808, 2159, 1883,
+    1684, 1995, 476, 1805, 614, 285, 1769, 1855, 1332, 1232,
+    1804, 1566, 1179, 781, 1280, 1321, 1098, 326, 2034, 554,
+    360, 512, 2211, 1274, 411, 875, 1854, 392, 938, 1969,
+    773, 2087, 200, 1431, 819, 959, 950, 692, 168, 1617,
+    1122, 94, 1716, 923, 1662, 350, 886, 934, 1705, 1435,
+    632, 1493, 1306, 927, 940, 948, 1641, 931, 2172, 2327,
+    1089, 2295, 1741, 448, 209, 391, 873, 2123, 1527, 33,
+    2069, 158, 1393, 1193, 662, 451, 1573, 1108, 1789, 2359,
+    1766, 2370, 1947, 1439, 2026, 1599, 1252, 582, 420, 2320,
+    967, 202, 634, 366, 46, 1389, 516, 1713, 533, 1643,
+    2188, 2121, 754, 2349, 421, 121, 1390, 1189, 1632, 1034,
+    1928, 2033, 1052, 738, 994, 183, 17, 748, 1423, 1916,
+    1016, 1670, 24, 1110, 1842, 991, 1976, 335, 1935, 1430,
+    2339, 349, 925, 2308, 1994, 2048, 1866, 519, 1988, 696,
+    393, 131, 1644, 1899, 1691, 2280, 613, 215, 1774, 321,
+    2257, 1798, 2113, 1753, 1852, 1344, 265, 2175, 1874, 616,
+    1485, 787, 14, 1557, 348, 924, 1814, 731, 1470, 1624,
+    2368, 1822, 1978, 1959, 993, 1471, 1582, 2001, 2143, 401,
+    1437, 105, 319, 1547, 2244, 1595, 250, 237, 304, 1895,
+    1971, 1497, 2248, 388, 971, 2137, 1974, 262, 2277, 1555,
+    376, 0, 1756, 2037, 1910, 2131, 1221, 2032, 1370, 431,
+    90, 1714, 1510, 2314, 1095, 943, 583, 899, 990, 620,
+    968, 1369, 466, 710, 916, 1196, 425, 374, 23, 496,
+    1458, 296, 1882, 895, 493, 1131, 1092, 510, 99, 1220,
+    174, 1140, 2000, 2389, 1358, 71, 1028, 2198, 1690, 949,
+    275, 338, 267, 1857, 2270, 1999, 2360, 937, 1038, 331,
+    726, 906, 1445, 1758, 1379, 2029, 2109, 1736, 650, 1940,
+    1303, 1950, 1750, 2207, 992, 1846, 1900, 1535, 2238, 941,
+    49, 1253, 2298, 244, 2208, 2241, 866, 714, 1639, 2076,
+    905, 974, 769, 864, 166, 427, 1175, 1412, 585, 352,
+    362, 646, 260, 345, 718, 389, 1436, 163, 330, 1230,
+    205, 898, 456, 1686, 356, 147, 752, 1135, 594, 1453,
+    1025, 1957, 2383, 65, 1113, 2031, 1192, 603, 524, 1154,
+    1042, 2313, 2064, 798, 1141, 735, 218, 188, 1213, 1704,
+    2387, 2324, 248, 3, 2074, 2240, 280, 1981, 442, 129,
+    836, 1964, 1825, 2178, 399, 774, 867, 1801, 1058, 1278,
+    308, 1605, 1298, 1872, 160, 1219, 1835, 1243, 1926, 790,
+    1010, 2336, 2299, 2165, 2335, 436, 801, 1467, 123, 1949,
+    170, 996, 1939, 970, 761, 1159, 1446, 2058, 1788, 532,
+    2292, 193, 587, 553, 654, 2019, 1861, 1761, 2343, 745,
+    2279, 74, 1235, 1518, 642, 1294, 803, 1335, 2084, 788,
+    1823, 369, 1924, 764, 2091, 1438, 914, 2294, 1116, 1571,
+    887, 499, 298, 1918, 1863, 1622, 312, 78, 2177, 1006,
+    2199, 1128, 1724, 2111, 609, 2161, 402, 571, 354, 177,
+    989, 1374, 783, 1261, 37, 1046, 2068, 2356, 4, 576,
+    290, 825, 1936, 1683, 327, 1233, 1082, 1214, 1519, 1309,
+    410, 1188, 789, 83, 2242, 1911, 216, 734, 796, 2195,
+    1, 181, 2291, 1839, 1875, 1367, 36, 772, 2256, 347,
+    494, 1826, 1275, 1375, 67, 103, 371, 198, 843, 1451,
+    1366, 1222, 500, 1615, 1968, 559, 1103, 1707, 664, 1351,
+    2080, 638, 2267, 1915, 883, 2219, 1558, 1391, 340, 849,
+    2363, 902, 1665, 2027, 30, 1228, 155, 2107, 1316, 1137,
+    315, 108, 1889, 19, 1074, 1182, 2042, 932, 961, 1512,
+    534, 106, 720, 490, 1363, 34, 161, 630, 2222, 2216,
+    365, 1459, 112, 1123, 480, 2338, 698, 130, 2011, 2364,
+    31, 1048, 1091, 97, 728, 1580, 1941, 294, 409, 1893,
+    1943, 1871, 328, 2258, 1347, 1666, 55, 536, 1647, 232,
+    329, 915, 2186, 2002, 2206, 1646, 1139, 1246, 1737, 751,
+    2097, 1545, 2090, 1655, 1338, 542, 1129, 1920, 1094, 477,
+    230, 1236, 944, 889, 740, 1708, 1525, 802, 91, 1336,
+    1372, 1680, 486, 2322, 1715, 2288, 2332, 1067, 1779, 1945,
+    454, 2346, 652, 1388, 115, 306, 1056, 2139, 530, 434,
+    150, 909, 93, 2326, 589, 1027, 2209, 775, 505, 896,
+    1469, 1749, 2125, 1841, 134, 1536, 398, 251, 894, 2117,
+    732, 1511, 9, 1147, 2397, 438, 1808, 1490, 1630, 2296,
+    1456, 2271, 1740, 2176, 89, 2170, 1932, 1267, 557, 87,
+    1376, 1870, 676, 295, 946, 1561, 414, 604, 2013, 336,
+    281, 1553, 750, 1638, 1018, 969, 1145, 2070, 153, 1290,
+    911, 412, 947, 1342, 299, 1078, 1202, 1777, 1849, 1755,
+    1030, 378, 2273, 1329, 1452, 452, 1155, 511, 1710, 1996,
+    1901, 2268, 935, 440, 234, 680, 2239, 1271, 1473, 1946,
+    1124, 2053, 1162, 2300, 741, 2251, 1742, 767, 1483, 1747,
+    51, 777, 2005, 1942, 2152, 1867, 2261, 1640, 2246, 63,
+    1088, 2275, 2318, 1472, 1982, 1923, 32, 184, 1583, 1660,
+    1505, 139, 2330, 1269, 1096, 1729, 289, 858, 1818, 100,
+    508, 1958, 1411, 782, 1567, 2315, 1876, 433, 1675, 1266,
+    1653, 1484, 1775, 610, 2189, 999, 419, 1350, 2153, 1226,
+    503, 111, 1790, 42, 1803, 1198, 1693, 580, 2065, 1661,
+    137, 1793, 1399, 729, 382, 1468, 1004, 2351, 118, 1305,
+    1658, 1888, 1178, 1191, 975, 1696, 736, 1515, 1106, 253,
+    942, 2391, 1905, 1767, 1648, 435, 2367, 827, 204, 890,
+    307, 1956, 985, 342, 264, 1248, 1062, 2325, 1289, 113,
+    2006, 73, 1712, 1859, 474, 846, 2266, 612, 727, 1300,
+    1186, 1676, 370, 1593, 25, 1802, 1444, 1158, 1174, 963,
+    1292, 859, 908, 1907, 1921, 1609, 780, 195, 1033, 626,
+    608, 1402, 344, 1474, 2321, 1877, 2226, 591, 39, 2129,
+    548, 2003, 2366, 1036, 405, 116, 879, 1160, 1302, 53,
+    981, 857, 2307, 921, 270, 2155, 746, 644, 1421, 552,
+    1255, 590, 1317, 1364, 1408, 487, 1173, 1396, 1265, 1425,
+    179, 1065, 95, 142, 1652, 1157, 1891, 222, 848, 844,
+    2361, 482, 109, 1245, 259, 800, 2290, 2075, 1796, 1242,
+    2395, 1909, 2369, 1664, 2083, 527, 1218, 1195, 211, 1231,
+    239, 1503, 2341, 76, 1240, 2310, 682, 1238, 2215, 1771,
+    2025, 2021, 1054, 1076, 1395, 1773, 955, 1477, 1454, 624,
+    291, 1381, 124, 1894, 1902, 1961, 1318, 1659, 1164, 1931,
+    813, 1283, 1898, 1281, 364, 2067, 485, 1069, 549, 80,
+    998, 236, 1897, 1349, 1163, 2147, 753, 723, 1517, 2059,
+    2096, 694, 1465, 2180, 2028, 1117, 2103, 317, 986, 1768,
+    832, 149, 127, 157, 1466, 1746, 1120, 1682, 227, 2197,
+    1539, 403, 2073, 1224, 1626, 928, 913, 1005, 1383, 276,
+    823, 1276, 1993, 841, 1865, 2085, 1401, 2047, 453, 1506,
+    1177, 1514, 1320, 528, 310, 765, 1575, 1569, 1003, 1657,
+    1285, 666, 973, 2333, 29, 2353, 1701, 2203, 207, 1922,
+    885, 1698, 110, 1119, 2303, 1597, 459, 564, 2337, 1544,
+    1833, 2399, 301, 840, 176, 607, 756, 1711, 522, 2043,
+    2041, 1588, 1223, 1880, 2020, 1533, 2024, 1548, 101, 484,
+    1324, 1184, 2145, 2340, 1892, 367, 881, 926, 1656, 1860,
+    1734, 861, 744, 1776, 537, 1407, 1794, 1450, 515, 2247,
+    104, 341, 2063, 1688, 871, 569, 1211, 1346, 1251, 1334,
+    1293, 1778, 430, 2104, 293, 406, 2088, 2015, 473, 1327,
+    1672, 1642, 1550, 1552, 1717, 2220, 1217, 1572, 794, 2174,
+    225, 2347, 636, 1751, 1812, 2133, 605, 1099, 1247, 1400,
+    2061, 951, 192, 501, 15, 324, 8, 2127, 795, 1784,
+    257, 1264, 771, 1651, 668, 1762, 791, 1540, 1479, 2243,
+    2354, 851, 1448, 2151, 1146, 1930, 1845, 939, 648, 2381,
+    933, 1827, 2163, 531, 2357, 2331, 1944, 514, 1373, 1919,
+    1912, 1783, 1908, 838, 1502, 1130, 2385, 363, 1287, 2255,
+    1073, 929, 2245, 151, 1887, 1216, 1529, 1679, 1938, 246,
+    1650, 1878, 2049, 509, 1730, 1384, 397, 1628, 611, 461,
+    86, 2, 1125, 343, 1102, 988, 164, 21, 684, 1326,
+    551, 2052, 491, 2030, 799, 1138, 1721, 282, 242, 1361,
+    1148, 1906, 2101, 1601, 1201, 1227, 1392, 471, 1531, 829,
+    1719, 1499, 539, 1199, 1850, 22, 271, 2236, 1671, 2334,
+    1879, 2358, 1250, 1843, 1340, 1997, 1537, 1984, 2055, 742,
+    1504, 2014, 702, 1810, 903, 1176, 1208, 2008, 332, 465,
+    1060, 1169, 622, 602, 983, 447, 1153, 565, 383, 506,
+    1432, 700, 598, 1743, 1132, 2182, 128, 468, 481, 821,
+    1677, 396, 563, 467, 1457, 762, 1578, 1521, 1820, 507,
+    460, 1718, 333, 1951, 678, 1343, 1087, 672, 146, 2282,
+    2102, 2082, 1190, 432, 2344, 1204, 805, 1487, 1371, 140,
+    1636, 1933, 27, 1258, 2376, 1142, 2004, 2200, 1097, 1296,
+    1187, 2217, 1012, 1868, 2260, 2342, 426, 1967, 1256, 1574,
+    901, 1312, 1105, 2309, 483, 1359, 567, 61, 472, 126,
+    550, 1207, 562, 2162, 268, 1352, 2323, 1509, 987, 856,
+    1464, 1970, 309, 892, 57, 1101, 1554, 1781, 2196, 1345,
+    462, 1689, 737, 2224, 2286, 1965, 255, 2293, 169, 768,
+    1272, 1937, 325, 2228, 526, 408, 346, 529, 1884, 1507,
+    1133, 578, 1797, 20, 314, 521, 850, 1413, 953, 2380,
+    1586, 755, 2191, 2285, 390, 1772, 120, 470, 2168, 1394,
+    154, 749, 443, 2089, 910, 323, 1270, 1463, 1564, 2235,
+    2297, 797, 1150, 1313, 1763, 1183, 138, 171, 1844, 475,
+    82, 2221, 2184, 286, 579, 2210, 1333, 1322, 930, 313,
+    2362, 1649, 1611, 423, 266, 1170, 538, 1386, 2010, 1151,
+    1165, 706, 2154, 1134, 1331, 2213, 136, 1992, 297, 1780,
+    854, 874, 1180, 2105, 355, 1538, 1257, 322, 1442, 2229,
+    1409, 2264, 1991, 1203, 311, 544, 2252, 1952, 2283, 1200,
+    26, 1111, 2317, 842, 172, 1403, 724, 541, 1406, 1735,
+    1024, 1903, 1669, 2018, 1315, 1885, 1234, 133, 1764, 747,
+    2167, 1136, 785, 40, 2071, 1304, 2062, 196, 1489, 839,
+    278, 2036, 792, 1319, 444, 404, 446, 704, 1149, 1886,
+    1081, 912, 806, 1989, 418, 2348, 1239, 1998, 1050, 1168,
+    888, 1000, 1620, 984, 1723, 1890, 1449, 1975, 2051, 907,
+    1634, 2378, 302, 497, 1328, 368, 1725, 2393, 2007, 1093,
+    815, 2017, 1551, 273, 1856, 2115, 2398, 277, 1385, 670,
+    1637, 1927, 44, 1259, 288, 5, 1127, 1668, 2086, 372,
+    1415, 1748, 976, 148, 437, 793, 1225, 1107, 918, 1917,
+    1486, 1858, 2284, 599, 2157, 1427, 1966, 811, 1461, 2329,
+    1513, 1085, 1925, 1654, 2316, 1455, 2057, 1732, 688, 845,
+    2328, 84, 1618, 1828, 1254, 1460, 400, 1546, 373, 380,
+    900, 831, 1348, 47, 2201, 1212, 144, 1380, 2274, 1498,
+    1986, 574, 597, 535, 469, 2094, 1603, 441, 1143, 2119,
+    2093, 1405, 6, 287, 429, 1206, 2233, 316, 1745, 2272,
+};
+
+static const uint8_t keysym_to_name_lengths[] = {
+    8, 5, 6, 8, 10, 6, 7, 9, 10, 9, 10, 8, 4, 5, 5, 6,
+    5, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 5, 9, 4, 5, 7,
+    8, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 11, 9, 12, 11,
+    10, 5, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 9, 3, 10, 10,
+    12, 10, 4, 8, 8, 3, 9, 7, 9, 9, 11, 13, 7, 6, 10, 6,
+    6, 9, 11, 13, 5, 2, 9, 14, 7, 11, 9, 14, 10, 7, 13, 12,
+    6, 6, 11, 6, 10, 5, 2, 8, 6, 6, 11, 10, 6, 6, 11, 10,
+    3, 6, 6, 6, 11, 6, 10, 8, 6, 6, 6, 11, 10, 6, 5, 6,
+    6, 6, 11, 6, 10, 5, 2, 8, 6, 6, 11, 10, 6, 6, 11, 10,
+    3, 6, 6, 6, 11, 6, 10, 8, 6, 6, 6, 11, 10, 6, 5, 10,
+    7, 5, 7, 6, 6, 6, 8, 6, 6, 6, 9, 7, 6, 7, 6, 6,
+    5, 6, 8, 6, 6, 11, 6, 9, 6, 6, 6, 6, 6, 7, 6, 6,
+    7, 6, 6, 12, 6, 5, 12, 8, 6, 6, 6, 6, 6, 7, 6, 6,
+    7, 6, 6, 12, 6, 5, 12, 8, 8, 7, 11, 9, 6, 11, 7, 11,
+    8, 6, 11, 9, 11, 9, 11, 6, 11, 9, 11, 9, 11, 6, 11, 3,
+    8, 6, 8, 7, 8, 6, 8, 6, 8, 7, 8, 6, 3, 3, 7, 7,
+    9, 7, 8, 7, 8, 7, 6, 7, 7, 7, 9, 7, 8, 7, 8, 7,
+    6, 7, 8, 13, 19, 19, 10, 16, 7, 6, 6, 6, 6, 6, 7, 7,
+    7, 8, 14, 6, 6, 6, 6, 6, 7, 7, 7, 7, 7, 7, 8, 7,
+    7, 7, 7, 8, 8, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 6,
+    11, 15, 12, 16, 20, 12, 18, 18, 17, 21, 17, 11, 10, 17, 10, 11,
+    11, 10, 11, 10, 11, 9, 11, 11, 12, 10, 10, 10, 10, 10, 12, 14,
+    10, 10, 10, 10, 11, 11, 9, 10, 18, 10, 15, 15, 15, 12, 12, 12,
+    13, 12, 11, 13, 11, 12, 13, 11, 12, 11, 12, 12, 12, 13, 25, 19,
+    13, 10, 11, 13, 11, 12, 13, 11, 12, 11, 12, 12, 12, 13, 25, 19,
+    13, 11, 10, 11, 12, 11, 11, 11, 12, 11, 10, 15, 11, 11, 11, 11,
+    10, 11, 11, 11, 11, 11, 10, 12, 11, 17, 13, 11, 12, 10, 14, 12,
+    17, 11, 10, 11, 12, 11, 11, 11, 12, 11, 10, 15, 11, 11, 11, 11,
+    10, 11, 11, 11, 11, 11, 10, 12, 11, 17, 13, 11, 12, 10, 14, 12,
+    17, 17, 19, 15, 16, 18, 19, 19, 21, 17, 20, 14, 17, 19, 15, 16,
+    18, 24, 19, 19, 21, 27, 17, 11, 10, 11, 11, 13, 10, 9, 11, 10,
+    11, 11, 8, 8, 8, 13, 8, 9, 11, 9, 13, 9, 9, 9, 11, 11,
+    10, 11, 11, 13, 10, 9, 11, 10, 11, 11, 8, 8, 8, 13, 8, 9,
+    11, 21, 9, 13, 9, 9, 9, 11, 11, 14, 14, 11, 11, 13, 16, 16,
+    17, 17, 13, 13, 14, 14, 20, 21, 16, 16, 25, 25, 17, 17, 20, 13,
+    8, 16, 8, 9, 9, 8, 5, 11, 12, 8, 7, 9, 7, 10, 8, 12,
+    5, 10, 9, 17, 8, 9, 7, 10, 9, 5, 12, 12, 2, 2, 2, 2,
+    2, 2, 14, 13, 12, 13, 13, 14, 14, 14, 14, 14, 5, 6, 4, 4,
+    7, 7, 7, 8, 8, 10, 10, 9, 9, 6, 6, 11, 8, 15, 8, 9,
+    8, 9, 11, 10, 8, 10, 6, 7, 16, 12, 17, 6, 9, 12, 11, 12,
+    9, 13, 17, 16, 17, 12, 15, 19, 20, 19, 20, 12, 8, 7, 7, 10,
+    8, 16, 19, 20, 14, 12, 16, 18, 14, 15, 17, 8, 18, 16, 17, 19,
+    11, 12, 4, 7, 5, 12, 6, 12, 9, 11, 12, 11, 10, 12, 9, 17,
+    19, 5, 18, 18, 6, 9, 10, 9, 7, 7, 8, 6, 9, 8, 3, 4,
+    6, 6, 7, 8, 9, 8, 8, 9, 20, 12, 10, 12, 12, 9, 10, 11,
+    11, 10, 10, 16, 11, 12, 15, 10, 15, 10, 13, 11, 14, 9, 16, 11,
+    11, 11, 11, 10, 10, 12, 13, 13, 12, 15, 11, 12, 13, 13, 9, 12,
+    11, 12, 12, 12, 18, 15, 10, 10, 10, 13, 14, 13, 9, 13, 10, 13,
+    9, 12, 10, 15, 9, 10, 10, 7, 11, 7, 11, 11, 11, 10, 10, 12,
+    9, 13, 14, 10, 15, 11, 11, 10, 11, 11, 12, 10, 11, 12, 22, 9,
+    10, 11, 10, 18, 19, 16, 13, 14, 10, 11, 11, 16, 16, 13, 11, 12,
+    12, 11, 10, 10, 11, 12, 12, 11, 13, 18, 17, 12, 17, 17, 13, 18,
+    12, 18, 17, 17, 16, 17, 18, 17, 12, 12, 17, 16, 11, 16, 12, 12,
+    17, 12, 13, 12, 13, 12, 8, 9, 9, 10, 9, 8, 10, 9, 8, 9,
+    10, 9, 9, 8, 10, 9, 9, 9, 9, 9, 8, 15, 20, 19, 14, 19,
+    19, 15, 14, 20, 19, 19, 18, 19, 20, 19, 14, 14, 18, 13, 18, 14,
+    14, 14, 15, 14, 15, 14, 23, 24, 24, 14, 24, 25, 18, 12, 13, 16,
+    26, 20, 10, 2, 2, 10, 8, 14, 14, 11, 10, 12, 13, 15, 10, 9,
+    8, 8, 8, 9, 9, 16, 14, 13, 9, 10, 9, 9, 9, 10, 11, 17,
+    15, 13, 17, 16, 10, 8, 16, 16, 16, 15, 15, 14, 14, 19, 14, 19,
+    15, 20, 14, 19, 16, 16, 15, 12, 16, 18, 19, 21, 22, 23, 19, 20,
+    23, 24, 24, 20, 21, 18, 20, 24, 27, 13, 17, 9, 10, 10, 15, 10,
+    11, 10, 13, 14, 14, 16, 10, 12, 11, 9, 17, 21, 13, 9, 9, 11,
+    15, 23, 16, 14, 16, 20, 15, 15, 19, 18, 15, 13, 14, 23, 17, 15,
+    17, 17, 16, 22, 15, 15, 18, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 16, 18, 10, 12, 22, 22, 23, 2, 2, 2, 3, 3, 3, 20, 19,
+    19, 19, 16, 12, 13, 10, 12, 14, 15, 16, 17, 19, 15, 15, 15, 15,
+    15, 21, 17, 17, 17, 17, 17, 17, 13, 13, 13, 13, 18, 18, 19, 19,
+    13, 9, 3, 8, 5, 6, 5, 11, 7, 6, 9, 5, 8, 11, 6, 8,
+    8, 17, 7, 7, 15, 7, 6, 9, 10, 10, 11, 6, 12, 10, 12, 11,
+    13, 9, 13, 12, 15, 16, 15, 17, 17, 14, 4, 4, 2, 5, 4, 5,
+    4, 3, 5, 6, 5, 7, 6, 4, 4, 4, 4, 6, 4, 5, 11, 8,
+    8, 6, 8, 5, 5, 5, 5, 7, 7, 5, 8, 7, 8, 7, 6, 8,
+    9, 9, 11, 6, 12, 11, 10, 9, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 8, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 7, 7, 9, 9, 9, 10, 6, 6, 5, 5,
+    7, 7, 7, 7, 13, 13, 13, 13, 13, 13, 13, 13, 13, 14, 6, 10,
+    6, 6, 11, 11, 11, 11, 5, 7, 5, 5, 5, 5, 7, 7, 3, 6,
+    6, 6, 6, 5, 7, 3, 16, 16, 22, 22, 21, 21, 22, 22, 21, 21,
+    19, 19, 23, 23, 21, 21, 22, 22, 23, 23, 13, 13, 14, 14, 17, 17,
+    14, 14, 17, 17, 12, 12, 12, 11, 13, 11, 10, 11, 11, 12, 12, 13,
+    12, 12, 12, 11, 12, 13, 13, 12, 11, 11, 12, 11, 12, 11, 11, 11,
+    11, 12, 13, 11, 12, 13, 13, 11, 10, 11, 19, 15, 15, 24, 17, 12,
+    12, 12, 11, 13, 11, 10, 11, 11, 12, 12, 13, 12, 12, 12, 11, 12,
+    13, 13, 12, 11, 11, 12, 11, 12, 11, 11, 11, 11, 12, 13, 11, 12,
+    13, 13, 11, 10, 11, 20, 18, 15, 18, 18, 18, 8, 8, 8, 8, 8,
+    8, 8, 8, 8, 8, 14, 23, 11, 10, 12, 11, 11, 10, 10, 12, 10,
+    18, 22, 15, 9, 16, 15, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 6, 7, 7, 8, 6, 7, 6, 7, 7, 8, 7, 8, 6, 7,
+    7, 6, 7, 7, 7, 8, 7, 8, 8, 8, 7, 8, 7, 8, 8, 9,
+    8, 8, 9, 8, 9, 8, 9, 8, 9, 8, 9, 7, 9, 7, 8, 7,
+    8, 7, 8, 7, 7, 7, 7, 8, 9, 7, 7, 8, 7, 7, 8, 8,
+    9, 7, 8, 7, 8, 8, 7, 8, 8, 7, 8, 8, 8, 9, 9, 15,
+    11, 12, 12, 12, 11, 12, 12, 12, 11, 12, 12, 12, 12, 11, 12, 13,
+    12, 12, 12, 11, 13, 13, 13, 12, 13, 13, 12, 12, 12, 13, 12, 13,
+    12, 11, 12, 11, 12, 12, 11, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+    9, 9, 9, 9, 9, 9, 9, 6, 6, 6, 6, 10, 10, 9, 9, 9,
+    9, 5, 5, 16, 16, 16, 16, 15, 15, 16, 16, 19, 19, 11, 11, 11,
+    11, 10, 10, 11, 11, 14, 14, 9, 9, 5, 5, 6, 6, 16, 16, 16,
+    16, 15, 15, 16, 16, 19, 19, 5, 5, 9, 9, 9, 9, 5, 5, 16,
+    16, 16, 16, 15, 15, 16, 16, 19, 19, 10, 10, 10, 10, 9, 9, 10,
+    10, 13, 13, 9, 9, 5, 5, 10, 10, 10, 10, 9, 9, 10, 10, 13,
+    13, 6, 6, 9, 9, 5, 5, 6, 6, 12, 12, 12, 11, 13, 13, 12,
+    13, 12, 12, 14, 13, 13, 12, 14, 14, 13, 7, 9, 12, 10, 8, 8,
+    9, 10, 9, 7, 13, 8, 16, 8, 9, 12, 10, 10, 8, 10, 9, 9,
+    7, 11, 8, 12, 8, 13, 14, 14, 15, 14, 15, 15, 16, 14, 15, 15,
+    16, 15, 16, 16, 17, 14, 15, 15, 16, 15, 16, 16, 17, 15, 16, 16,
+    17, 16, 17, 17, 18, 14, 15, 15, 16, 15, 16, 16, 17, 15, 16, 16,
+    17, 16, 17, 17, 18, 15, 16, 16, 17, 16, 17, 17, 18, 16, 17, 17,
+    18, 17, 18, 18, 19, 14, 15, 15, 16, 15, 16, 16, 17, 15, 16, 16,
+    17, 16, 17, 17, 18, 15, 16, 16, 17, 16, 17, 17, 18, 16, 17, 17,
+    18, 17, 18, 18, 19, 15, 16, 16, 17, 16, 17, 17, 18, 16, 17, 17,
+    18, 17, 18, 18, 19, 16, 17, 17, 18, 17, 18, 18, 19, 17, 18, 18,
+    19, 18, 19, 19, 20, 14, 15, 15, 16, 15, 16, 16, 17, 15, 16, 16,
+    17, 16, 17, 17, 18, 15, 16, 16, 17, 16, 17, 17, 18, 16, 17, 17,
+    18, 17, 18, 18, 19, 15, 16, 16, 17, 16, 17, 17, 18, 16, 17, 17,
+    18, 17, 18, 18, 19, 16, 17, 17, 18, 17, 18, 18, 19, 17, 18, 18,
+    19, 18, 19, 19, 20, 15, 16, 16, 17, 16, 17, 17, 18, 16, 17, 17,
+    18, 17, 18, 18, 19, 16, 17, 17, 18, 17, 18, 18, 19, 17, 18, 18,
+    19, 18, 19, 19, 20, 16, 17, 17, 18, 17, 18, 18, 19, 17, 18, 18,
+    19, 18, 19, 19, 20, 17, 18, 18, 19, 18, 19, 19, 20, 18, 19, 19,
+    20, 19, 20, 20, 21, 12, 12, 18, 16, 17, 6, 9, 12, 11, 7, 10,
+    13, 15, 18, 13, 6, 12, 7, 11, 11, 7, 8, 6, 11, 12, 12, 12,
+    12, 9, 12, 10, 10, 7, 6, 8, 10, 12, 8, 9, 10, 15, 13, 11,
+    9, 11, 12, 11, 10, 7, 5, 8, 7, 10, 12, 10, 12, 11, 11, 12,
+    12, 9, 9, 7, 7, 9, 7, 12, 14, 11, 9, 10, 9, 11, 12, 11,
+    11, 15, 13, 6, 6, 10, 8, 8, 7, 7, 8, 6, 14, 19, 12, 19,
+    15, 23, 23, 19, 15, 15, 15, 15, 15, 15, 15, 15, 15, 16, 16, 16,
+    10, 13, 14, 14, 17, 15, 12, 19, 21, 17, 19, 21, 11, 20, 13, 20,
+    13, 13, 13, 13, 12, 8, 9, 10, 15, 14, 8, 12, 12, 13, 18, 12,
+    14, 15, 8, 11, 8, 11, 12, 10, 9, 15, 7, 9, 13, 14, 14, 14,
+    14, 13, 8, 11, 11, 15, 12, 20, 11, 13, 15, 15, 11, 11, 11, 11,
+    11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 19, 20, 8, 6,
+    14, 9, 9, 8, 7, 11, 7, 13, 9, 12, 8, 6, 10, 10, 10, 11,
+    10, 10, 11, 7, 8, 14, 8, 10, 9, 9, 5, 9, 10, 17, 14, 14,
+    8, 12, 14, 15, 8, 9, 15, 11, 12, 12, 9, 10, 10, 11, 11, 9,
+    15, 8, 8, 10, 11, 8, 13, 10, 15, 12, 9, 11, 13, 8, 7, 16,
+    15, 19, 12, 19, 14, 13, 16, 8, 10, 8, 11, 7, 9, 10, 8, 11,
+    13, 18, 14, 15, 16,
+};
+
+static const uint16_t keysym_name_page_00[256] = {
+    [0x00] = 1,
+    [0x20] = 2,
+    [0x21] = 3,
+    [0x22] = 4,
+    [0x23] = 5,
+    [0x24] = 6,
+    [0x25] = 7,
+    [0x26] = 8,
+    [0x27] = 9,
+    [0x28] = 10,
+    [0x29] = 11,
+    [0x2a] = 12,
+    [0x2b] = 13,
+    [0x2c] = 14,
+    [0x2d] = 15,
+    [0x2e] = 16,
+    [0x2f] = 17,
+    [0x30] = 18,
+    [0x31] = 19,
+    [0x32] = 20,
+    [0x33] = 21,
+    [0x34] = 22,
+    [0x35] = 23,
+    [0x36] = 24,
+    [0x37] = 25,
+    [0x38] = 26,
+    [0x39] = 27,
+    [0x3a] = 28,
+    [0x3b] = 29,
+    [0x3c] = 30,
+    [0x3d] = 31,
+    [0x3e] = 32,
+    [0x3f] = 33,
+    [0x40] = 34,
+    [0x41] = 35,
+    [0x42] = 36,
+    [0x43] = 37,
+    [0x44] = 38,
+    [0x45] = 39,
+    [0x46] = 40,
+    [0x47] = 41,
+    [0x48] = 42,
+    [0x49] = 43,
+    [0x4a] = 44,
+    [0x4b] = 45,
+    [0x4c] = 46,
+    [0x4d] = 47,
+    [0x4e] = 48,
+    [0x4f] = 49,
+    [0x50] = 50,
+    [0x51] = 51,
+    [0x52] = 52,
+    [0x53] = 53,
+    [0x54] = 54,
+    [0x55] = 55,
+    [0x56] = 56,
+    [0x57] = 57,
+    [0x58] = 58,
+    [0x59] = 59,
+    [0x5a] = 60,
+    [0x5b] = 61,
+    [0x5c] = 62,
+    [0x5d] = 63,
+    [0x5e] = 64,
+    [0x5f] = 65,
+    [0x60] = 66,
+    [0x61] = 67,
+    [0x62] = 68,
+    [0x63] = 69,
+    [0x64] = 70,
+    [0x65] = 71,
+    [0x66] = 72,
+    [0x67] = 73,
+    [0x68] = 74,
+    [0x69] = 75,
+    [0x6a] = 76,
+    [0x6b] = 77,
+    [0x6c] = 78,
+    [0x6d] = 79,
+    [0x6e] = 80,
+    [0x6f] = 81,
+    [0x70] = 82,
+    [0x71] = 83,
+    [0x72] = 84,
+    [0x73] = 85,
+    [0x74] = 86,
+    [0x75] = 87,
+    [0x76] = 88,
+    [0x77] = 89,
+    [0x78] = 90,
+    [0x79] = 91,
+    [0x7a] = 92,
+    [0x7b] = 93,
+    [0x7c] = 94,
+    [0x7d] = 95,
+    [0x7e] = 96,
+    [0xa0] = 97,
+    [0xa1] = 98,
+    [0xa2] = 99,
+    [0xa3] = 100,
+    [0xa4] = 101,
+    [0xa5] = 102,
+    [0xa6] = 103,
+    [0xa7] = 104,
+    [0xa8] = 105,
+    [0xa9] = 106,
+    [0xaa] = 107,
+    [0xab] = 108,
+    [0xac] = 109,
+    [0xad] = 110,
+    [0xae] = 111,
+    [0xaf] = 112,
+    [0xb0] = 113,
+    [0xb1] = 114,
+    [0xb2] = 115,
+    [0xb3] = 116,
+    [0xb4] = 117,
+    [0xb5] = 118,
+    [0xb6] = 119,
+    [0xb7] = 120,
+    [0xb8] = 121,
+    [0xb9] = 122,
+    [0xba] = 123,
+    [0xbb] = 124,
+    [0xbc] = 125,
+    [0xbd] = 126,
+    [0xbe] = 127,
+    [0xbf] = 128,
+    [0xc0] = 129,
+    [0xc1] = 130,
+    [0xc2] = 131,
+    [0xc3] = 132,
+    [0xc4] = 133,
+    [0xc5] = 134,
+    [0xc6] = 135,
+    [0xc7] = 136,
+    [0xc8] = 137,
+    [0xc9] = 138,
+    [0xca] = 139,
+    [0xcb] = 140,
+    [0xcc] = 141,
+    [0xcd] = 142,
+    [0xce] = 143,
+    [0xcf] = 144,
+    [0xd0] = 145,
+    [0xd1] = 146,
+    [0xd2] = 147,
+    [0xd3] = 148,
+    [0xd4] = 149,
+    [0xd5] = 150,
+    [0xd6] = 151,
+    [0xd7] = 152,
+    [0xd8] = 153,
+    [0xd9] = 154,
+    [0xda] = 155,
+    [0xdb] = 156,
+    [0xdc] = 157,
+    [0xdd] = 158,
+    [0xde] = 159,
+    [0xdf] = 160,
+    [0xe0] = 161,
+    [0xe1] = 162,
+    [0xe2] = 163,
+    [0xe3] = 164,
+    [0xe4] = 165,
+    [0xe5] = 166,
+    [0xe6] = 167,
+    [0xe7] = 168,
+    [0xe8] = 169,
+    [0xe9] = 170,
+    [0xea] = 171,
+    [0xeb] = 172,
+    [0xec] = 173,
+    [0xed] = 174,
+    [0xee] = 175,
+    [0xef] = 176,
+    [0xf0] = 177,
+    [0xf1] = 178,
+    [0xf2] = 179,
+    [0xf3] = 180,
+    [0xf4] = 181,
+    [0xf5] = 182,
+    [0xf6] = 183,
+    [0xf7] = 184,
+    [0xf8] = 185,
+    [0xf9] = 186,
+    [0xfa] = 187,
+    [0xfb] = 188,
+    [0xfc] = 189,
+    [0xfd] = 190,
+    [0xfe] = 191,
+    [0xff] = 192,
+};
+
+static const uint16_t keysym_name_page_01[256] = {
+    [0xa1] = 193,
+    [0xa2] = 194,
+    [0xa3] = 195,
+    [0xa5] = 196,
+    [0xa6] = 197,
+    [0xa9] = 198,
+    [0xaa] = 199,
+    [0xab] = 200,
+    [0xac] = 201,
+    [0xae] = 202,
+    [0xaf] = 203,
+    [0xb1] = 204,
+    [0xb2] = 205,
+    [0xb3] = 206,
+    [0xb5] = 207,
+    [0xb6] = 208,
+    [0xb7] = 209,
+    [0xb9] = 210,
+    [0xba] = 211,
+    [0xbb] = 212,
+    [0xbc] = 213,
+    [0xbd] = 214,
+    [0xbe] = 215,
+    [0xbf] = 216,
+    [0xc0] = 217,
+    [0xc3] = 218,
+    [0xc5] = 219,
+    [0xc6] = 220,
+    [0xc8] = 221,
+    [0xca] = 222,
+    [0xcc] = 223,
+    [0xcf] = 224,
+    [0xd0] = 225,
+    [0xd1] = 226,
+    [0xd2] = 227,
+    [0xd5] = 228,
+    [0xd8] = 229,
+    [0xd9] = 230,
+    [0xdb] = 231,
+    [0xde] = 232,
+    [0xe0] = 233,
+    [0xe3] = 234,
+    [0xe5] = 235,
+    [0xe6] = 236,
+    [0xe8] = 237,
+    [0xea] = 238,
+    [0xec] = 239,
+    [0xef] = 240,
+    [0xf0] = 241,
+    [0xf1] = 242,
+    [0xf2] = 243,
+    [0xf5] = 244,
+    [0xf8] = 245,
+    [0xf9] = 246,
+    [0xfb] = 247,
+    [0xfe] = 248,
+    [0xff] = 249,
+};
+
+static const uint16_t keysym_name_page_02[256] = {
+    [0xa1] = 250,
+    [0xa6] = 251,
+    [0xa9] = 252,
+    [0xab] = 253,
+    [0xac] = 254,
+    [0xb1] = 255,
+    [0xb6] = 256,
+    [0xb9] = 257,
+    [0xbb] = 258,
+    [0xbc] = 259,
+    [0xc5] = 260,
+    [0xc6] = 261,
+    [0xd5] = 262,
+    [0xd8] = 263,
+    [0xdd] = 264,
+    [0xde] = 265,
+    [0xe5] = 266,
+    [0xe6] = 267,
+    [0xf5] = 268,
+    [0xf8] = 269,
+    [0xfd] = 270,
+    [0xfe] = 271,
+};
+
+static const uint16_t keysym_name_page_03[256] = {
+    [0xa2] = 272,
+    [0xa3] = 273,
+    [0xa5] = 274,
+    [0xa6] = 275,
+    [0xaa] = 276,
+    [0xab] = 277,
+    [0xac] = 278,
+    [0xb3] = 279,
+    [0xb5] = 280,
+    [0xb6] = 281,
+    [0xba] = 282,
+    [0xbb] = 283,
+    [0xbc] = 284,
+    [0xbd] = 285,
+    [0xbf] = 286,
+    [0xc0] = 287,
+    [0xc7] = 288,
+    [0xcc] = 289,
+    [0xcf] = 290,
+    [0xd1] = 291,
+    [0xd2] = 292,
+    [0xd3] = 293,
+    [0xd9] = 294,
+    [0xdd] = 295,
+    [0xde] = 296,
+    [0xe0] = 297,
+    [0xe7] = 298,
+    [0xec] = 299,
+    [0xef] = 300,
+    [0xf1] = 301,
+    [0xf2] = 302,
+    [0xf3] = 303,
+    [0xf9] = 304,
+    [0xfd] = 305,
+    [0xfe] = 306,
+};
+
+static const uint16_t keysym_name_page_04[256] = {
+    [0x7e] = 307,
+    [0xa1] = 308,
+    [0xa2] = 309,
+    [0xa3] = 310,
+    [0xa4] = 311,
+    [0xa5] = 312,
+    [0xa6] = 313,
+    [0xa7] = 314,
+    [0xa8] = 315,
+    [0xa9] = 316,
+    [0xaa] = 317,
+    [0xab] = 318,
+    [0xac] = 319,
+    [0xad] = 320,
+    [0xae] = 321,
+    [0xaf] = 322,
+    [0xb0] = 323,
+    [0xb1] = 324,
+    [0xb2] = 325,
+    [0xb3] = 326,
+    [0xb4] = 327,
+    [0xb5] = 328,
+    [0xb6] = 329,
+    [0xb7] = 330,
+    [0xb8] = 331,
+    [0xb9] = 332,
+    [0xba] = 333,
+    [0xbb] = 334,
+    [0xbc] = 335,
+    [0xbd] = 336,
+    [0xbe] = 337,
+    [0xbf] = 338,
+    [0xc0] = 339,
+    [0xc1] = 340,
+    [0xc2] = 341,
+    [0xc3] = 342,
+    [0xc4] = 343,
+    [0xc5] = 344,
+    [0xc6] = 345,
+    [0xc7] = 346,
+    [0xc8] = 347,
+    [0xc9] = 348,
+    [0xca] = 349,
+    [0xcb] = 350,
+    [0xcc] = 351,
+    [0xcd] = 352,
+    [0xce] = 353,
+    [0xcf] = 354,
+    [0xd0] = 355,
+    [0xd1] = 356,
+    [0xd2] = 357,
+    [0xd3] = 358,
+    [0xd4] = 359,
+    [0xd5] = 360,
+    [0xd6] = 361,
+    [0xd7] = 362,
+    [0xd8] = 363,
+    [0xd9] = 364,
+    [0xda] = 365,
+    [0xdb] = 366,
+    [0xdc] = 367,
+    [0xdd] = 368,
+    [0xde] = 369,
+    [0xdf] = 370,
+};
+
+static const uint16_t keysym_name_page_05[256] = {
+    [0xac] = 371,
+    [0xbb] = 372,
+    [0xbf] = 373,
+    [0xc1] = 374,
+    [0xc2] = 375,
+    [0xc3] = 376,
+    [0xc4] = 377,
+    [0xc5] = 378,
+    [0xc6] = 379,
+    [0xc7] = 380,
+    [0xc8] = 381,
+    [0xc9] = 382,
+    [0xca] = 383,
+    [0xcb] = 384,
+    [0xcc] = 385,
+    [0xcd] = 386,
+    [0xce] = 387,
+    [0xcf] = 388,
+    [0xd0] = 389,
+    [0xd1] = 390,
+    [0xd2] = 391,
+    [0xd3] = 392,
+    [0xd4] = 393,
+    [0xd5] = 394,
+    [0xd6] = 395,
+    [0xd7] = 396,
+    [0xd8] = 397,
+    [0xd9] = 398,
+    [0xda] = 399,
+    [0xe0] = 400,
+    [0xe1] = 401,
+    [0xe2] = 402,
+    [0xe3] = 403,
+    [0xe4] = 404,
+    [0xe5] = 405,
+    [0xe6] = 406,
+    [0xe7] = 407,
+    [0xe8] = 408,
+    [0xe9] = 409,
+    [0xea] = 410,
+    [0xeb] = 411,
+    [0xec] = 412,
+    [0xed] = 413,
+    [0xee] = 414,
+    [0xef] = 415,
+    [0xf0] = 416,
+    [0xf1] = 417,
+    [0xf2] = 418,
+};
+
+static const uint16_t keysym_name_page_06[256] = {
+    [0xa1] = 419,
+    [0xa2] = 420,
+    [0xa3] = 421,
+    [0xa4] = 422,
+    [0xa5] = 423,
+    [0xa6] = 424,
+    [0xa7] = 425,
+    [0xa8] = 426,
+    [0xa9] = 427,
+    [0xaa] = 428,
+    [0xab] = 429,
+    [0xac] = 430,
+    [0xad] = 431,
+    [0xae] = 432,
+    [0xaf] = 433,
+    [0xb0] = 434,
+    [0xb1] = 435,
+    [0xb2] = 436,
+    [0xb3] = 437,
+    [0xb4] = 438,
+    [0xb5] = 439,
+    [0xb6] = 440,
+    [0xb7] = 441,
+    [0xb8] = 442,
+    [0xb9] = 443,
+    [0xba] = 444,
+    [0xbb] = 445,
+    [0xbc] = 446,
+    [0xbd] = 447,
+    [0xbe] = 448,
+    [0xbf] = 449,
+    [0xc0] = 450,
+    [0xc1] = 451,
+    [0xc2] = 452,
+    [0xc3] = 453,
+    [0xc4] = 454,
+    [0xc5] = 455,
+    [0xc6] = 456,
+    [0xc7] = 457,
+    [0xc8] = 458,
+    [0xc9] = 459,
+    [0xca] = 460,
+    [0xcb] = 461,
+    [0xcc] = 462,
+    [0xcd] = 463,
+    [0xce] = 464,
+    [0xcf] = 465,
+    [0xd0] = 466,
+    [0xd1] = 467,
+    [0xd2] = 468,
+    [0xd3] = 469,
+    [0xd4] = 470,
+    [0xd5] = 471,
+    [0xd6] = 472,
+    [0xd7] = 473,
+    [0xd8] = 474,
+    [0xd9] = 475,
+    [0xda] = 476,
+    [0xdb] = 477,
+    [0xdc] = 478,
+    [0xdd] = 479,
+    [0xde] = 480,
+    [0xdf] = 481,
+    [0xe0] = 482,
+    [0xe1] = 483,
+    [0xe2] = 484,
+    [0xe3] = 485,
+    [0xe4] = 486,
+    [0xe5] = 487,
+    [0xe6] = 488,
+    [0xe7] = 489,
+    [0xe8] = 490,
+    [0xe9] = 491,
+    [0xea] = 492,
+    [0xeb] = 493,
+    [0xec] = 494,
+    [0xed] = 495,
+    [0xee] = 496,
+    [0xef] = 497,
+    [0xf0] = 498,
+    [0xf1] = 499,
+    [0xf2] = 500,
+    [0xf3] = 501,
+    [0xf4] = 502,
+    [0xf5] = 503,
+    [0xf6] = 504,
+    [0xf7] = 505,
+    [0xf8] = 506,
+    [0xf9] = 507,
+    [0xfa] = 508,
+    [0xfb] = 509,
+    [0xfc] = 510,
+    [0xfd] = 511,
+    [0xfe] = 512,
+    [0xff] = 513,
+};
+
+static const uint16_t keysym_name_page_07[256] = {
+    [0xa1] = 514,
+    [0xa2] = 515,
+    [0xa3] = 516,
+    [0xa4] = 517,
+    [0xa5] = 518,
+    [0xa7] = 519,
+    [0xa8] = 520,
+    [0xa9] = 521,
+    [0xab] = 522,
+    [0xae] = 523,
+    [0xaf] = 524,
+    [0xb1] = 525,
+    [0xb2] = 526,
+    [0xb3] = 527,
+    [0xb4] = 528,
+    [0xb5] = 529,
+    [0xb6] = 530,
+    [0xb7] = 531,
+    [0xb8] = 532,
+    [0xb9] = 533,
+    [0xba] = 534,
+    [0xbb] = 535,
+    [0xc1] = 536,
+    [0xc2] = 537,
+    [0xc3] = 538,
+    [0xc4] = 539,
+    [0xc5] = 540,
+    [0xc6] = 541,
+    [0xc7] = 542,
+    [0xc8] = 543,
+    [0xc9] = 544,
+    [0xca] = 545,
+    [0xcb] = 546,
+    [0xcc] = 547,
+    [0xcd] = 548,
+    [0xce] = 549,
+    [0xcf] = 550,
+    [0xd0] = 551,
+    [0xd1] = 552,
+    [0xd2] = 553,
+    [0xd4] = 554,
+    [0xd5] = 555,
+    [0xd6] = 556,
+    [0xd7] = 557,
+    [0xd8] = 558,
+    [0xd9] = 559,
+    [0xe1] = 560,
+    [0xe2] = 561,
+    [0xe3] = 562,
+    [0xe4] = 563,
+    [0xe5] = 564,
+    [0xe6] = 565,
+    [0xe7] = 566,
+    [0xe8] = 567,
+    [0xe9] = 568,
+    [0xea] = 569,
+    [0xeb] = 570,
+    [0xec] = 571,
+    [0xed] = 572,
+    [0xee] = 573,
+    [0xef] = 574,
+    [0xf0] = 575,
+    [0xf1] = 576,
+    [0xf2] = 577,
+    [0xf3] = 578,
+    [0xf4] = 579,
+    [0xf5] = 580,
+    [0xf6] = 581,
+    [0xf7] = 582,
+    [0xf8] = 583,
+    [0xf9] = 584,
+};
+
+static const uint16_t keysym_name_page_08[256] = {
+    [0xa1] = 585,
+    [0xa2] = 586,
+    [0xa3] = 587,
+    [0xa4] = 588,
+    [0xa5] = 589,
+    [0xa6] = 590,
+    [0xa7] = 591,
+    [0xa8] = 592,
+    [0xa9] = 593,
+    [0xaa] = 594,
+    [0xab] = 595,
+    [0xac] = 596,
+    [0xad] = 597,
+    [0xae] = 598,
+    [0xaf] = 599,
+    [0xb0] = 600,
+    [0xb1] = 601,
+    [0xb2] = 602,
+    [0xb3] = 603,
+    [0xb4] = 604,
+    [0xb5] = 605,
+    [0xb6] = 606,
+    [0xb7] = 607,
+    [0xbc] = 608,
+    [0xbd] = 609,
+    [0xbe] = 610,
+    [0xbf] = 611,
+    [0xc0] = 612,
+    [0xc1] = 613,
+    [0xc2] = 614,
+    [0xc5] = 615,
+    [0xc8] = 616,
+    [0xc9] = 617,
+    [0xcd] = 618,
+    [0xce] = 619,
+    [0xcf] = 620,
+    [0xd6] = 621,
+    [0xda] = 622,
+    [0xdb] = 623,
+    [0xdc] = 624,
+    [0xdd] = 625,
+    [0xde] = 626,
+    [0xdf] = 627,
+    [0xef] = 628,
+    [0xf6] = 629,
+    [0xfb] = 630,
+    [0xfc] = 631,
+    [0xfd] = 632,
+    [0xfe] = 633,
+};
+
+static const uint16_t keysym_name_page_09[256] = {
+    [0xdf] = 634,
+    [0xe0] = 635,
+    [0xe1] = 636,
+    [0xe2] = 637,
+    [0xe3] = 638,
+    [0xe4] = 639,
+    [0xe5] = 640,
+    [0xe8] = 641,
+    [0xe9] = 642,
+    [0xea] = 643,
+    [0xeb] = 644,
+    [0xec] = 645,
+    [0xed] = 646,
+    [0xee] = 647,
+    [0xef] = 648,
+    [0xf0] = 649,
+    [0xf1] = 650,
+    [0xf2] = 651,
+    [0xf3] = 652,
+    [0xf4] = 653,
+    [0xf5] = 654,
+    [0xf6] = 655,
+    [0xf7] = 656,
+    [0xf8] = 657,
+};
+
+static const uint16_t keysym_name_page_0a[256] = {
+    [0xa1] = 658,
+    [0xa2] = 659,
+    [0xa3] = 660,
+    [0xa4] = 661,
+    [0xa5] = 662,
+    [0xa6] = 663,
+    [0xa7] = 664,
+    [0xa8] = 665,
+    [0xa9] = 666,
+    [0xaa] = 667,
+    [0xac] = 668,
+    [0xae] = 669,
+    [0xaf] = 670,
+    [0xb0] = 671,
+    [0xb1] = 672,
+    [0xb2] = 673,
+    [0xb3] = 674,
+    [0xb4] = 675,
+    [0xb5] = 676,
+    [0xb6] = 677,
+    [0xb7] = 678,
+    [0xb8] = 679,
+    [0xbb] = 680,
+    [0xbc] = 681,
+    [0xbd] = 682,
+    [0xbe] = 683,
+    [0xbf] = 684,
+    [0xc3] = 685,
+    [0xc4] = 686,
+    [0xc5] = 687,
+    [0xc6] = 688,
+    [0xc9] = 689,
+    [0xca] = 690,
+    [0xcb] = 691,
+    [0xcc] = 692,
+    [0xcd] = 693,
+    [0xce] = 694,
+    [0xcf] = 695,
+    [0xd0] = 696,
+    [0xd1] = 697,
+    [0xd2] = 698,
+    [0xd3] = 699,
+    [0xd4] = 700,
+    [0xd5] = 701,
+    [0xd6] = 702,
+    [0xd7] = 703,
+    [0xd9] = 704,
+    [0xda] = 705,
+    [0xdb] = 706,
+    [0xdc] = 707,
+    [0xdd] = 708,
+    [0xde] = 709,
+    [0xdf] = 710,
+    [0xe0] = 711,
+    [0xe1] = 712,
+    [0xe2] = 713,
+    [0xe3] = 714,
+    [0xe4] = 715,
+    [0xe5] = 716,
+    [0xe6] = 717,
+    [0xe7] = 718,
+    [0xe8] = 719,
+    [0xe9] = 720,
+    [0xea] = 721,
+    [0xeb] = 722,
+    [0xec] = 723,
+    [0xed] = 724,
+    [0xee] = 725,
+    [0xf0] = 726,
+    [0xf1] = 727,
+    [0xf2] = 728,
+    [0xf3] = 729,
+    [0xf4] = 730,
+    [0xf5] = 731,
+    [0xf6] = 732,
+    [0xf7] = 733,
+    [0xf8] = 734,
+    [0xf9] = 735,
+    [0xfa] = 736,
+    [0xfb] = 737,
+    [0xfc] = 738,
+    [0xfd] = 739,
+    [0xfe] = 740,
+    [0xff] = 741,
+};
+
+static const uint16_t keysym_name_page_0b[256] = {
+    [0xa3] = 742,
+    [0xa6] = 743,
+    [0xa8] = 744,
+    [0xa9] = 745,
+    [0xc0] = 746,
+    [0xc2] = 747,
+    [0xc3] = 748,
+    [0xc4] = 749,
+    [0xc6] = 750,
+    [0xca] = 751,
+    [0xcc] = 752,
+    [0xce] = 753,
+    [0xcf] = 754,
+    [0xd3] = 755,
+    [0xd6] = 756,
+    [0xd8] = 757,
+    [0xda] = 758,
+    [0xdc] = 759,
+    [0xfc] = 760,
+};
+
+static const uint16_t keysym_name_page_0c[256] = {
+    [0xdf] = 761,
+    [0xe0] = 762,
+    [0xe1] = 763,
+    [0xe2] = 764,
+    [0xe3] = 765,
+    [0xe4] = 766,
+    [0xe5] = 767,
+    [0xe6] = 768,
+    [0xe7] = 769,
+    [0xe8] = 770,
+    [0xe9] = 771,
+    [0xea] = 772,
+    [0xeb] = 773,
+    [0xec] = 774,
+    [0xed] = 775,
+    [0xee] = 776,
+    [0xef] = 777,
+    [0xf0] = 778,
+    [0xf1] = 779,
+    [0xf2] = 780,
+    [0xf3] = 781,
+    [0xf4] = 782,
+    [0xf5] = 783,
+    [0xf6] = 784,
+    [0xf7] = 785,
+    [0xf8] = 786,
+    [0xf9] = 787,
+    [0xfa] = 788,
+};
+
+static const uint16_t keysym_name_page_0d[256] = {
+    [0xa1] = 789,
+    [0xa2] = 790,
+    [0xa3] = 791,
+    [0xa4] = 792,
+    [0xa5] = 793,
+    [0xa6] = 794,
+    [0xa7] = 795,
+    [0xa8] = 796,
+    [0xa9] = 797,
+    [0xaa] = 798,
+    [0xab] = 799,
+    [0xac] = 800,
+    [0xad] = 801,
+    [0xae] = 802,
+    [0xaf] = 803,
+    [0xb0] = 804,
+    [0xb1] = 805,
+    [0xb2] = 806,
+    [0xb3] = 807,
+    [0xb4] = 808,
+    [0xb5] = 809,
+    [0xb6] = 810,
+    [0xb7] = 811,
+    [0xb8] = 812,
+    [0xb9] = 813,
+    [0xba] = 814,
+    [0xbb] = 815,
+    [0xbc] = 816,
+    [0xbd] = 817,
+    [0xbe] = 818,
+    [0xbf] = 819,
+    [0xc0] = 820,
+    [0xc1] = 821,
+    [0xc2] = 822,
+    [0xc3] = 823,
+    [0xc4] = 824,
+    [0xc5] = 825,
+    [0xc6] = 826,
+    [0xc7] = 827,
+    [0xc8] = 828,
+    [0xc9] = 829,
+    [0xca] = 830,
+    [0xcb] = 831,
+    [0xcc] = 832,
+    [0xcd] = 833,
+    [0xce] = 834,
+    [0xcf] = 835,
+    [0xd0] = 836,
+    [0xd1] = 837,
+    [0xd2] = 838,
+    [0xd3] = 839,
+    [0xd4] = 840,
+    [0xd5] = 841,
+    [0xd6] = 842,
+    [0xd7] = 843,
+    [0xd8] = 844,
+    [0xd9] = 845,
+    [0xda] = 846,
+    [0xde] = 847,
+    [0xdf] = 848,
+    [0xe0] = 849,
+    [0xe1] = 850,
+    [0xe2] = 851,
+    [0xe3] = 852,
+    [0xe4] = 853,
+    [0xe5] = 854,
+    [0xe6] = 855,
+    [0xe7] = 856,
+    [0xe8] = 857,
+    [0xe9] = 858,
+    [0xea] = 859,
+    [0xeb] = 860,
+    [0xec] = 861,
+    [0xed] = 862,
+    [0xf0] = 863,
+    [0xf1] = 864,
+    [0xf2] = 865,
+    [0xf3] = 866,
+    [0xf4] = 867,
+    [0xf5] = 868,
+    [0xf6] = 869,
+    [0xf7] = 870,
+    [0xf8] = 871,
+    [0xf9] = 872,
+};
+
+static const uint16_t keysym_name_page_0e[256] = {
+    [0xa1] = 873,
+    [0xa2] = 874,
+    [0xa3] = 875,
+    [0xa4] = 876,
+    [0xa5] = 877,
+    [0xa6] = 878,
+    [0xa7] = 879,
+    [0xa8] = 880,
+    [0xa9] = 881,
+    [0xaa] = 882,
+    [0xab] = 883,
+    [0xac] = 884,
+    [0xad] = 885,
+    [0xae] = 886,
+    [0xaf] = 887,
+    [0xb0] = 888,
+    [0xb1] = 889,
+    [0xb2] = 890,
+    [0xb3] = 891,
+    [0xb4] = 892,
+    [0xb5] = 893,
+    [0xb6] = 894,
+    [0xb7] = 895,
+    [0xb8] = 896,
+    [0xb9] = 897,
+    [0xba] = 898,
+    [0xbb] = 899,
+    [0xbc] = 900,
+    [0xbd] = 901,
+    [0xbe] = 902,
+    [0xbf] = 903,
+    [0xc0] = 904,
+    [0xc1] = 905,
+    [0xc2] = 906,
+    [0xc3] = 907,
+    [0xc4] = 908,
+    [0xc5] = 909,
+    [0xc6] = 910,
+    [0xc7] = 911,
+    [0xc8] = 912,
+    [0xc9] = 913,
+    [0xca] = 914,
+    [0xcb] = 915,
+    [0xcc] = 916,
+    [0xcd] = 917,
+    [0xce] = 918,
+    [0xcf] = 919,
+    [0xd0] = 920,
+    [0xd1] = 921,
+    [0xd2] = 922,
+    [0xd3] = 923,
+    [0xd4] = 924,
+    [0xd5] = 925,
+    [0xd6] = 926,
+    [0xd7] = 927,
+    [0xd8] = 928,
+    [0xd9] = 929,
+    [0xda] = 930,
+    [0xdb] = 931,
+    [0xdc] = 932,
+    [0xdd] = 933,
+    [0xde] = 934,
+    [0xdf] = 935,
+    [0xe0] = 936,
+    [0xe1] = 937,
+    [0xe2] = 938,
+    [0xe3] = 939,
+    [0xe4] = 940,
+    [0xe5] = 941,
+    [0xe6] = 942,
+    [0xe7] = 943,
+    [0xe8] = 944,
+    [0xe9] = 945,
+    [0xea] = 946,
+    [0xeb] = 947,
+    [0xec] = 948,
+    [0xed] = 949,
+    [0xee] = 950,
+    [0xef] = 951,
+    [0xf0] = 952,
+    [0xf1] = 953,
+    [0xf2] = 954,
+    [0xf3] = 955,
+    [0xf4] = 956,
+    [0xf5] = 957,
+    [0xf6] = 958,
+    [0xf7] = 959,
+    [0xf8] = 960,
+    [0xf9] = 961,
+    [0xfa] = 962,
+    [0xff] = 963,
+};
+
+static const uint16_t keysym_name_page_13[256] = {
+    [0xbc] = 964,
+    [0xbd] = 965,
+    [0xbe] = 966,
+};
+
+static const uint16_t keysym_name_page_20[256] = {
+    [0xac] = 967,
+};
+
+static const uint16_t keysym_name_page_fd[256] = {
+    [0x01] = 968,
+    [0x02] = 969,
+    [0x03] = 970,
+    [0x04] = 971,
+    [0x05] = 972,
+    [0x06] = 973,
+    [0x07] = 974,
+    [0x08] = 975,
+    [0x09] = 976,
+    [0x0a] = 977,
+    [0x0b] = 978,
+    [0x0c] = 979,
+    [0x0d] = 980,
+    [0x0e] = 981,
+    [0x0f] = 982,
+    [0x10] = 983,
+    [0x11] = 984,
+    [0x12] = 985,
+    [0x13] = 986,
+    [0x14] = 987,
+    [0x15] = 988,
+    [0x16] = 989,
+    [0x17] = 990,
+    [0x18] = 991,
+    [0x19] = 992,
+    [0x1a] = 993,
+    [0x1b] = 994,
+    [0x1c] = 995,
+    [0x1d] = 996,
+    [0x1e] = 997,
+};
+
+static const uint16_t keysym_name_page_fe[256] = {
+    [0x01] = 998,
+    [0x02] = 999,
+    [0x03] = 1000,
+    [0x04] = 1001,
+    [0x05] = 1002,
+    [0x06] = 1003,
+    [0x07] = 1004,
+    [0x08] = 1005,
+    [0x09] = 1006,
+    [0x0a] = 1007,
+    [0x0b] = 1008,
+    [0x0c] = 1009,
+    [0x0d] = 1010,
+    [0x0e] = 1011,
+    [0x0f] = 1012,
+    [0x11] = 1013,
+    [0x12] = 1014,
+    [0x13] = 1015,
+    [0x20] = 1016,
+    [0x21] = 1017,
+    [0x22] = 1018,
+    [0x23] = 1019,
+    [0x24] = 1020,
+    [0x25] = 1021,
+    [0x26] = 1022,
+    [0x27] = 1023,
+    [0x28] = 1024,
+    [0x29] = 1025,
+    [0x2a] = 1026,
+    [0x2b] = 1027,
+    [0x2c] = 1028,
+    [0x2d] = 1029,
+    [0x2e] = 1030,
+    [0x2f] = 1031,
+    [0x30] = 1032,
+    [0x31] = 1033,
+    [0x32] = 1034,
+    [0x33] = 1035,
+    [0x34] = 1036,
+    [0x50] = 1037,
+    [0x51] = 1038,
+    [0x52] = 1039,
+    [0x53] = 1040,
+    [0x54] = 1041,
+    [0x55] = 1042,
+    [0x56] = 1043,
+    [0x57] = 1044,
+    [0x58] = 1045,
+    [0x59] = 1046,
+    [0x5a] = 1047,
+    [0x5b] = 1048,
+    [0x5c] = 1049,
+    [0x5d] = 1050,
+    [0x5e] = 1051,
+    [0x5f] = 1052,
+    [0x60] = 1053,
+    [0x61] = 1054,
+    [0x62] = 1055,
+    [0x63] = 1056,
+    [0x64] = 1057,
+    [0x65] = 1058,
+    [0x66] = 1059,
+    [0x67] = 1060,
+    [0x68] = 1061,
+    [0x69] = 1062,
+    [0x6a] = 1063,
+    [0x6b] = 1064,
+    [0x6c] = 1065,
+    [0x6d] = 1066,
+    [0x6e] = 1067,
+    [0x6f] = 1068,
+    [0x70] = 1069,
+    [0x71] = 1070,
+    [0x72] = 1071,
+    [0x73] = 1072,
+    [0x74] = 1073,
+    [0x75] = 1074,
+    [0x76] = 1075,
+    [0x77] = 1076,
+    [0x78] = 1077,
+    [0x79] = 1078,
+    [0x7a] = 1079,
+    [0x80] = 1080,
+    [0x81] = 1081,
+    [0x82] = 1082,
+    [0x83] = 1083,
+    [0x84] = 1084,
+    [0x85] = 1085,
+    [0x86] = 1086,
+    [0x87] = 1087,
+    [0x88] = 1088,
+    [0x89] = 1089,
+    [0x8a] = 1090,
+    [0x8b] = 1091,
+    [0x8c] = 1092,
+    [0x90] = 1093,
+    [0x91] = 1094,
+    [0x92] = 1095,
+    [0x93] = 1096,
+    [0xa0] = 1097,
+    [0xa1] = 1098,
+    [0xa2] = 1099,
+    [0xa3] = 1100,
+    [0xa4] = 1101,
+    [0xa5] = 1102,
+    [0xd0] = 1103,
+    [0xd1] = 1104,
+    [0xd2] = 1105,
+    [0xd4] = 1106,
+    [0xd5] = 1107,
+    [0xe0] = 1108,
+    [0xe1] = 1109,
+    [0xe2] = 1110,
+    [0xe3] = 1111,
+    [0xe4] = 1112,
+    [0xe5] = 1113,
+    [0xe6] = 1114,
+    [0xe7] = 1115,
+    [0xe8] = 1116,
+    [0xe9] = 1117,
+    [0xea] = 1118,
+    [0xeb] = 1119,
+    [0xec] = 1120,
+    [0xed] = 1121,
+    [0xee] = 1122,
+    [0xef] = 1123,
+    [0xf0] = 1124,
+    [0xf1] = 1125,
+    [0xf2] = 1126,
+    [0xf3] = 1127,
+    [0xf4] = 1128,
+    [0xf5] = 1129,
+    [0xf6] = 1130,
+    [0xf7] = 1131,
+    [0xf8] = 1132,
+    [0xf9] = 1133,
+    [0xfa] = 1134,
+    [0xfb] = 1135,
+    [0xfc] = 1136,
+    [0xfd] = 1137,
+};
+
+static const uint16_t keysym_name_page_ff[256] = {
+    [0x08] = 1138,
+    [0x09] = 1139,
+    [0x0a] = 1140,
+    [0x0b] = 1141,
+    [0x0d] = 1142,
+    [0x13] = 1143,
+    [0x14] = 1144,
+    [0x15] = 1145,
+    [0x1b] = 1146,
+    [0x20] = 1147,
+    [0x21] = 1148,
+    [0x22] = 1149,
+    [0x23] = 1150,
+    [0x24] = 1151,
+    [0x25] = 1152,
+    [0x26] = 1153,
+    [0x27] = 1154,
+    [0x28] = 1155,
+    [0x29] = 1156,
+    [0x2a] = 1157,
+    [0x2b] = 1158,
+    [0x2c] = 1159,
+    [0x2d] = 1160,
+    [0x2e] = 1161,
+    [0x2f] = 1162,
+    [0x30] = 1163,
+    [0x31] = 1164,
+    [0x32] = 1165,
+    [0x33] = 1166,
+    [0x34] = 1167,
+    [0x35] = 1168,
+    [0x36] = 1169,
+    [0x37] = 1170,
+    [0x38] = 1171,
+    [0x39] = 1172,
+    [0x3a] = 1173,
+    [0x3b] = 1174,
+    [0x3c] = 1175,
+    [0x3d] = 1176,
+    [0x3e] = 1177,
+    [0x3f] = 1178,
+    [0x50] = 1179,
+    [0x51] = 1180,
+    [0x52] = 1181,
+    [0x53] = 1182,
+    [0x54] = 1183,
+    [0x55] = 1184,
+    [0x56] = 1185,
+    [0x57] = 1186,
+    [0x58] = 1187,
+    [0x60] = 1188,
+    [0x61] = 1189,
+    [0x62] = 1190,
+    [0x63] = 1191,
+    [0x65] = 1192,
+    [0x66] = 1193,
+    [0x67] = 1194,
+    [0x68] = 1195,
+    [0x69] = 1196,
+    [0x6a] = 1197,
+    [0x6b] = 1198,
+    [0x7e] = 1199,
+    [0x7f] = 1200,
+    [0x80] = 1201,
+    [0x89] = 1202,
+    [0x8d] = 1203,
+    [0x91] = 1204,
+    [0x92] = 1205,
+    [0x93] = 1206,
+    [0x94] = 1207,
+    [0x95] = 1208,
+    [0x96] = 1209,
+    [0x97] = 1210,
+    [0x98] = 1211,
+    [0x99] = 1212,
+    [0x9a] = 1213,
+    [0x9b] = 1214,
+    [0x9c] = 1215,
+    [0x9d] = 1216,
+    [0x9e] = 1217,
+    [0x9f] = 1218,
+    [0xaa] = 1219,
+    [0xab] = 1220,
+    [0xac] = 1221,
+    [0xad] = 1222,
+    [0xae] = 1223,
+    [0xaf] = 1224,
+    [0xb0] = 1225,
+    [0xb1] = 1226,
+    [0xb2] = 1227,
+    [0xb3] = 1228,
+    [0xb4] = 1229,
+    [0xb5] = 1230,
+    [0xb6] = 1231,
+    [0xb7] = 1232,
+    [0xb8] = 1233,
+    [0xb9] = 1234,
+    [0xbd] = 1235,
+    [0xbe] = 1236,
+    [0xbf] = 1237,
+    [0xc0] = 1238,
+    [0xc1] = 1239,
+    [0xc2] = 1240,
+    [0xc3] = 1241,
+    [0xc4] = 1242,
+    [0xc5] = 1243,
+    [0xc6] = 1244,
+    [0xc7] = 1245,
+    [0xc8] = 1246,
+    [0xc9] = 1247,
+    [0xca] = 1248,
+    [0xcb] = 1249,
+    [0xcc] = 1250,
+    [0xcd] = 1251,
+    [0xce] = 1252,
+    [0xcf] = 1253,
+    [0xd0] = 1254,
+    [0xd1] = 1255,
+    [0xd2] = 1256,
+    [0xd3] = 1257,
+    [0xd4] = 1258,
+    [0xd5] = 1259,
+    [0xd6] = 1260,
+    [0xd7] = 1261,
+    [0xd8] = 1262,
+    [0xd9] = 1263,
+    [0xda] = 1264,
+    [0xdb] = 1265,
+    [0xdc] = 1266,
+    [0xdd] = 1267,
+    [0xde] = 1268,
+    [0xdf] = 1269,
+    [0xe0] = 1270,
+    [0xe1] = 1271,
+    [0xe2] = 1272,
+    [0xe3] = 1273,
+    [0xe4] = 1274,
+    [0xe5] = 1275,
+    [0xe6] = 1276,
+    [0xe7] = 1277,
+    [0xe8] = 1278,
+    [0xe9] = 1279,
+    [0xea] = 1280,
+    [0xeb] = 1281,
+    [0xec] = 1282,
+    [0xed] = 1283,
+    [0xee] = 1284,
+    [0xf1] = 1285,
+    [0xf2] = 1286,
+    [0xf3] = 1287,
+    [0xf4] = 1288,
+    [0xf5] = 1289,
+    [0xf6] = 1290,
+    [0xf7] = 1291,
+    [0xf8] = 1292,
+    [0xf9] = 1293,
+    [0xfa] = 1294,
+    [0xff] = 1295,
+};
+
+static const uint16_t *const keysym_name_pages[] = {
+    [0x00] = keysym_name_page_00,
+    [0x01] = keysym_name_page_01,
+    [0x02] = keysym_name_page_02,
+    [0x03] = keysym_name_page_03,
+    [0x04] = keysym_name_page_04,
+    [0x05] = keysym_name_page_05,
+    [0x06] = keysym_name_page_06,
+    [0x07] = keysym_name_page_07,
+    [0x08] = keysym_name_page_08,
+    [0x09] = keysym_name_page_09,
+    [0x0a] = keysym_name_page_0a,
+    [0x0b] = keysym_name_page_0b,
+    [0x0c] = keysym_name_page_0c,
+    [0x0d] = keysym_name_page_0d,
+    [0x0e] = keysym_name_page_0e,
+    [0x13] = keysym_name_page_13,
+    [0x20] = keysym_name_page_20,
+    [0xfd] = keysym_name_page_fd,
+    [0xfe] = keysym_name_page_fe,
+    [0xff] = keysym_name_page_ff,
+};
+
+static const uint16_t keysym_hash_displacements[] = {
+    7, 271, 1, 0, 57, 6, 103, 21, 16, 697,
+    16, 1, 201, 2, 21, 111, 9, 45, 6, 479,
+    133, 26, 226, 89, 5, 89, 3, 127, 2, 1,
+    0, 48, 8, 0, 12, 2, 117, 6, 63, 3,
+    128, 151, 5, 25, 12, 9, 4, 2, 124, 11,
+    1, 203, 12, 6, 52, 10, 79, 24, 376, 76,
+    3, 46, 104, 1, 2, 8, 746, 13, 1, 238,
+    9, 125, 293, 14, 74, 10, 296, 83, 5, 13,
+    262, 6, 5, 0, 324, 17, 2, 152, 77, 14,
+    2, 9, 163, 3, 222, 67, 19, 41, 24, 4,
+    10, 118, 147, 30, 3, 1, 280, 7, 4, 344,
+    0, 98, 158, 557, 3, 6, 8, 15, 36, 46,
+    77, 381, 1, 142, 35, 995, 18, 1, 0, 60,
+    0, 43, 81, 24, 7, 0, 205, 27, 1, 3121,
+    1, 196, 37, 234, 29, 73, 45, 1781, 1, 150,
+    28, 8, 22, 106, 295, 22, 0, 718, 302, 1548,
+    2, 7, 13, 94, 10, 101, 1, 428, 218, 4,
+    304, 58, 1110, 1022, 49, 0, 2, 326, 80, 30,
+    29, 29, 0, 165, 1, 34, 116, 2, 112, 694,
+    5, 28, 24, 56, 221, 0, 2077, 506, 7, 472,
+    346, 23, 0, 40, 23, 1, 550, 1037, 0, 160,
+    80, 64, 0, 31, 6266, 39, 80, 41, 480, 110,
+    36, 1233, 92, 11, 7971, 0, 1274, 28, 1, 318,
+    133, 0, 163, 67, 54, 1, 210, 126, 130, 775,
+    0, 120, 18087, 589, 912, 1643,
+};
+
+static const uint16_t keysym_hash_slots[] = {
+    2168, 1758, 2258, 1410, 1331, 2248, 2274, 2140, 2215, 1519,
+    1472, 1917, 1691, 1698, 2058, 1353, 1336, 1744, 2043, 2118,
+    1991, 1981, 1986, 1655, 1638, 2263, 1323, 1694, 2069, 2249,
+    1417, 2203, 1667, 1570, 1602, 1996, 2195, 1380, 2219, 2186,
+    1896, 2238, 1464, 1402, 1684, 2155, 1584, 1715, 1512, 2154,
+    2017, 2006, 2127, 2205, 2112, 1797, 1466, 1579, 2148, 1907,
+    2167, 1695, 1581, 2265, 2206, 1806, 1693, 1775, 1406, 2061,
+    2021, 2053, 1530, 1648, 1689, 1354, 2171, 1341, 1828, 2029,
+    1904, 1969, 1583, 1431, 1653, 1607, 1711, 1338, 1360, 2158,
+    2227, 1770, 2037, 2164, 1854, 1999, 1594, 1327, 2018, 1609,
+    1551, 1440, 1337, 1796, 1643, 1721, 1942, 2106, 1718, 2250,
+    1833, 1362, 1508, 1306, 2191, 1611, 1935, 2146, 1635, 1974,
+    2108, 1918, 2131, 1993, 2150, 1827, 2089, 1488, 2166, 1619,
+    1332, 1314, 1484, 2028, 2070, 1808, 1965, 2179, 1606, 1792,
+    2183, 2065, 1572, 1313, 1615, 1588, 1709, 2068, 2209, 1636,
+    1358, 1453, 2244, 1312, 1299, 1343, 2141, 1503, 1762, 1350,
+    1654, 1958, 1920, 1782, 1516, 2199, 1333, 1864, 2184, 1438,
+    1818, 1577, 2275, 1670, 1390, 1334, 1879, 1534, 1518, 1888,
+    1544, 1622, 1941, 1905, 2074, 1591, 1957, 1379, 1681, 2004,
+    1356, 1764, 1509, 1823, 1382, 2044, 1441, 1666, 1388, 1687,
+    1392, 1521, 2262, 2094, 1690, 1840, 1856, 1495, 1523, 1720,
+    1656, 1767, 1887, 1725, 2197, 1909, 1778, 1810, 1616, 2273,
+    1640, 1794, 1647, 1967, 1415, 1870, 1931, 1592, 1884, 2045,
+    2193, 2236, 1627, 1597, 1966, 1432, 1734, 1686, 2172, 1456,
+    1351, 1593, 1962, 1822, 1805, 2231, 1820, 1889, 1506, 1790,
+    1752, 1809, 1703, 2222, 2096, 1662, 1450, 1330, 1344, 1511,
+    2245, 1745, 2052, 1872, 2212, 1803, 1585, 1682, 1825, 1834,
+    1722, 2138, 1995, 1576, 2067, 1971, 2153, 1875, 1547, 2105,
+    2259, 1492, 1977, 1847, 1639, 2109, 2054, 2027, 1804, 2086,
+    1661, 2181, 1478, 1798, 1634, 2143, 1465, 1791, 1300, 2038,
+    2120, 2232, 2268, 1471, 2019, 1880, 1696, 2115, 1598, 1387,
+    1713, 1522, 2165, 1397, 1858, 1901, 1457, 1915, 1620, 1340,
+    1924, 1705, 1912, 1742, 1843, 2035, 1600, 1644, 1951, 1730,
+    1771, 1850, 1784, 1925, 1372, 1865, 1505, 1952, 1419, 2267,
+    2016, 1496, 1386, 2080, 1395, 1992, 1719, 2104, 1479, 2126,
+    1428, 1540, 1400, 2125, 1396, 1956, 1859, 1837, 1364, 1751,
+    1394, 1664, 1842, 2157, 2178, 2073, 1524, 1578, 2228, 2226,
+    2057, 1434, 1618, 2090, 1815, 2124, 1564, 1679, 2253, 1921,
+    1371, 1754, 2012, 2001, 1726, 2100, 1365, 1936, 2161, 1886,
+    1860, 2007, 1378, 1959, 2192, 1641, 1451, 1305, 1446, 2049,
+    2020, 1349, 1608, 2034, 1738, 1997, 1320, 1688, 1321, 1481,
+    1978, 1470, 1651, 1377, 1507, 2223, 2207, 1310, 1383, 2075,
+    1498, 2188, 1363, 2081, 2276, 2170, 2032, 1650, 1502, 1557,
+    2214, 1976, 2256, 2163, 1893, 1562, 2092, 1309, 1903, 1501,
+    2101, 1574, 1317, 1736, 1960, 2002, 1899, 1407, 1975, 1731,
+    2261, 1874, 1933, 2213, 1494, 1433, 1795, 2201, 1629, 1376,
+    1746, 1625, 1391, 1878, 1443, 1829, 1550, 1755, 1898, 1848,
+    1437, 2160, 1628, 1914, 1426, 2257, 1297, 1766, 1683, 1704,
+    1504, 1621, 2242, 1932, 1890, 1526, 1589, 1821, 1708, 1747,
+    2110, 1326, 1835, 1873, 1546, 2091, 1816, 1612, 1753, 2133,
+    2129, 1367, 1476, 1535, 1868, 2085, 1352, 2121, 1556, 1701,
+    1739, 1973, 2103, 2040, 1674, 1318, 2132, 1765, 1657, 2031,
+    1532, 1853, 1474, 1549, 2241, 1527, 1844, 1632, 1490, 2149,
+    1939, 1788, 2196, 1714, 1605, 1919, 2015, 2174, 1296, 2119,
+    1855, 1676, 2022, 1902, 1857, 1449, 1885, 1427, 1455, 1566,
+    1979, 1567, 1768, 1950, 2041, 1839, 2162, 1867, 2137, 1473,
+    1430, 1357, 1520, 1329, 1537, 2023, 1335, 2251, 2224, 1826,
+    1706, 2136, 1298, 2139, 2130, 2151, 1370, 1480, 1328, 1988,
+    1802, 2102, 2208, 1458, 1945, 2159, 1671, 1469, 1604, 1302,
+    1491, 1897, 1910, 1423, 1429, 1624, 2066, 1787, 1614, 1420,
+    1569, 1700, 1946, 1779, 1573, 1869, 2254, 1891, 1906, 2024,
+    1961, 1559, 1944, 1373, 1529, 1347, 1985, 1675, 1399, 1665,
+    2266, 1375, 1424, 1590, 2152, 1355, 1413, 2233, 1877, 1949,
+    2144, 1542, 2202, 1467, 2042, 1743, 1953, 1669, 1568, 2077,
+    1541, 2270, 1748, 1668, 1645, 1393, 2055, 1311, 1459, 1416,
+    2003, 2220, 2175, 1571, 1553, 1938, 1982, 1543, 2046, 1405,
+    1908, 2237, 2221, 1883, 1759, 1954, 2177, 2026, 2099, 1913,
+    1554, 1994, 2050, 1673, 1663, 1757, 1617, 1342, 1325, 1531,
+    1319, 1398, 1948, 2169, 1677, 1513, 1595, 1596, 1811, 1486,
+    1548, 2190, 1369, 1384, 2246, 2087, 1418, 2116, 2013, 1733,
+    1724, 2059, 1485, 1439, 1852, 1760, 1972, 1799, 2005, 2014,
+    1862, 2088, 2173, 1435, 1964, 2025, 1301, 1781, 2079, 1630,
+    2200, 2243, 2247, 2062, 1381, 2211, 1613, 1732, 1740, 2180,
+    1772, 1538, 1846, 1866, 1983, 2122, 1968, 2271, 1389, 1422,
+    1500, 1658, 2033, 1414, 1727, 1497, 1528, 1832, 1560, 1785,
+    2185, 1786, 1558, 1599, 1793, 2078, 2204, 1807, 1346, 2142,
+    1580, 2107, 1552, 1984, 2008, 2187, 1475, 1533, 1773, 1927,
+    1710, 2056, 1922, 2082, 1448, 1315, 1987, 1831, 2225, 1339,
+    1817, 1637, 1454, 1425, 1461, 2093, 2072, 2111, 2255, 1545,
+    1575, 1735, 1403, 1926, 1723, 1483, 1800, 1680, 1385, 1361,
+    2123, 2194, 1702, 1565, 1830, 1729, 2047, 1587, 2239, 1678,
+    1307, 2235, 1646, 1697, 1955, 2210, 1499, 1849, 1863, 2230,
+    1304, 1659, 1814, 1515, 1923, 1836, 1463, 1672, 1633, 1460,
+    1444, 1525, 1366, 2076, 1776, 1603, 1409, 2217, 1322, 2060,
+    2189, 2113, 1934, 1819, 1911, 2260, 1990, 1477, 1626, 1774,
+    1900, 1871, 1685, 1582, 1929, 1728, 2145, 2010, 1555, 1930,
+    1756, 2084, 2117, 1652, 1947, 1359, 1801, 2063, 1892, 1777,
+    1851, 1348, 2009, 1445, 2264, 2128, 2098, 1894, 2030, 1539,
+    1623, 2176, 1510, 2071, 1895, 1308, 1881, 1928, 1631, 1316,
+    1404, 1699, 1642, 1741, 1468, 1943, 2000, 1813, 1452, 1763,
+    1937, 2252, 2083, 1447, 1436, 1737, 1783, 1845, 1482, 1374,
+    1295, 1536, 1563, 1838, 1769, 2135, 1345, 1940, 2011, 1876,
+    1712, 1324, 1601, 2234, 1789, 1824, 1421, 1980, 1586, 1493,
+    1610, 2114, 1517, 1780, 1812, 1963, 1707, 1989, 1717, 1411,
+    1998, 2134, 2229, 1489, 1368, 1660, 2218, 2048, 1561, 2095,
+    2147, 2272, 1749, 1750, 1303, 1442, 1514, 2051, 2240, 1462,
+    2064, 2097, 2039, 1861, 1487, 2182, 1882, 1401, 1916, 2216,
+    2156, 1970, 1692, 1408, 2036, 1649, 2269, 2198, 1716, 1761,
+    1412, 1841,
+};
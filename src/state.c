@@ -64,7 +64,7 @@
 #include "utf8.h"
 
 struct xkb_filter {
-    union xkb_action action;
+    union xkb_packed_action action;
     const struct xkb_key *key;
     uint32_t priv;
     bool (*func)(struct xkb_state *state,
@@ -215,9 +215,9 @@ xkb_state_key_get_layout(struct xkb_state *state, xkb_keycode_t kc)
                                  key->out_of_range_group_number);
 }
 
-static const union xkb_action fake = { .type = ACTION_TYPE_NONE };
+static const union xkb_packed_action fake = { .type = ACTION_TYPE_NONE };
 
-static const union xkb_action *
+static const union xkb_packed_action *
 xkb_key_get_action(struct xkb_state *state, const struct xkb_key *key)
 {
     xkb_layout_index_t layout;
@@ -343,9 +343,9 @@ xkb_filter_mod_set_func(struct xkb_state *state,
         return false;
     }
 
-    state->clear_mods = filter->action.mods.mods.mask;
+    state->clear_mods = filter->action.mods.mask;
     if (filter->action.mods.flags & ACTION_LOCK_CLEAR)
-        state->components.locked_mods &= ~filter->action.mods.mods.mask;
+        state->components.locked_mods &= ~filter->action.mods.mask;
 
     filter->func = NULL;
     return true;
@@ -354,7 +354,7 @@ xkb_filter_mod_set_func(struct xkb_state *state,
 static void
 xkb_filter_mod_set_new(struct xkb_state *state, struct xkb_filter *filter)
 {
-    state->set_mods = filter->action.mods.mods.mask;
+    state->set_mods = filter->action.mods.mask;
 }
 
 static bool
@@ -373,7 +373,7 @@ xkb_filter_mod_lock_func(struct xkb_state *state,
     if (--filter->refcnt > 0)
         return false;
 
-    state->clear_mods |= filter->action.mods.mods.mask;
+    state->clear_mods |= filter->action.mods.mask;
     if (!(filter->action.mods.flags & ACTION_LOCK_NO_UNLOCK))
         state->components.locked_mods &= ~filter->priv;
 
@@ -385,10 +385,10 @@ static void
 xkb_filter_mod_lock_new(struct xkb_state *state, struct xkb_filter *filter)
 {
     filter->priv = (state->components.locked_mods &
-                    filter->action.mods.mods.mask);
-    state->set_mods |= filter->action.mods.mods.mask;
+                    filter->action.mods.mask);
+    state->set_mods |= filter->action.mods.mask;
     if (!(filter->action.mods.flags & ACTION_LOCK_NO_LOCK))
-        state->components.locked_mods |= filter->action.mods.mods.mask;
+        state->components.locked_mods |= filter->action.mods.mask;
 }
 
 enum xkb_key_latch_state {
@@ -398,7 +398,7 @@ enum xkb_key_latch_state {
 };
 
 static bool
-xkb_action_breaks_latch(const union xkb_action *action)
+xkb_action_breaks_latch(const union xkb_packed_action *action)
 {
     switch (action->type) {
     case ACTION_TYPE_NONE:
@@ -427,30 +427,30 @@ xkb_filter_mod_latch_func(struct xkb_state *state,
          * keypress, then either break the latch if any random key is pressed,
          * or promote it to a lock or plain base set if it's the same
          * modifier. */
-        const union xkb_action *action = xkb_key_get_action(state, key);
+        const union xkb_packed_action *action = xkb_key_get_action(state, key);
         if (action->type == ACTION_TYPE_MOD_LATCH &&
             action->mods.flags == filter->action.mods.flags &&
-            action->mods.mods.mask == filter->action.mods.mods.mask) {
+            action->mods.mask == filter->action.mods.mask) {
             filter->action = *action;
             if (filter->action.mods.flags & ACTION_LATCH_TO_LOCK) {
                 filter->action.type = ACTION_TYPE_MOD_LOCK;
                 filter->func = xkb_filter_mod_lock_func;
-                state->components.locked_mods |= filter->action.mods.mods.mask;
+                state->components.locked_mods |= filter->action.mods.mask;
             }
             else {
                 filter->action.type = ACTION_TYPE_MOD_SET;
                 filter->func = xkb_filter_mod_set_func;
-                state->set_mods = filter->action.mods.mods.mask;
+                state->set_mods = filter->action.mods.mask;
             }
             filter->key = key;
-            state->components.latched_mods &= ~filter->action.mods.mods.mask;
+            state->components.latched_mods &= ~filter->action.mods.mask;
             /* XXX beep beep! */
             return false;
         }
         else if (xkb_action_breaks_latch(action)) {
             /* XXX: This may be totally broken, we might need to break the
              *      latch in the next run after this press? */
-            state->components.latched_mods &= ~filter->action.mods.mods.mask;
+            state->components.latched_mods &= ~filter->action.mods.mask;
             filter->func = NULL;
             return true;
         }
@@ -463,22 +463,22 @@ xkb_filter_mod_latch_func(struct xkb_state *state,
          * latched. */
         if (latch == NO_LATCH ||
             ((filter->action.mods.flags & ACTION_LOCK_CLEAR) &&
-             (state->components.locked_mods & filter->action.mods.mods.mask) ==
-             filter->action.mods.mods.mask)) {
+             (state->components.locked_mods & filter->action.mods.mask) ==
+             filter->action.mods.mask)) {
             /* XXX: We might be a bit overenthusiastic about clearing
              *      mods other filters have set here? */
             if (latch == LATCH_PENDING)
                 state->components.latched_mods &=
-                    ~filter->action.mods.mods.mask;
+                    ~filter->action.mods.mask;
             else
-                state->clear_mods = filter->action.mods.mods.mask;
-            state->components.locked_mods &= ~filter->action.mods.mods.mask;
+                state->clear_mods = filter->action.mods.mask;
+            state->components.locked_mods &= ~filter->action.mods.mask;
             filter->func = NULL;
         }
         else {
             latch = LATCH_PENDING;
-            state->clear_mods = filter->action.mods.mods.mask;
-            state->components.latched_mods |= filter->action.mods.mods.mask;
+            state->clear_mods = filter->action.mods.mask;
+            state->components.latched_mods |= filter->action.mods.mask;
             /* XXX beep beep! */
         }
     }
@@ -499,7 +499,7 @@ static void
 xkb_filter_mod_latch_new(struct xkb_state *state, struct xkb_filter *filter)
 {
     filter->priv = LATCH_KEY_DOWN;
-    state->set_mods = filter->action.mods.mods.mask;
+    state->set_mods = filter->action.mods.mask;
 }
 
 static const struct {
@@ -530,7 +530,7 @@ xkb_filter_apply_all(struct xkb_state *state,
                      enum xkb_key_direction direction)
 {
     struct xkb_filter *filter;
-    const union xkb_action *action;
+    const union xkb_packed_action *action;
     bool send = true;
 
     /* First run through all the currently active filters and see if any of
@@ -203,6 +203,39 @@ unmap_file(const char *str, size_t size);
 # define unlikely(x) (x)
 #endif
 
+/*
+ * Reference counts, which are atomic since objects may be shared between
+ * threads; see XKB_CONTEXT_THREAD_SAFE.
+ */
+static inline void
+refcnt_inc(int *refcnt)
+{
+    __sync_add_and_fetch(refcnt, 1);
+}
+
+/* Returns true if the last reference was dropped. */
+static inline bool
+refcnt_dec(int *refcnt)
+{
+    return __sync_sub_and_fetch(refcnt, 1) <= 0;
+}
+
+/* Take a reference only if the object is not being freed. */
+static inline bool
+refcnt_inc_not_zero(int *refcnt)
+{
+    int old = *(volatile int *) refcnt;
+
+    while (old > 0) {
+        int prev = __sync_val_compare_and_swap(refcnt, old, old + 1);
+        if (prev == old)
+            return true;
+        old = prev;
+    }
+
+    return false;
+}
+
 /* Compiler Attributes */
 
 #if defined(__GNUC__) && (__GNUC__ >= 4) && !defined(__CYGWIN__)
@@ -378,16 +378,10 @@ fail:
 }
 
 static bool
-get_sym_maps(struct xkb_keymap *keymap, xcb_connection_t *conn,
-             xcb_xkb_get_map_reply_t *reply, xcb_xkb_get_map_map_t *map)
+get_keys(struct xkb_keymap *keymap, xcb_connection_t *conn,
+         xcb_xkb_get_map_reply_t *reply, xcb_xkb_get_map_map_t *map)
 {
-    int sym_maps_length = xcb_xkb_get_map_map_syms_rtrn_length(reply, map);
-    xcb_xkb_key_sym_map_iterator_t sym_maps_iter =
-        xcb_xkb_get_map_map_syms_rtrn_iterator(reply, map);
-
     FAIL_UNLESS(reply->minKeyCode <= reply->maxKeyCode);
-    FAIL_UNLESS(reply->firstKeySym >= reply->minKeyCode);
-    FAIL_UNLESS(reply->firstKeySym + reply->nKeySyms <= reply->maxKeyCode + 1);
 
     keymap->min_key_code = reply->minKeyCode;
     keymap->max_key_code = reply->maxKeyCode;
@@ -397,6 +391,25 @@ get_sym_maps(struct xkb_keymap *keymap, xcb_connection_t *conn,
     for (xkb_keycode_t kc = keymap->min_key_code; kc <= keymap->max_key_code; kc++)
         keymap->keys[kc].keycode = kc;
 
+    return true;
+
+fail:
+    return false;
+}
+
+static bool
+get_sym_maps(struct xkb_keymap *keymap, xcb_connection_t *conn,
+             xcb_xkb_get_map_reply_t *reply, xcb_xkb_get_map_map_t *map)
+{
+    int sym_maps_length = xcb_xkb_get_map_map_syms_rtrn_length(reply, map);
+    xcb_xkb_key_sym_map_iterator_t sym_maps_iter =
+        xcb_xkb_get_map_map_syms_rtrn_iterator(reply, map);
+
+    FAIL_UNLESS(reply->minKeyCode == keymap->min_key_code);
+    FAIL_UNLESS(reply->maxKeyCode == keymap->max_key_code);
+    FAIL_UNLESS(reply->firstKeySym >= reply->minKeyCode);
+    FAIL_UNLESS(reply->firstKeySym + reply->nKeySyms <= reply->maxKeyCode + 1);
+
     for (int i = 0; i < sym_maps_length; i++) {
         xcb_xkb_key_sym_map_t *wire_sym_map = sym_maps_iter.data;
         struct xkb_key *key = &keymap->keys[reply->firstKeySym + i];
@@ -465,9 +478,9 @@ get_actions(struct xkb_keymap *keymap, xcb_connection_t *conn,
     xcb_xkb_key_sym_map_iterator_t sym_maps_iter =
         xcb_xkb_get_map_map_syms_rtrn_iterator(reply, map);
 
-    FAIL_UNLESS(reply->firstKeyAction == keymap->min_key_code);
-    FAIL_UNLESS(reply->firstKeyAction + reply->nKeyActions ==
-                keymap->max_key_code + 1);
+    /* The actions are read along with the keysyms, so must match them. */
+    FAIL_UNLESS(reply->firstKeyAction == reply->firstKeySym);
+    FAIL_UNLESS(reply->nKeyActions == reply->nKeySyms);
 
     for (int i = 0; i < acts_count_length; i++) {
         xcb_xkb_key_sym_map_t *wire_sym_map = sym_maps_iter.data;
@@ -483,10 +496,12 @@ get_actions(struct xkb_keymap *keymap, xcb_connection_t *conn,
             const xkb_level_index_t level = j % wire_sym_map->width;
 
             if (level < key->groups[group].type->num_levels) {
-                union xkb_action *action =
-                    &key->groups[group].levels[level].action;
+                union xkb_action action;
 
-                translate_action(action, wire_action);
+                memset(&action, 0, sizeof(action));
+                translate_action(&action, wire_action);
+                XkbPackAction(&key->groups[group].levels[level].action,
+                              &action);
             }
 
             xcb_xkb_action_next(&acts_iter);
@@ -623,27 +638,33 @@ fail:
     return false;
 }
 
+static const xcb_xkb_map_part_t get_map_required_components =
+    (XCB_XKB_MAP_PART_KEY_TYPES |
+     XCB_XKB_MAP_PART_KEY_SYMS |
+     XCB_XKB_MAP_PART_MODIFIER_MAP |
+     XCB_XKB_MAP_PART_EXPLICIT_COMPONENTS |
+     XCB_XKB_MAP_PART_KEY_ACTIONS |
+     XCB_XKB_MAP_PART_VIRTUAL_MODS |
+     XCB_XKB_MAP_PART_VIRTUAL_MOD_MAP);
+
+static xcb_xkb_get_map_cookie_t
+send_map_request(xcb_connection_t *conn, uint16_t device_id)
+{
+    return xcb_xkb_get_map(conn, device_id, get_map_required_components,
+                           0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+}
+
 static bool
-get_map(struct xkb_keymap *keymap, xcb_connection_t *conn, uint16_t device_id)
+get_map(struct xkb_keymap *keymap, xcb_connection_t *conn,
+        xcb_xkb_get_map_cookie_t cookie)
 {
-    static const xcb_xkb_map_part_t required_components =
-        (XCB_XKB_MAP_PART_KEY_TYPES |
-         XCB_XKB_MAP_PART_KEY_SYMS |
-         XCB_XKB_MAP_PART_MODIFIER_MAP |
-         XCB_XKB_MAP_PART_EXPLICIT_COMPONENTS |
-         XCB_XKB_MAP_PART_KEY_ACTIONS |
-         XCB_XKB_MAP_PART_VIRTUAL_MODS |
-         XCB_XKB_MAP_PART_VIRTUAL_MOD_MAP);
-
-    xcb_xkb_get_map_cookie_t cookie =
-        xcb_xkb_get_map(conn, device_id, required_components,
-                        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
     xcb_xkb_get_map_reply_t *reply = xcb_xkb_get_map_reply(conn, cookie, NULL);
     xcb_xkb_get_map_map_t map;
 
     FAIL_IF_BAD_REPLY(reply, "XkbGetMap");
 
-    if ((reply->present & required_components) != required_components)
+    if ((reply->present & get_map_required_components) !=
+        get_map_required_components)
         goto fail;
 
     xcb_xkb_get_map_map_unpack(xcb_xkb_get_map_map(reply),
@@ -660,6 +681,7 @@ get_map(struct xkb_keymap *keymap, xcb_connection_t *conn, uint16_t device_id)
                                &map);
 
     if (!get_types(keymap, conn, reply, &map) ||
+        !get_keys(keymap, conn, reply, &map) ||
         !get_sym_maps(keymap, conn, reply, &map) ||
         !get_actions(keymap, conn, reply, &map) ||
         !get_vmods(keymap, conn, reply, &map) ||
@@ -728,10 +750,8 @@ get_indicators(struct xkb_keymap *keymap, xcb_connection_t *conn,
 
 static bool
 get_indicator_map(struct xkb_keymap *keymap, xcb_connection_t *conn,
-                  uint16_t device_id)
+                  xcb_xkb_get_indicator_map_cookie_t cookie)
 {
-    xcb_xkb_get_indicator_map_cookie_t cookie =
-        xcb_xkb_get_indicator_map(conn, device_id, ALL_INDICATORS_MASK);
     xcb_xkb_get_indicator_map_reply_t *reply =
         xcb_xkb_get_indicator_map_reply(conn, cookie, NULL);
 
@@ -810,10 +830,8 @@ fail:
 
 static bool
 get_compat_map(struct xkb_keymap *keymap, xcb_connection_t *conn,
-               uint16_t device_id)
+               xcb_xkb_get_compat_map_cookie_t cookie)
 {
-    xcb_xkb_get_compat_map_cookie_t cookie =
-        xcb_xkb_get_compat_map(conn, device_id, 0, true, 0, 0);
     xcb_xkb_get_compat_map_reply_t *reply =
         xcb_xkb_get_compat_map_reply(conn, cookie, NULL);
 
@@ -831,7 +849,8 @@ fail:
 }
 
 static bool
-get_type_names(struct xkb_keymap *keymap, xcb_connection_t *conn,
+get_type_names(struct xkb_keymap *keymap,
+               struct x11_atom_interner *interner,
                xcb_xkb_get_names_reply_t *reply,
                xcb_xkb_get_names_value_list_t *list)
 {
@@ -859,13 +878,9 @@ get_type_names(struct xkb_keymap *keymap, xcb_connection_t *conn,
 
         ALLOC_OR_FAIL(type->level_names, type->num_levels);
 
-        if (!adopt_atom(keymap->ctx, conn, wire_type_name, &type->name))
-            goto fail;
-
-        if (!adopt_atoms(keymap->ctx, conn,
-                         kt_level_names_iter, type->level_names,
-                         wire_num_levels))
-            goto fail;
+        x11_atom_interner_adopt_atom(interner, wire_type_name, &type->name);
+        x11_atom_interner_adopt_atoms(interner, kt_level_names_iter,
+                                      type->level_names, wire_num_levels);
 
         kt_level_names_iter += wire_num_levels;
         key_type_names_iter++;
@@ -879,7 +894,8 @@ fail:
 }
 
 static bool
-get_indicator_names(struct xkb_keymap *keymap, xcb_connection_t *conn,
+get_indicator_names(struct xkb_keymap *keymap,
+                    struct x11_atom_interner *interner,
                     xcb_xkb_get_names_reply_t *reply,
                     xcb_xkb_get_names_value_list_t *list)
 {
@@ -892,8 +908,7 @@ get_indicator_names(struct xkb_keymap *keymap, xcb_connection_t *conn,
             xcb_atom_t wire = *iter;
             struct xkb_led *led = &keymap->leds[i];
 
-            if (!adopt_atom(keymap->ctx, conn, wire, &led->name))
-                return false;
+            x11_atom_interner_adopt_atom(interner, wire, &led->name);
 
             iter++;
         }
@@ -906,7 +921,8 @@ fail:
 }
 
 static bool
-get_vmod_names(struct xkb_keymap *keymap, xcb_connection_t *conn,
+get_vmod_names(struct xkb_keymap *keymap,
+               struct x11_atom_interner *interner,
                xcb_xkb_get_names_reply_t *reply,
                xcb_xkb_get_names_value_list_t *list)
 {
@@ -924,8 +940,7 @@ get_vmod_names(struct xkb_keymap *keymap, xcb_connection_t *conn,
             xcb_atom_t wire = *iter;
             struct xkb_mod *mod = &keymap->mods.mods[NUM_REAL_MODS + i];
 
-            if (!adopt_atom(keymap->ctx, conn, wire, &mod->name))
-                return false;
+            x11_atom_interner_adopt_atom(interner, wire, &mod->name);
 
             iter++;
         }
@@ -935,7 +950,8 @@ get_vmod_names(struct xkb_keymap *keymap, xcb_connection_t *conn,
 }
 
 static bool
-get_group_names(struct xkb_keymap *keymap, xcb_connection_t *conn,
+get_group_names(struct xkb_keymap *keymap,
+                struct x11_atom_interner *interner,
                 xcb_xkb_get_names_reply_t *reply,
                 xcb_xkb_get_names_value_list_t *list)
 {
@@ -945,9 +961,8 @@ get_group_names(struct xkb_keymap *keymap, xcb_connection_t *conn,
     keymap->num_group_names = msb_pos(reply->groupNames);
     ALLOC_OR_FAIL(keymap->group_names, keymap->num_group_names);
 
-    if (!adopt_atoms(keymap->ctx, conn,
-                     iter, keymap->group_names, length))
-        goto fail;
+    x11_atom_interner_adopt_atoms(interner, iter,
+                                  keymap->group_names, length);
 
     return true;
 
@@ -956,7 +971,8 @@ fail:
 }
 
 static bool
-get_key_names(struct xkb_keymap *keymap, xcb_connection_t *conn,
+get_key_names(struct xkb_keymap *keymap,
+              struct x11_atom_interner *interner,
               xcb_xkb_get_names_reply_t *reply,
               xcb_xkb_get_names_value_list_t *list)
 {
@@ -994,7 +1010,8 @@ fail:
 }
 
 static bool
-get_aliases(struct xkb_keymap *keymap, xcb_connection_t *conn,
+get_aliases(struct xkb_keymap *keymap,
+            struct x11_atom_interner *interner,
             xcb_xkb_get_names_reply_t *reply,
             xcb_xkb_get_names_value_list_t *list)
 {
@@ -1027,32 +1044,35 @@ fail:
     return false;
 }
 
+static const xcb_xkb_name_detail_t get_names_wanted =
+    (XCB_XKB_NAME_DETAIL_KEYCODES |
+     XCB_XKB_NAME_DETAIL_SYMBOLS |
+     XCB_XKB_NAME_DETAIL_TYPES |
+     XCB_XKB_NAME_DETAIL_COMPAT |
+     XCB_XKB_NAME_DETAIL_KEY_TYPE_NAMES |
+     XCB_XKB_NAME_DETAIL_KT_LEVEL_NAMES |
+     XCB_XKB_NAME_DETAIL_INDICATOR_NAMES |
+     XCB_XKB_NAME_DETAIL_KEY_NAMES |
+     XCB_XKB_NAME_DETAIL_KEY_ALIASES |
+     XCB_XKB_NAME_DETAIL_VIRTUAL_MOD_NAMES |
+     XCB_XKB_NAME_DETAIL_GROUP_NAMES);
+
+static const xcb_xkb_name_detail_t get_names_required =
+    (XCB_XKB_NAME_DETAIL_KEY_TYPE_NAMES |
+     XCB_XKB_NAME_DETAIL_KT_LEVEL_NAMES |
+     XCB_XKB_NAME_DETAIL_KEY_NAMES |
+     XCB_XKB_NAME_DETAIL_VIRTUAL_MOD_NAMES);
+
+/*
+ * Only the names in reply->which are set, so that a keymap's names may
+ * be updated by requesting those which changed.
+ */
 static bool
-get_names(struct xkb_keymap *keymap, xcb_connection_t *conn,
-          uint16_t device_id)
+get_names(struct xkb_keymap *keymap, struct x11_atom_interner *interner,
+          xcb_xkb_get_names_cookie_t cookie, uint32_t required)
 {
-    static const xcb_xkb_name_detail_t wanted =
-        (XCB_XKB_NAME_DETAIL_KEYCODES |
-         XCB_XKB_NAME_DETAIL_SYMBOLS |
-         XCB_XKB_NAME_DETAIL_TYPES |
-         XCB_XKB_NAME_DETAIL_COMPAT |
-         XCB_XKB_NAME_DETAIL_KEY_TYPE_NAMES |
-         XCB_XKB_NAME_DETAIL_KT_LEVEL_NAMES |
-         XCB_XKB_NAME_DETAIL_INDICATOR_NAMES |
-         XCB_XKB_NAME_DETAIL_KEY_NAMES |
-         XCB_XKB_NAME_DETAIL_KEY_ALIASES |
-         XCB_XKB_NAME_DETAIL_VIRTUAL_MOD_NAMES |
-         XCB_XKB_NAME_DETAIL_GROUP_NAMES);
-    static const xcb_xkb_name_detail_t required =
-        (XCB_XKB_NAME_DETAIL_KEY_TYPE_NAMES |
-         XCB_XKB_NAME_DETAIL_KT_LEVEL_NAMES |
-         XCB_XKB_NAME_DETAIL_KEY_NAMES |
-         XCB_XKB_NAME_DETAIL_VIRTUAL_MOD_NAMES);
-
-    xcb_xkb_get_names_cookie_t cookie =
-        xcb_xkb_get_names(conn, device_id, wanted);
     xcb_xkb_get_names_reply_t *reply =
-        xcb_xkb_get_names_reply(conn, cookie, NULL);
+        xcb_xkb_get_names_reply(interner->conn, cookie, NULL);
     xcb_xkb_get_names_value_list_t list;
 
     FAIL_IF_BAD_REPLY(reply, "XkbGetNames");
@@ -1070,23 +1090,33 @@ get_names(struct xkb_keymap *keymap, xcb_connection_t *conn,
                                         reply->which,
                                         &list);
 
-    if (!get_atom_name(conn, list.keycodesName, &keymap->keycodes_section_name) ||
-        !get_atom_name(conn, list.symbolsName, &keymap->symbols_section_name) ||
-        !get_atom_name(conn, list.typesName, &keymap->types_section_name) ||
-        !get_atom_name(conn, list.compatName, &keymap->compat_section_name) ||
-        !get_type_names(keymap, conn, reply, &list) ||
-        !get_indicator_names(keymap, conn, reply, &list) ||
-        !get_vmod_names(keymap, conn, reply, &list) ||
-        !get_group_names(keymap, conn, reply, &list) ||
-        !get_key_names(keymap, conn, reply, &list) ||
-        !get_aliases(keymap, conn, reply, &list))
+    if (reply->which & XCB_XKB_NAME_DETAIL_KEYCODES)
+        x11_atom_interner_get_escaped_atom_name(interner, list.keycodesName,
+                                                &keymap->keycodes_section_name);
+    if (reply->which & XCB_XKB_NAME_DETAIL_SYMBOLS)
+        x11_atom_interner_get_escaped_atom_name(interner, list.symbolsName,
+                                                &keymap->symbols_section_name);
+    if (reply->which & XCB_XKB_NAME_DETAIL_TYPES)
+        x11_atom_interner_get_escaped_atom_name(interner, list.typesName,
+                                                &keymap->types_section_name);
+    if (reply->which & XCB_XKB_NAME_DETAIL_COMPAT)
+        x11_atom_interner_get_escaped_atom_name(interner, list.compatName,
+                                                &keymap->compat_section_name);
+
+    if (((reply->which & XCB_XKB_NAME_DETAIL_KEY_TYPE_NAMES) &&
+         !get_type_names(keymap, interner, reply, &list)) ||
+        ((reply->which & XCB_XKB_NAME_DETAIL_INDICATOR_NAMES) &&
+         !get_indicator_names(keymap, interner, reply, &list)) ||
+        ((reply->which & XCB_XKB_NAME_DETAIL_VIRTUAL_MOD_NAMES) &&
+         !get_vmod_names(keymap, interner, reply, &list)) ||
+        ((reply->which & XCB_XKB_NAME_DETAIL_GROUP_NAMES) &&
+         !get_group_names(keymap, interner, reply, &list)) ||
+        ((reply->which & XCB_XKB_NAME_DETAIL_KEY_NAMES) &&
+         !get_key_names(keymap, interner, reply, &list)) ||
+        ((reply->which & XCB_XKB_NAME_DETAIL_KEY_ALIASES) &&
+         !get_aliases(keymap, interner, reply, &list)))
         goto fail;
 
-    XkbEscapeMapName(keymap->keycodes_section_name);
-    XkbEscapeMapName(keymap->symbols_section_name);
-    XkbEscapeMapName(keymap->types_section_name);
-    XkbEscapeMapName(keymap->compat_section_name);
-
     free(reply);
     return true;
 
@@ -1097,10 +1127,8 @@ fail:
 
 static bool
 get_controls(struct xkb_keymap *keymap, xcb_connection_t *conn,
-             uint16_t device_id)
+             xcb_xkb_get_controls_cookie_t cookie)
 {
-    xcb_xkb_get_controls_cookie_t cookie =
-        xcb_xkb_get_controls(conn, device_id);
     xcb_xkb_get_controls_reply_t *reply =
         xcb_xkb_get_controls_reply(conn, cookie, NULL);
 
@@ -1131,6 +1159,12 @@ xkb_x11_keymap_new_from_device(struct xkb_context *ctx,
 {
     struct xkb_keymap *keymap;
     const enum xkb_keymap_format format = XKB_KEYMAP_FORMAT_TEXT_V1;
+    struct x11_atom_interner interner;
+    xcb_xkb_get_map_cookie_t map_cookie;
+    xcb_xkb_get_indicator_map_cookie_t indicator_map_cookie;
+    xcb_xkb_get_compat_map_cookie_t compat_map_cookie;
+    xcb_xkb_get_names_cookie_t names_cookie;
+    xcb_xkb_get_controls_cookie_t controls_cookie;
 
     if (flags & ~(XKB_KEYMAP_COMPILE_NO_FLAGS)) {
         log_err_func(ctx, "unrecognized flags: %#x\n", flags);
@@ -1146,14 +1180,426 @@ xkb_x11_keymap_new_from_device(struct xkb_context *ctx,
     if (!keymap)
         return NULL;
 
-    if (!get_map(keymap, conn, device_id) ||
-        !get_indicator_map(keymap, conn, device_id) ||
-        !get_compat_map(keymap, conn, device_id) ||
-        !get_names(keymap, conn, device_id) ||
-        !get_controls(keymap, conn, device_id)) {
+    /*
+     * Send all of the requests before waiting for any of the replies, so
+     * that the whole keymap takes one round trip to the server, plus one
+     * for the atoms found in the replies, instead of one per request.
+     */
+    map_cookie = send_map_request(conn, device_id);
+    indicator_map_cookie =
+        xcb_xkb_get_indicator_map(conn, device_id, ALL_INDICATORS_MASK);
+    compat_map_cookie =
+        xcb_xkb_get_compat_map(conn, device_id, 0, true, 0, 0);
+    names_cookie = xcb_xkb_get_names(conn, device_id, get_names_wanted);
+    controls_cookie = xcb_xkb_get_controls(conn, device_id);
+
+    x11_atom_interner_init(&interner, ctx, conn);
+
+    if (!get_map(keymap, conn, map_cookie))
+        goto err_map;
+    if (!get_indicator_map(keymap, conn, indicator_map_cookie))
+        goto err_indicator_map;
+    if (!get_compat_map(keymap, conn, compat_map_cookie))
+        goto err_compat_map;
+    if (!get_names(keymap, &interner, names_cookie, get_names_required))
+        goto err_names;
+    if (!get_controls(keymap, conn, controls_cookie))
+        goto err_controls;
+    if (!x11_atom_interner_round_trip(&interner))
+        goto err_keymap;
+
+    return keymap;
+
+    /* Don't leave the replies which were not collected waiting. */
+err_map:
+    xcb_discard_reply(conn, indicator_map_cookie.sequence);
+err_indicator_map:
+    xcb_discard_reply(conn, compat_map_cookie.sequence);
+err_compat_map:
+    xcb_discard_reply(conn, names_cookie.sequence);
+err_names:
+    xcb_discard_reply(conn, controls_cookie.sequence);
+err_controls:
+    interner.had_error = true;
+    x11_atom_interner_round_trip(&interner);
+err_keymap:
+    xkb_keymap_unref(keymap);
+    return NULL;
+}
+
+/*
+ * Updating a keymap from XkbMapNotify and XkbNamesNotify events.
+ *
+ * The updated keymap is a copy of the old one, except for what the event
+ * says has changed, which is requested again. The key types, the
+ * interprets and the levels of the unchanged keys are not copied, but
+ * borrowed from the keymap which was fetched in full (keymap->base).
+ */
+
+static struct xkb_level *
+copy_levels(const struct xkb_level *from, xkb_level_index_t num_levels)
+{
+    struct xkb_level *levels = memdup(from, num_levels, sizeof(*levels));
+
+    if (!levels)
+        return NULL;
+
+    for (xkb_level_index_t i = 0; i < num_levels; i++) {
+        if (levels[i].num_syms <= 1)
+            continue;
+
+        levels[i].u.syms = memdup(from[i].u.syms, from[i].num_syms,
+                                  sizeof(*from[i].u.syms));
+        if (!levels[i].u.syms) {
+            while (i-- > 0)
+                if (levels[i].num_syms > 1)
+                    free(levels[i].u.syms);
+            free(levels);
+            return NULL;
+        }
+    }
+
+    return levels;
+}
+
+/*
+ * Copy a keymap, sharing what can be shared. The keys in the range
+ * [first, last] are left empty, to be fetched again.
+ */
+static struct xkb_keymap *
+derive_keymap(struct xkb_keymap *old, xkb_keycode_t first, xkb_keycode_t last)
+{
+    struct xkb_keymap *base = old->base ? old->base : old;
+    struct xkb_keymap *keymap;
+
+    keymap = xkb_keymap_new(old->ctx, old->format, old->flags);
+    if (!keymap)
+        return NULL;
+
+    keymap->base = xkb_keymap_ref(base);
+    keymap->types = base->types;
+    keymap->num_types = base->num_types;
+    keymap->sym_interprets = base->sym_interprets;
+    keymap->num_sym_interprets = base->num_sym_interprets;
+
+    keymap->enabled_ctrls = old->enabled_ctrls;
+    keymap->mods = old->mods;
+    keymap->num_groups = old->num_groups;
+    memcpy(keymap->leds, old->leds, sizeof(keymap->leds));
+    keymap->num_leds = old->num_leds;
+
+    keymap->keycodes_section_name = strdup_safe(old->keycodes_section_name);
+    keymap->symbols_section_name = strdup_safe(old->symbols_section_name);
+    keymap->types_section_name = strdup_safe(old->types_section_name);
+    keymap->compat_section_name = strdup_safe(old->compat_section_name);
+
+    if (old->num_key_aliases > 0) {
+        keymap->key_aliases = memdup(old->key_aliases, old->num_key_aliases,
+                                     sizeof(*old->key_aliases));
+        if (!keymap->key_aliases)
+            goto fail;
+        keymap->num_key_aliases = old->num_key_aliases;
+    }
+
+    if (old->num_group_names > 0) {
+        keymap->group_names = memdup(old->group_names, old->num_group_names,
+                                     sizeof(*old->group_names));
+        if (!keymap->group_names)
+            goto fail;
+        keymap->num_group_names = old->num_group_names;
+    }
+
+    keymap->min_key_code = old->min_key_code;
+    keymap->max_key_code = old->max_key_code;
+    ALLOC_OR_FAIL(keymap->keys, keymap->max_key_code + 1);
+
+    for (xkb_keycode_t kc = keymap->min_key_code; kc <= keymap->max_key_code; kc++) {
+        const struct xkb_key *from = &old->keys[kc];
+        struct xkb_key *key = &keymap->keys[kc];
+
+        if (kc >= first && kc <= last) {
+            key->keycode = kc;
+            key->name = from->name;
+            key->repeats = from->repeats;
+            continue;
+        }
+
+        *key = *from;
+        key->groups = NULL;
+        if (from->num_groups == 0)
+            continue;
+
+        key->groups = memdup(from->groups, from->num_groups,
+                             sizeof(*from->groups));
+        if (!key->groups)
+            goto fail;
+
+        /*
+         * The base's levels are borrowed. Those of a keymap which was
+         * itself updated are copied, so that it needn't be kept around.
+         */
+        for (xkb_layout_index_t i = 0; i < key->num_groups; i++)
+            key->groups[i].shared_levels = true;
+
+        if (old == base)
+            continue;
+
+        for (xkb_layout_index_t i = 0; i < key->num_groups; i++) {
+            struct xkb_group *group = &key->groups[i];
+
+            if (from->groups[i].shared_levels)
+                continue;
+
+            group->levels = copy_levels(from->groups[i].levels,
+                                        group->type->num_levels);
+            if (!group->levels)
+                goto fail;
+            group->shared_levels = false;
+        }
+    }
+
+    return keymap;
+
+fail:
+    xkb_keymap_unref(keymap);
+    return NULL;
+}
+
+static const xcb_xkb_map_part_t get_map_key_components =
+    (XCB_XKB_MAP_PART_KEY_SYMS |
+     XCB_XKB_MAP_PART_MODIFIER_MAP |
+     XCB_XKB_MAP_PART_EXPLICIT_COMPONENTS |
+     XCB_XKB_MAP_PART_KEY_ACTIONS |
+     XCB_XKB_MAP_PART_VIRTUAL_MOD_MAP);
+
+/* Get the keys of a GetMap request for the key range of a derive_keymap(). */
+static bool
+get_map_keys(struct xkb_keymap *keymap, xcb_connection_t *conn,
+             xcb_xkb_get_map_cookie_t cookie,
+             xkb_keycode_t first, xkb_keycode_t last)
+{
+    xcb_xkb_get_map_reply_t *reply = xcb_xkb_get_map_reply(conn, cookie, NULL);
+    xcb_xkb_get_map_map_t map;
+
+    FAIL_IF_BAD_REPLY(reply, "XkbGetMap");
+
+    FAIL_UNLESS((reply->present & get_map_key_components) ==
+                get_map_key_components);
+    FAIL_UNLESS(reply->firstKeySym == first);
+    FAIL_UNLESS(reply->firstKeySym + reply->nKeySyms == last + 1);
+
+    xcb_xkb_get_map_map_unpack(xcb_xkb_get_map_map(reply),
+                               reply->nTypes,
+                               reply->nKeySyms,
+                               reply->nKeyActions,
+                               reply->totalActions,
+                               reply->totalKeyBehaviors,
+                               reply->virtualMods,
+                               reply->totalKeyExplicit,
+                               reply->totalModMapKeys,
+                               reply->totalVModMapKeys,
+                               reply->present,
+                               &map);
+
+    if (!get_sym_maps(keymap, conn, reply, &map) ||
+        !get_actions(keymap, conn, reply, &map) ||
+        !get_explicits(keymap, conn, reply, &map) ||
+        !get_modmaps(keymap, conn, reply, &map) ||
+        !get_vmodmaps(keymap, conn, reply, &map))
+        goto fail;
+
+    free(reply);
+    return true;
+
+fail:
+    free(reply);
+    return false;
+}
+
+static void
+add_key_range(xkb_keycode_t *first, xkb_keycode_t *last,
+              bool changed, xkb_keycode_t range_first, uint8_t range_count)
+{
+    if (!changed || range_count == 0)
+        return;
+
+    *first = MIN(*first, range_first);
+    *last = MAX(*last, range_first + range_count - 1);
+}
+
+/*
+ * Returns NULL if the changes can't be applied by themselves, and the
+ * whole keymap should be fetched again.
+ */
+static struct xkb_keymap *
+update_from_map_notify(struct xkb_keymap *old, xcb_connection_t *conn,
+                       const xcb_xkb_map_notify_event_t *event)
+{
+    xkb_keycode_t first = XKB_KEYCODE_MAX, last = 0;
+    struct xkb_keymap *keymap;
+    xcb_xkb_get_map_cookie_t cookie;
+    uint8_t count;
+
+    /* We don't use the key behaviors. */
+    if (event->changed & ~(get_map_key_components |
+                           XCB_XKB_MAP_PART_KEY_BEHAVIORS))
+        return NULL;
+
+    if (event->minKeyCode != old->min_key_code ||
+        event->maxKeyCode != old->max_key_code)
+        return NULL;
+
+    add_key_range(&first, &last,
+                  event->changed & XCB_XKB_MAP_PART_KEY_SYMS,
+                  event->firstKeySym, event->nKeySyms);
+    add_key_range(&first, &last,
+                  event->changed & XCB_XKB_MAP_PART_KEY_ACTIONS,
+                  event->firstKeyAct, event->nKeyActs);
+    add_key_range(&first, &last,
+                  event->changed & XCB_XKB_MAP_PART_EXPLICIT_COMPONENTS,
+                  event->firstKeyExplicit, event->nKeyExplicit);
+    add_key_range(&first, &last,
+                  event->changed & XCB_XKB_MAP_PART_MODIFIER_MAP,
+                  event->firstModMapKey, event->nModMapKeys);
+    add_key_range(&first, &last,
+                  event->changed & XCB_XKB_MAP_PART_VIRTUAL_MOD_MAP,
+                  event->firstVModMapKey, event->nVModMapKeys);
+
+    if (first > last)
+        return xkb_keymap_ref(old);
+
+    if (first < old->min_key_code || last > old->max_key_code)
+        return NULL;
+
+    keymap = derive_keymap(old, first, last);
+    if (!keymap)
+        return NULL;
+
+    /* A key's syms, actions etc. all go together, so get them all. */
+    count = last - first + 1;
+    cookie = xcb_xkb_get_map(conn, event->deviceID, 0, get_map_key_components,
+                             0, 0, first, count, first, count, 0, 0, 0,
+                             first, count, first, count, first, count);
+
+    if (!get_map_keys(keymap, conn, cookie, first, last)) {
         xkb_keymap_unref(keymap);
         return NULL;
     }
 
     return keymap;
 }
+
+static struct xkb_keymap *
+update_from_names_notify(struct xkb_keymap *old, xcb_connection_t *conn,
+                         const xcb_xkb_names_notify_event_t *event)
+{
+    /*
+     * The names of the types are in the borrowed types, and those of the
+     * virtual modifiers go with their definitions, so changing them takes
+     * a full fetch. The rest of the names aren't used.
+     */
+    static const xcb_xkb_name_detail_t updatable =
+        (XCB_XKB_NAME_DETAIL_KEYCODES |
+         XCB_XKB_NAME_DETAIL_SYMBOLS |
+         XCB_XKB_NAME_DETAIL_TYPES |
+         XCB_XKB_NAME_DETAIL_COMPAT |
+         XCB_XKB_NAME_DETAIL_INDICATOR_NAMES |
+         XCB_XKB_NAME_DETAIL_KEY_NAMES |
+         XCB_XKB_NAME_DETAIL_KEY_ALIASES |
+         XCB_XKB_NAME_DETAIL_GROUP_NAMES);
+    const uint16_t which = event->changed & get_names_wanted;
+    struct xkb_keymap *keymap;
+    struct x11_atom_interner interner;
+    xcb_xkb_get_names_cookie_t cookie;
+
+    if (which & ~updatable)
+        return NULL;
+
+    if (which == 0)
+        return xkb_keymap_ref(old);
+
+    keymap = derive_keymap(old, XKB_KEYCODE_MAX, 0);
+    if (!keymap)
+        return NULL;
+
+    /* Clear what is about to be replaced. */
+    if (which & XCB_XKB_NAME_DETAIL_KEYCODES) {
+        free(keymap->keycodes_section_name);
+        keymap->keycodes_section_name = NULL;
+    }
+    if (which & XCB_XKB_NAME_DETAIL_SYMBOLS) {
+        free(keymap->symbols_section_name);
+        keymap->symbols_section_name = NULL;
+    }
+    if (which & XCB_XKB_NAME_DETAIL_TYPES) {
+        free(keymap->types_section_name);
+        keymap->types_section_name = NULL;
+    }
+    if (which & XCB_XKB_NAME_DETAIL_COMPAT) {
+        free(keymap->compat_section_name);
+        keymap->compat_section_name = NULL;
+    }
+    if (which & XCB_XKB_NAME_DETAIL_INDICATOR_NAMES) {
+        for (unsigned i = 0; i < NUM_INDICATORS; i++)
+            keymap->leds[i].name = XKB_ATOM_NONE;
+    }
+    if (which & XCB_XKB_NAME_DETAIL_KEY_ALIASES) {
+        free(keymap->key_aliases);
+        keymap->key_aliases = NULL;
+        keymap->num_key_aliases = 0;
+    }
+    if (which & XCB_XKB_NAME_DETAIL_GROUP_NAMES) {
+        free(keymap->group_names);
+        keymap->group_names = NULL;
+        keymap->num_group_names = 0;
+    }
+
+    cookie = xcb_xkb_get_names(conn, event->deviceID, which);
+
+    x11_atom_interner_init(&interner, keymap->ctx, conn);
+
+    if (!get_names(keymap, &interner, cookie, which)) {
+        interner.had_error = true;
+        x11_atom_interner_round_trip(&interner);
+        xkb_keymap_unref(keymap);
+        return NULL;
+    }
+
+    if (!x11_atom_interner_round_trip(&interner)) {
+        xkb_keymap_unref(keymap);
+        return NULL;
+    }
+
+    return keymap;
+}
+
+XKB_EXPORT struct xkb_keymap *
+xkb_x11_keymap_new_from_event(struct xkb_keymap *keymap,
+                              xcb_connection_t *conn,
+                              const xcb_generic_event_t *event)
+{
+    /* All XKB events start alike. */
+    const xcb_xkb_map_notify_event_t *any =
+        (const xcb_xkb_map_notify_event_t *) event;
+    struct xkb_keymap *updated;
+
+    switch (any->xkbType) {
+    case XCB_XKB_MAP_NOTIFY:
+        updated = update_from_map_notify(keymap, conn, any);
+        break;
+    case XCB_XKB_NAMES_NOTIFY:
+        updated = update_from_names_notify(keymap, conn,
+            (const xcb_xkb_names_notify_event_t *) event);
+        break;
+    default:
+        log_err_func(keymap->ctx, "unsupported XKB event type: %d\n",
+                     any->xkbType);
+        return NULL;
+    }
+
+    if (updated)
+        return updated;
+
+    return xkb_x11_keymap_new_from_device(keymap->ctx, conn, any->deviceID,
+                                          keymap->flags);
+}
@@ -122,94 +122,260 @@ xkb_x11_get_core_keyboard_device_id(xcb_connection_t *conn)
     return device_id;
 }
 
-bool
-get_atom_name(xcb_connection_t *conn, xcb_atom_t atom, char **out)
+/*
+ * The names of the X atoms seen so far, so that fetching a keymap again
+ * only asks for the new ones. X atoms never change while the connection
+ * is open, but mean nothing on another connection, so only the last
+ * connection's are kept. The entries are never removed, since most
+ * keymaps use the same few names; when the cache is full, new names just
+ * aren't added.
+ *
+ * A later connection may get the address of a closed one, so connections
+ * are also told apart by their resource ID base, which differs between
+ * the clients of a server; xkb_x11_context_forget_connection() covers
+ * the rest, e.g. a server which was reset.
+ */
+struct x11_atom_cache {
+    xcb_connection_t *conn;
+    uint32_t resource_id_base;
+    size_t len;
+    struct {
+        xcb_atom_t from;
+        xkb_atom_t to;
+    } cache[256];
+};
+
+/* Must be called with the context locked. */
+static struct x11_atom_cache *
+get_atom_cache(struct xkb_context *ctx, xcb_connection_t *conn)
 {
-    xcb_get_atom_name_cookie_t cookie;
-    xcb_get_atom_name_reply_t *reply;
-    int length;
-    char *name;
-
-    if (atom == 0) {
-        *out = NULL;
-        return true;
+    struct x11_atom_cache *cache = ctx->x11_atom_cache;
+    const xcb_setup_t *setup = xcb_get_setup(conn);
+
+    if (!setup)
+        return NULL;
+
+    if (!cache) {
+        cache = calloc(1, sizeof(*cache));
+        if (!cache)
+            return NULL;
+        ctx->x11_atom_cache = cache;
     }
 
-    cookie = xcb_get_atom_name(conn, atom);
-    reply = xcb_get_atom_name_reply(conn, cookie, NULL);
-    if (!reply)
-        return false;
+    if (cache->conn != conn ||
+        cache->resource_id_base != setup->resource_id_base) {
+        cache->conn = conn;
+        cache->resource_id_base = setup->resource_id_base;
+        cache->len = 0;
+    }
 
-    length = xcb_get_atom_name_name_length(reply);
-    name = xcb_get_atom_name_name(reply);
+    return cache;
+}
 
-    *out = strndup(name, length);
-    if (!*out) {
-        free(reply);
-        return false;
+XKB_EXPORT void
+xkb_x11_context_forget_connection(struct xkb_context *ctx,
+                                  xcb_connection_t *conn)
+{
+    struct x11_atom_cache *cache;
+
+    xkb_context_lock(ctx);
+
+    cache = ctx->x11_atom_cache;
+    if (cache && cache->conn == conn) {
+        cache->conn = NULL;
+        cache->len = 0;
     }
 
-    free(reply);
-    return true;
+    xkb_context_unlock(ctx);
 }
 
-bool
-adopt_atoms(struct xkb_context *ctx, xcb_connection_t *conn,
-            const xcb_atom_t *from, xkb_atom_t *to, const size_t count)
+static xkb_atom_t
+atom_cache_lookup(struct x11_atom_interner *interner, xcb_atom_t atom)
 {
-    enum { SIZE = 128 };
-    xcb_get_atom_name_cookie_t cookies[SIZE];
-
-    /* Send and collect the atoms in batches of reasonable SIZE. */
-    for (size_t batch = 0; batch <= count / SIZE; batch++) {
-        const size_t start = batch * SIZE;
-        const size_t stop = min((batch + 1) * SIZE, count);
-
-        /* Send. */
-        for (size_t i = start; i < stop; i++)
-            if (from[i] != XCB_ATOM_NONE)
-                cookies[i % SIZE] = xcb_get_atom_name(conn, from[i]);
-
-        /* Collect. */
-        for (size_t i = start; i < stop; i++) {
-            xcb_get_atom_name_reply_t *reply;
-
-            if (from[i] == XCB_ATOM_NONE) {
-                to[i] = XKB_ATOM_NONE;
-                continue;
+    struct x11_atom_cache *cache;
+    xkb_atom_t name = XKB_ATOM_NONE;
+
+    xkb_context_lock(interner->ctx);
+
+    cache = get_atom_cache(interner->ctx, interner->conn);
+    if (cache) {
+        for (size_t i = 0; i < cache->len; i++) {
+            if (cache->cache[i].from == atom) {
+                name = cache->cache[i].to;
+                break;
             }
+        }
+    }
 
-            reply = xcb_get_atom_name_reply(conn, cookies[i % SIZE], NULL);
-            if (!reply)
-                goto err_discard;
+    xkb_context_unlock(interner->ctx);
+    return name;
+}
 
-            to[i] = xkb_atom_intern(ctx,
-                                    xcb_get_atom_name_name(reply),
-                                    xcb_get_atom_name_name_length(reply));
-            free(reply);
+static void
+atom_cache_insert(struct x11_atom_interner *interner,
+                  xcb_atom_t atom, xkb_atom_t name)
+{
+    struct x11_atom_cache *cache;
 
-            if (to[i] == XKB_ATOM_NONE)
-                goto err_discard;
+    xkb_context_lock(interner->ctx);
 
-            continue;
+    cache = get_atom_cache(interner->ctx, interner->conn);
+    if (!cache)
+        goto out;
+
+    for (size_t i = 0; i < cache->len; i++)
+        if (cache->cache[i].from == atom)
+            goto out;
+
+    if (cache->len < ARRAY_SIZE(cache->cache)) {
+        cache->cache[cache->len].from = atom;
+        cache->cache[cache->len].to = name;
+        cache->len++;
+    }
+
+out:
+    xkb_context_unlock(interner->ctx);
+}
+
+static char *
+escaped_atom_text(struct xkb_context *ctx, xkb_atom_t name)
+{
+    char *text = strdup(xkb_atom_text(ctx, name));
+
+    if (text)
+        XkbEscapeMapName(text);
+    return text;
+}
+
+void
+x11_atom_interner_init(struct x11_atom_interner *interner,
+                       struct xkb_context *ctx, xcb_connection_t *conn)
+{
+    interner->ctx = ctx;
+    interner->conn = conn;
+    interner->had_error = false;
+    darray_init(interner->pending);
+}
+
+void
+x11_atom_interner_adopt_atom(struct x11_atom_interner *interner,
+                             xcb_atom_t atom, xkb_atom_t *out)
+{
+    struct x11_pending_atom pending = { atom, { 0 }, out, NULL, 0 };
+    size_t i;
+
+    *out = XKB_ATOM_NONE;
 
-            /*
-             * If we don't discard the uncollected replies, they just
-             * sit there waiting. Sad.
-             */
-err_discard:
-            for (size_t j = i + 1; j < stop; j++)
-                xcb_discard_reply(conn, cookies[j].sequence);
-            return false;
+    if (atom == XCB_ATOM_NONE || interner->had_error)
+        return;
+
+    *out = atom_cache_lookup(interner, atom);
+    if (*out != XKB_ATOM_NONE)
+        return;
+
+    /* Level names and such repeat a lot; only ask for each one once. */
+    for (i = 0; i < darray_size(interner->pending); i++) {
+        const struct x11_pending_atom *other =
+            &darray_item(interner->pending, i);
+
+        if (other->from == atom && other->out && !other->same_as) {
+            pending.same_as = i + 1;
+            break;
         }
     }
 
-    return true;
+    if (!pending.same_as)
+        pending.cookie = xcb_get_atom_name(interner->conn, atom);
+
+    darray_append(interner->pending, pending);
+}
+
+void
+x11_atom_interner_adopt_atoms(struct x11_atom_interner *interner,
+                              const xcb_atom_t *from, xkb_atom_t *to,
+                              size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        x11_atom_interner_adopt_atom(interner, from[i], &to[i]);
+}
+
+void
+x11_atom_interner_get_escaped_atom_name(struct x11_atom_interner *interner,
+                                        xcb_atom_t atom, char **out)
+{
+    struct x11_pending_atom pending = { atom, { 0 }, NULL, out, 0 };
+    xkb_atom_t name;
+
+    *out = NULL;
+
+    if (atom == XCB_ATOM_NONE || interner->had_error)
+        return;
+
+    name = atom_cache_lookup(interner, atom);
+    if (name != XKB_ATOM_NONE) {
+        *out = escaped_atom_text(interner->ctx, name);
+        if (!*out)
+            interner->had_error = true;
+        return;
+    }
+
+    pending.cookie = xcb_get_atom_name(interner->conn, atom);
+    darray_append(interner->pending, pending);
 }
 
 bool
-adopt_atom(struct xkb_context *ctx, xcb_connection_t *conn, xcb_atom_t atom,
-           xkb_atom_t *out)
+x11_atom_interner_round_trip(struct x11_atom_interner *interner)
 {
-    return adopt_atoms(ctx, conn, &atom, out, 1);
+    struct x11_pending_atom *pending;
+
+    darray_foreach(pending, interner->pending) {
+        xcb_get_atom_name_reply_t *reply;
+        xkb_atom_t name;
+
+        if (pending->same_as) {
+            if (!interner->had_error)
+                *pending->out =
+                    *darray_item(interner->pending, pending->same_as - 1).out;
+            continue;
+        }
+
+        /*
+         * If we don't discard the uncollected replies, they just
+         * sit there waiting. Sad.
+         */
+        if (interner->had_error) {
+            xcb_discard_reply(interner->conn, pending->cookie.sequence);
+            continue;
+        }
+
+        reply = xcb_get_atom_name_reply(interner->conn, pending->cookie, NULL);
+        if (!reply) {
+            interner->had_error = true;
+            continue;
+        }
+
+        name = xkb_atom_intern(interner->ctx,
+                               xcb_get_atom_name_name(reply),
+                               xcb_get_atom_name_name_length(reply));
+        free(reply);
+
+        if (name == XKB_ATOM_NONE) {
+            interner->had_error = true;
+            continue;
+        }
+
+        atom_cache_insert(interner, pending->from, name);
+
+        if (pending->out) {
+            *pending->out = name;
+        }
+        else {
+            *pending->escaped_out = escaped_atom_text(interner->ctx, name);
+            if (!*pending->escaped_out)
+                interner->had_error = true;
+        }
+    }
+
+    darray_free(interner->pending);
+    return !interner->had_error;
 }
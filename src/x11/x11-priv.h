@@ -27,28 +27,62 @@
 #include <xcb/xkb.h>
 
 #include "keymap.h"
+#include "darray.h"
 #include "xkbcommon/xkbcommon-x11.h"
 
-/* Get a strdup'd name of an X atom. */
-bool
-get_atom_name(xcb_connection_t *conn, xcb_atom_t atom, char **out);
+struct x11_pending_atom {
+    xcb_atom_t from;
+    xcb_get_atom_name_cookie_t cookie;
+    /* Where to put the result; only one is set. */
+    xkb_atom_t *out;
+    char **escaped_out;
+    /* If not 0, the index + 1 of an earlier request for the same atom. */
+    size_t same_as;
+};
 
 /*
- * Make a xkb_atom_t's from X atoms (prefer to send as many as possible
- * at once, to avoid many roundtrips).
+ * Resolves X atoms, which are found in the replies of the XKB requests,
+ * into xkb_atom_t's or strings. The GetAtomName requests are sent as
+ * the atoms are found, but the replies are only collected, all at once,
+ * by x11_atom_interner_round_trip(). This way resolving any number of
+ * atoms costs one round trip, which overlaps with the other requests in
+ * flight. Atoms seen before on the same connection are taken from a
+ * cache in the context, and not requested at all.
  *
- * TODO: We can make this more flexible, such that @to doesn't have to
- *       be sequential. Then we can convert most adopt_atom() calls to
- *       adopt_atoms().
- *       Atom caching would also likely be useful for avoiding quite a
- *       few requests.
+ * The results are not available until after the round trip, so the
+ * output pointers must remain valid until then.
  */
-bool
-adopt_atoms(struct xkb_context *ctx, xcb_connection_t *conn,
-            const xcb_atom_t *from, xkb_atom_t *to, size_t count);
+struct x11_atom_interner {
+    struct xkb_context *ctx;
+    xcb_connection_t *conn;
+    bool had_error;
+    darray(struct x11_pending_atom) pending;
+};
+
+void
+x11_atom_interner_init(struct x11_atom_interner *interner,
+                       struct xkb_context *ctx, xcb_connection_t *conn);
+
+void
+x11_atom_interner_adopt_atom(struct x11_atom_interner *interner,
+                             xcb_atom_t atom, xkb_atom_t *out);
 
+void
+x11_atom_interner_adopt_atoms(struct x11_atom_interner *interner,
+                              const xcb_atom_t *from, xkb_atom_t *to,
+                              size_t count);
+
+/* Get a strdup'd name of an X atom, escaped by XkbEscapeMapName(). */
+void
+x11_atom_interner_get_escaped_atom_name(struct x11_atom_interner *interner,
+                                        xcb_atom_t atom, char **out);
+
+/*
+ * Collect the replies and fill in the results. If had_error is set, or
+ * any request fails, the rest of the replies are discarded and false is
+ * returned. Either way, the interner is done afterwards.
+ */
 bool
-adopt_atom(struct xkb_context *ctx, xcb_connection_t *conn, xcb_atom_t atom,
-           xkb_atom_t *out);
+x11_atom_interner_round_trip(struct x11_atom_interner *interner);
 
 #endif
@@ -93,6 +93,7 @@ typedef struct {
     struct xkb_mod_set mods;
 
     struct xkb_context *ctx;
+    darray_included_file *included_files;
 } CompatInfo;
 
 static const char *
@@ -144,10 +145,12 @@ ReportLedNotArray(CompatInfo *info, LedInfo *ledi, const char *field)
 
 static void
 InitCompatInfo(CompatInfo *info, struct xkb_context *ctx,
+               darray_included_file *included_files,
                ActionsInfo *actions, const struct xkb_mod_set *mods)
 {
     memset(info, 0, sizeof(*info));
     info->ctx = ctx;
+    info->included_files = included_files;
     info->actions = actions;
     info->mods = *mods;
     info->default_interp.merge = MERGE_OVERRIDE;
@@ -426,22 +429,24 @@ HandleIncludeCompatMap(CompatInfo *info, IncludeStmt *include)
 {
     CompatInfo included;
 
-    InitCompatInfo(&included, info->ctx, info->actions, &info->mods);
-    included.name = include->stmt;
-    include->stmt = NULL;
+    InitCompatInfo(&included, info->ctx, info->included_files,
+                   info->actions, &info->mods);
+    included.name = strdup_safe(include->stmt);
 
     for (IncludeStmt *stmt = include; stmt; stmt = stmt->next_incl) {
         CompatInfo next_incl;
         XkbFile *file;
 
-        file = ProcessIncludeFile(info->ctx, stmt, FILE_TYPE_COMPAT);
+        file = ProcessIncludeFile(info->ctx, info->included_files, stmt,
+                                  FILE_TYPE_COMPAT);
         if (!file) {
             info->errorCount += 10;
             ClearCompatInfo(&included);
             return false;
         }
 
-        InitCompatInfo(&next_incl, info->ctx, info->actions, &included.mods);
+        InitCompatInfo(&next_incl, info->ctx, info->included_files,
+                       info->actions, &included.mods);
         next_incl.default_interp = info->default_interp;
         next_incl.default_interp.merge = stmt->merge;
         next_incl.default_led = info->default_led;
@@ -452,7 +457,7 @@ HandleIncludeCompatMap(CompatInfo *info, IncludeStmt *include)
         MergeIncludedCompatMaps(&included, &next_incl, stmt->merge);
 
         ClearCompatInfo(&next_incl);
-        FreeXkbFile(file);
+        ReleaseIncludeFile(info->included_files, file);
     }
 
     MergeIncludedCompatMaps(info, &included, include->merge);
@@ -901,7 +906,7 @@ CopyCompatToKeymap(struct xkb_keymap *keymap, CompatInfo *info)
 
 bool
 CompileCompatMap(XkbFile *file, struct xkb_keymap *keymap,
-                 enum merge_mode merge)
+                 enum merge_mode merge, darray_included_file *included_files)
 {
     CompatInfo info;
     ActionsInfo *actions;
@@ -910,7 +915,8 @@ CompileCompatMap(XkbFile *file, struct xkb_keymap *keymap,
     if (!actions)
         return false;
 
-    InitCompatInfo(&info, keymap->ctx, actions, &keymap->mods);
+    InitCompatInfo(&info, keymap->ctx, included_files, actions,
+                   &keymap->mods);
     info.default_interp.merge = merge;
     info.default_led.merge = merge;
 
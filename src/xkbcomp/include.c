@@ -47,12 +47,15 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <dirent.h>
 #include <errno.h>
 #include <limits.h>
 #include <stdio.h>
+#include <sys/stat.h>
 
 #include "xkbcomp-priv.h"
 #include "include.h"
+#include "archive.h"
 
 /**
  * Parse an include statement. Each call returns a file name, along with
@@ -193,15 +196,192 @@ DirectoryForInclude(enum xkb_file_type type)
     return xkb_file_type_include_dirs[type];
 }
 
-FILE *
-FindFileInXkbPath(struct xkb_context *ctx, const char *name,
-                  enum xkb_file_type type, char **pathRtrn)
+/*
+ * An index of the files in an include directory, i.e. <include path>/<type
+ * dir>, so that looking up an include doesn't need to try to open it in
+ * every include path. It is built lazily, and revalidated by the directory
+ * mtime at most once per compilation (see
+ * xkb_context_invalidate_include_dirs()).
+ */
+struct include_dir {
+    char *path;
+    /* The ctx->include_generation it was last validated in. */
+    unsigned int generation;
+    bool built;
+    struct timespec mtime;
+    /* Sorted. */
+    darray(char *) files;
+};
+
+static void
+include_dir_clear_files(struct include_dir *dir)
+{
+    char **file;
+
+    darray_foreach(file, dir->files)
+        free(*file);
+    darray_free(dir->files);
+}
+
+void
+xkb_context_clear_include_dirs(struct xkb_context *ctx)
+{
+    struct include_dir **dir;
+
+    darray_foreach(dir, ctx->include_dirs) {
+        if (!*dir)
+            continue;
+        include_dir_clear_files(*dir);
+        free((*dir)->path);
+        free(*dir);
+    }
+    darray_free(ctx->include_dirs);
+}
+
+void
+xkb_context_invalidate_include_dirs(struct xkb_context *ctx)
+{
+    xkb_context_lock(ctx);
+    ctx->include_generation++;
+    xkb_context_unlock(ctx);
+}
+
+static int
+cmp_file_names(const void *a, const void *b)
+{
+    return strcmp(*(char *const *) a, *(char *const *) b);
+}
+
+static void
+include_dir_build(struct xkb_context *ctx, struct include_dir *dir)
+{
+    struct stat stat_buf;
+    DIR *d;
+    struct dirent *ent;
+
+    if (stat(dir->path, &stat_buf) != 0) {
+        /* Doesn't exist (yet); the index is empty. */
+        include_dir_clear_files(dir);
+        dir->built = true;
+        memset(&dir->mtime, 0, sizeof(dir->mtime));
+        return;
+    }
+
+    if (dir->built &&
+        stat_buf.st_mtim.tv_sec == dir->mtime.tv_sec &&
+        stat_buf.st_mtim.tv_nsec == dir->mtime.tv_nsec)
+        return;
+
+    include_dir_clear_files(dir);
+    dir->built = false;
+
+    d = opendir(dir->path);
+    if (!d)
+        return;
+
+    while ((ent = readdir(d))) {
+        char *name;
+
+        if (streq(ent->d_name, ".") || streq(ent->d_name, ".."))
+            continue;
+
+        name = strdup(ent->d_name);
+        if (!name) {
+            log_err(ctx, "Couldn't index directory %s\n", dir->path);
+            include_dir_clear_files(dir);
+            closedir(d);
+            return;
+        }
+        darray_append(dir->files, name);
+    }
+
+    closedir(d);
+
+    if (!darray_empty(dir->files))
+        qsort(darray_mem(dir->files, 0), darray_size(dir->files),
+              sizeof(char *), cmp_file_names);
+
+    dir->mtime = stat_buf.st_mtim;
+    dir->built = true;
+}
+
+/*
+ * Get the index of @typeDir in the include path @idx, or NULL if it can't
+ * be used, in which case the caller should just try to open the file.
+ */
+static struct include_dir *
+get_include_dir(struct xkb_context *ctx, unsigned int idx,
+                enum xkb_file_type type, const char *typeDir)
+{
+    size_t pos = idx * _FILE_TYPE_NUM_ENTRIES + type;
+    struct include_dir *dir;
+
+    if (type >= _FILE_TYPE_NUM_ENTRIES)
+        return NULL;
+
+    if (pos >= darray_size(ctx->include_dirs))
+        darray_resize0(ctx->include_dirs, pos + 1);
+
+    dir = darray_item(ctx->include_dirs, pos);
+    if (!dir) {
+        dir = calloc(1, sizeof(*dir));
+        if (!dir)
+            return NULL;
+
+        if (asprintf(&dir->path, "%s/%s",
+                     xkb_context_include_path_get(ctx, idx), typeDir) < 0) {
+            free(dir);
+            return NULL;
+        }
+
+        darray_item(ctx->include_dirs, pos) = dir;
+        include_dir_build(ctx, dir);
+        dir->generation = ctx->include_generation;
+    }
+    else if (dir->generation != ctx->include_generation) {
+        include_dir_build(ctx, dir);
+        dir->generation = ctx->include_generation;
+    }
+
+    return dir->built ? dir : NULL;
+}
+
+static bool
+include_dir_has_file(struct include_dir *dir, const char *name)
+{
+    if (darray_empty(dir->files))
+        return false;
+
+    return bsearch(&name, darray_mem(dir->files, 0), darray_size(dir->files),
+                   sizeof(char *), cmp_file_names) != NULL;
+}
+
+bool
+GetProvidedFile(struct xkb_context *ctx, const char *name,
+                enum xkb_file_type type, const char **string_out,
+                size_t *len_out)
+{
+    if (!ctx->include_fn || type >= _FILE_TYPE_NUM_ENTRIES)
+        return false;
+
+    return ctx->include_fn(ctx, DirectoryForInclude(type), name,
+                           string_out, len_out) != 0;
+}
+
+static bool
+find_file_in_xkb_path(struct xkb_context *ctx, const char *name,
+                      enum xkb_file_type type, char **pathRtrn,
+                      struct xkb_file_source *src)
 {
     unsigned int i;
     FILE *file = NULL;
+    const struct xkb_archive *archive = NULL;
+    bool found = false;
     char *buf = NULL;
     const char *typeDir;
     size_t buf_size = 0, typeDirLen, name_len;
+    /* Only files directly in the type dir are indexed. */
+    bool use_index = (strchr(name, '/') == NULL);
 
     typeDir = DirectoryForInclude(type);
     typeDirLen = strlen(typeDir);
@@ -211,6 +391,18 @@ FindFileInXkbPath(struct xkb_context *ctx, const char *name,
         size_t new_buf_size = strlen(xkb_context_include_path_get(ctx, i)) +
                               typeDirLen + name_len + 3;
         int ret;
+
+        archive = darray_item(ctx->include_archives, i);
+        if (archive && !xkb_archive_find(archive, typeDir, name,
+                                         &src->string, &src->len))
+            continue;
+
+        if (!archive && use_index) {
+            struct include_dir *dir = get_include_dir(ctx, i, type, typeDir);
+            if (dir && !include_dir_has_file(dir, name))
+                continue;
+        }
+
         if (new_buf_size > buf_size) {
             void *buf_new = realloc(buf, new_buf_size);
             if (buf_new) {
@@ -231,12 +423,19 @@ FindFileInXkbPath(struct xkb_context *ctx, const char *name,
             continue;
         }
 
+        if (archive) {
+            found = true;
+            break;
+        }
+
         file = fopen(buf, "r");
-        if (file)
+        if (file) {
+            found = true;
             break;
+        }
     }
 
-    if (!file) {
+    if (!found) {
         log_err(ctx, "Couldn't find file \"%s/%s\" in include paths\n",
                 typeDir, name);
 
@@ -260,29 +459,118 @@ FindFileInXkbPath(struct xkb_context *ctx, const char *name,
         }
 
         free(buf);
-        return NULL;
+        return false;
+    }
+
+    src->file = file;
+    if (!file) {
+        src->archive_mtime = archive->mtime;
+    }
+    else {
+        src->string = NULL;
+        src->len = 0;
+        src->archive_mtime = 0;
     }
 
     if (pathRtrn)
         *pathRtrn = buf;
     else
         free(buf);
-    return file;
+    return true;
+}
+
+bool
+FindFileInXkbPath(struct xkb_context *ctx, const char *name,
+                  enum xkb_file_type type, char **pathRtrn,
+                  struct xkb_file_source *src)
+{
+    bool found;
+
+    /* For the include directory indexes. */
+    xkb_context_lock(ctx);
+    found = find_file_in_xkb_path(ctx, name, type, pathRtrn, src);
+    xkb_context_unlock(ctx);
+
+    return found;
+}
+
+void
+CloseXkbFileSource(struct xkb_file_source *src)
+{
+    if (src->file)
+        fclose(src->file);
+    src->file = NULL;
+}
+
+/*
+ * A file included in the current compilation. Included files are
+ * memoized, since the same file(map) is often included several times,
+ * e.g. by every layout. Included ASTs are not modified while handled, so
+ * they can be reused.
+ */
+struct included_file {
+    enum xkb_file_type type;
+    char *file;
+    char *map;
+    XkbFile *xkb_file;
+    /* Whether it is being handled, i.e. it is including itself. */
+    unsigned int active;
+};
+
+static struct included_file *
+find_included_file(darray_included_file *included_files,
+                   enum xkb_file_type type, const char *file, const char *map)
+{
+    struct included_file *included;
+
+    darray_foreach(included, *included_files)
+        if (included->type == type && streq(included->file, file) &&
+            (included->map == map ||
+             (included->map && map && streq(included->map, map))))
+            return included;
+
+    return NULL;
 }
 
 XkbFile *
-ProcessIncludeFile(struct xkb_context *ctx, IncludeStmt *stmt,
+ProcessIncludeFile(struct xkb_context *ctx,
+                   darray_included_file *included_files, IncludeStmt *stmt,
                    enum xkb_file_type file_type)
 {
-    FILE *file;
+    struct xkb_file_source src;
     XkbFile *xkb_file;
+    struct included_file *included, new;
+    const char *string;
+    size_t len;
 
-    file = FindFileInXkbPath(ctx, stmt->file, file_type, NULL);
-    if (!file)
-        return false;
+    included = find_included_file(included_files, file_type,
+                                  stmt->file, stmt->map);
+    if (included) {
+        if (included->active) {
+            log_err(ctx, "Recursive include of \"%s%s%s%s\" detected\n",
+                    stmt->file, stmt->map ? "(" : "",
+                    stmt->map ? stmt->map : "", stmt->map ? ")" : "");
+            return NULL;
+        }
 
-    xkb_file = XkbParseFile(ctx, file, stmt->file, stmt->map);
-    fclose(file);
+        included->active++;
+        return included->xkb_file;
+    }
+
+    if (GetProvidedFile(ctx, stmt->file, file_type, &string, &len)) {
+        xkb_file = XkbParseString(ctx, string, len, stmt->file, stmt->map);
+    }
+    else {
+        if (!FindFileInXkbPath(ctx, stmt->file, file_type, NULL, &src))
+            return NULL;
+
+        if (src.file)
+            xkb_file = XkbParseFile(ctx, src.file, stmt->file, stmt->map);
+        else
+            xkb_file = XkbParseString(ctx, src.string, src.len,
+                                      stmt->file, stmt->map);
+        CloseXkbFileSource(&src);
+    }
     if (!xkb_file) {
         if (stmt->map)
             log_err(ctx, "Couldn't process include statement for '%s(%s)'\n",
@@ -303,7 +591,45 @@ ProcessIncludeFile(struct xkb_context *ctx, IncludeStmt *stmt,
         return NULL;
     }
 
-    /* FIXME: we have to check recursive includes here (or somewhere) */
+    new.type = file_type;
+    new.file = strdup(stmt->file);
+    new.map = strdup_safe(stmt->map);
+    new.xkb_file = xkb_file;
+    new.active = 1;
+    if (!new.file || (stmt->map && !new.map)) {
+        /* Can't memoize it, just don't reuse it. */
+        free(new.file);
+        free(new.map);
+        new.file = new.map = NULL;
+        new.type = _FILE_TYPE_NUM_ENTRIES;
+    }
+    darray_append(*included_files, new);
 
     return xkb_file;
 }
+
+void
+ReleaseIncludeFile(darray_included_file *included_files, XkbFile *xkb_file)
+{
+    struct included_file *included;
+
+    darray_foreach(included, *included_files) {
+        if (included->xkb_file == xkb_file) {
+            included->active--;
+            return;
+        }
+    }
+}
+
+void
+ClearIncludedFiles(darray_included_file *included_files)
+{
+    struct included_file *included;
+
+    darray_foreach(included, *included_files) {
+        free(included->file);
+        free(included->map);
+        FreeXkbFile(included->xkb_file);
+    }
+    darray_free(*included_files);
+}
@@ -31,12 +31,49 @@ bool
 ParseIncludeMap(char **str_inout, char **file_rtrn, char **map_rtrn,
                 char *nextop_rtrn, char **extra_data);
 
-FILE *
+/*
+ * Get the contents of a file from the context's include_fn, if it
+ * provides it.
+ */
+bool
+GetProvidedFile(struct xkb_context *ctx, const char *name,
+                enum xkb_file_type type, const char **string_out,
+                size_t *len_out);
+
+/*
+ * A file found in the include path. If it is in a packed archive, @file is
+ * NULL and the contents are read directly from the archive.
+ */
+struct xkb_file_source {
+    FILE *file;
+    const char *string;
+    size_t len;
+    /* The mtime of the archive the file is in, if any. */
+    int64_t archive_mtime;
+};
+
+bool
 FindFileInXkbPath(struct xkb_context *ctx, const char *name,
-                  enum xkb_file_type type, char **pathRtrn);
+                  enum xkb_file_type type, char **pathRtrn,
+                  struct xkb_file_source *src);
 
+void
+CloseXkbFileSource(struct xkb_file_source *src);
+
+/*
+ * The returned file is owned by @included_files until
+ * ClearIncludedFiles(); call ReleaseIncludeFile() when done handling it.
+ */
 XkbFile *
-ProcessIncludeFile(struct xkb_context *ctx, IncludeStmt *stmt,
+ProcessIncludeFile(struct xkb_context *ctx,
+                   darray_included_file *included_files, IncludeStmt *stmt,
                    enum xkb_file_type file_type);
 
+void
+ReleaseIncludeFile(darray_included_file *included_files, XkbFile *xkb_file);
+
+/* Free the files included in a compilation. */
+void
+ClearIncludedFiles(darray_included_file *included_files);
+
 #endif
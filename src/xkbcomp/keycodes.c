@@ -54,6 +54,7 @@ typedef struct {
     darray(AliasInfo) aliases;
 
     struct xkb_context *ctx;
+    darray_included_file *included_files;
 } KeyNamesInfo;
 
 /***====================================================================***/
@@ -152,10 +153,12 @@ ClearKeyNamesInfo(KeyNamesInfo *info)
 }
 
 static void
-InitKeyNamesInfo(KeyNamesInfo *info, struct xkb_context *ctx)
+InitKeyNamesInfo(KeyNamesInfo *info, struct xkb_context *ctx,
+                 darray_included_file *included_files)
 {
     memset(info, 0, sizeof(*info));
     info->ctx = ctx;
+    info->included_files = included_files;
     info->min_key_code = XKB_KEYCODE_INVALID;
 #if XKB_KEYCODE_INVALID < XKB_KEYCODE_MAX
 #error "Hey, you can't be changing stuff like that."
@@ -334,29 +337,29 @@ HandleIncludeKeycodes(KeyNamesInfo *info, IncludeStmt *include)
 {
     KeyNamesInfo included;
 
-    InitKeyNamesInfo(&included, info->ctx);
-    included.name = include->stmt;
-    include->stmt = NULL;
+    InitKeyNamesInfo(&included, info->ctx, info->included_files);
+    included.name = strdup_safe(include->stmt);
 
     for (IncludeStmt *stmt = include; stmt; stmt = stmt->next_incl) {
         KeyNamesInfo next_incl;
         XkbFile *file;
 
-        file = ProcessIncludeFile(info->ctx, stmt, FILE_TYPE_KEYCODES);
+        file = ProcessIncludeFile(info->ctx, info->included_files, stmt,
+                                  FILE_TYPE_KEYCODES);
         if (!file) {
             info->errorCount += 10;
             ClearKeyNamesInfo(&included);
             return false;
         }
 
-        InitKeyNamesInfo(&next_incl, info->ctx);
+        InitKeyNamesInfo(&next_incl, info->ctx, info->included_files);
 
         HandleKeycodesFile(&next_incl, file, MERGE_OVERRIDE);
 
         MergeIncludedKeycodes(&included, &next_incl, stmt->merge);
 
         ClearKeyNamesInfo(&next_incl);
-        FreeXkbFile(file);
+        ReleaseIncludeFile(info->included_files, file);
     }
 
     MergeIncludedKeycodes(info, &included, include->merge);
@@ -614,11 +617,11 @@ CopyKeyNamesToKeymap(struct xkb_keymap *keymap, KeyNamesInfo *info)
 
 bool
 CompileKeycodes(XkbFile *file, struct xkb_keymap *keymap,
-                enum merge_mode merge)
+                enum merge_mode merge, darray_included_file *included_files)
 {
     KeyNamesInfo info;
 
-    InitKeyNamesInfo(&info, keymap->ctx);
+    InitKeyNamesInfo(&info, keymap->ctx, included_files);
 
     HandleKeycodesFile(&info, file, merge);
     if (info.errorCount != 0)
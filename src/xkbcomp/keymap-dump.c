@@ -52,67 +52,112 @@
 #include "xkbcomp-priv.h"
 #include "text.h"
 
-#define BUF_CHUNK_SIZE 4096
+/*
+ * The keymap is written through a fixed-size staging buffer, which is
+ * flushed to the write function when full. Formatted writes flush first
+ * if less than BUF_FORMAT_RESERVE is left, so they are formatted once,
+ * straight into the buffer, unless they are longer than that.
+ */
+#define BUF_SIZE 4096
+#define BUF_FORMAT_RESERVE 256
 
 struct buf {
-    char *buf;
+    char data[BUF_SIZE];
     size_t size;
-    size_t alloc;
+    int (*write_fn)(void *user_data, const char *data, size_t length);
+    void *user_data;
 };
 
 static bool
-do_realloc(struct buf *buf, size_t at_least)
+flush_buf(struct buf *buf)
 {
-    char *new;
+    if (buf->size > 0 && !buf->write_fn(buf->user_data, buf->data, buf->size))
+        return false;
 
-    buf->alloc += BUF_CHUNK_SIZE;
-    if (at_least >= BUF_CHUNK_SIZE)
-        buf->alloc += at_least;
+    buf->size = 0;
+    return true;
+}
 
-    new = realloc(buf->buf, buf->alloc);
-    if (!new)
-        return false;
+static bool
+write_buf_mem(struct buf *buf, const char *data, size_t length)
+{
+    if (length > BUF_SIZE - buf->size) {
+        if (!flush_buf(buf))
+            return false;
+        if (length > BUF_SIZE)
+            return buf->write_fn(buf->user_data, data, length);
+    }
 
-    buf->buf = new;
+    memcpy(buf->data + buf->size, data, length);
+    buf->size += length;
     return true;
 }
 
+static bool
+write_buf_str(struct buf *buf, const char *str)
+{
+    return write_buf_mem(buf, str, strlen(str));
+}
+
+/* Like "%*s": a negative width pads on the right. */
+static bool
+write_buf_padded(struct buf *buf, const char *str, int width)
+{
+    static const char spaces[] = "                                ";
+    size_t length = strlen(str);
+    size_t field = (size_t) (width < 0 ? -width : width);
+    size_t pad = (field > length ? field - length : 0);
+
+    if (width < 0 && !write_buf_mem(buf, str, length))
+        return false;
+
+    while (pad > 0) {
+        size_t n = MIN(pad, sizeof(spaces) - 1);
+        if (!write_buf_mem(buf, spaces, n))
+            return false;
+        pad -= n;
+    }
+
+    return width < 0 || write_buf_mem(buf, str, length);
+}
+
 ATTR_PRINTF(2, 3) static bool
 check_write_buf(struct buf *buf, const char *fmt, ...)
 {
     va_list args;
     int printed;
     size_t available;
+    char *str;
+    bool ok;
 
-    available = buf->alloc - buf->size;
+    if (BUF_SIZE - buf->size < BUF_FORMAT_RESERVE && !flush_buf(buf))
+        return false;
+
+    available = BUF_SIZE - buf->size;
     va_start(args, fmt);
-    printed = vsnprintf(buf->buf + buf->size, available, fmt, args);
+    printed = vsnprintf(buf->data + buf->size, available, fmt, args);
     va_end(args);
 
     if (printed < 0)
-        goto err;
+        return false;
 
-    if ((size_t) printed >= available)
-        if (!do_realloc(buf, printed))
-            goto err;
+    if ((size_t) printed < available) {
+        buf->size += printed;
+        return true;
+    }
 
-    /* The buffer has enough space now. */
+    /* Longer than the reserve; rare. */
+    str = malloc(printed + 1);
+    if (!str)
+        return false;
 
-    available = buf->alloc - buf->size;
     va_start(args, fmt);
-    printed = vsnprintf(buf->buf + buf->size, available, fmt, args);
+    vsnprintf(str, printed + 1, fmt, args);
     va_end(args);
 
-    if (printed < 0 || (size_t) printed >= available)
-        goto err;
-
-    buf->size += printed;
-    return true;
-
-err:
-    free(buf->buf);
-    buf->buf = NULL;
-    return false;
+    ok = write_buf_mem(buf, str, printed);
+    free(str);
+    return ok;
 }
 
 #define write_buf(buf, ...) do { \
@@ -120,6 +165,43 @@ err:
         return false; \
 } while (0)
 
+#define write_str(buf, str) do { \
+    if (!write_buf_str(buf, str)) \
+        return false; \
+} while (0)
+
+/* Key names and keysyms are frequent enough to avoid printf for. */
+static bool
+write_key_name(struct xkb_keymap *keymap, struct buf *buf, xkb_atom_t name,
+               int width)
+{
+    const char *text = strempty(xkb_atom_text(keymap->ctx, name));
+    size_t length = strlen(text);
+    char tmp[64];
+
+    if (length + 2 >= sizeof(tmp))
+        /* Wider than any field. */
+        return (write_buf_mem(buf, "<", 1) &&
+                write_buf_mem(buf, text, length) &&
+                write_buf_mem(buf, ">", 1));
+
+    tmp[0] = '<';
+    memcpy(tmp + 1, text, length);
+    tmp[length + 1] = '>';
+    tmp[length + 2] = '\0';
+    return write_buf_padded(buf, tmp, width);
+}
+
+static bool
+write_keysym(struct xkb_keymap *keymap, struct buf *buf, xkb_keysym_t sym,
+             int width)
+{
+    char name[64];
+
+    xkb_keysym_get_name(sym, name, sizeof(name));
+    return write_buf_padded(buf, name, width);
+}
+
 static bool
 write_vmods(struct xkb_keymap *keymap, struct buf *buf)
 {
@@ -131,15 +213,15 @@ write_vmods(struct xkb_keymap *keymap, struct buf *buf)
             continue;
 
         if (num_vmods == 0)
-            write_buf(buf, "\tvirtual_modifiers ");
+            write_str(buf, "\tvirtual_modifiers ");
         else
-            write_buf(buf, ",");
-        write_buf(buf, "%s", xkb_atom_text(keymap->ctx, mod->name));
+            write_str(buf, ",");
+        write_str(buf, xkb_atom_text(keymap->ctx, mod->name));
         num_vmods++;
     }
 
     if (num_vmods > 0)
-        write_buf(buf, ";\n\n");
+        write_str(buf, ";\n\n");
 
     return true;
 }
@@ -155,7 +237,7 @@ write_keycodes(struct xkb_keymap *keymap, struct buf *buf)
         write_buf(buf, "xkb_keycodes \"%s\" {\n",
                   keymap->keycodes_section_name);
     else
-        write_buf(buf, "xkb_keycodes {\n");
+        write_str(buf, "xkb_keycodes {\n");
 
     /* xkbcomp and X11 really want to see keymaps with a minimum of 8, and
      * a maximum of at least 255, else XWayland really starts hating life.
@@ -168,8 +250,10 @@ write_keycodes(struct xkb_keymap *keymap, struct buf *buf)
         if (key->name == XKB_ATOM_NONE)
             continue;
 
-        write_buf(buf, "\t%-20s = %u;\n",
-                  KeyNameText(keymap->ctx, key->name), key->keycode);
+        write_str(buf, "\t");
+        if (!write_key_name(keymap, buf, key->name, -20))
+            return false;
+        write_buf(buf, " = %u;\n", key->keycode);
     }
 
     xkb_leds_enumerate(idx, led, keymap)
@@ -178,12 +262,17 @@ write_keycodes(struct xkb_keymap *keymap, struct buf *buf)
                       idx + 1, xkb_atom_text(keymap->ctx, led->name));
 
 
-    for (unsigned i = 0; i < keymap->num_key_aliases; i++)
-        write_buf(buf, "\talias %-14s = %s;\n",
-                  KeyNameText(keymap->ctx, keymap->key_aliases[i].alias),
-                  KeyNameText(keymap->ctx, keymap->key_aliases[i].real));
+    for (unsigned i = 0; i < keymap->num_key_aliases; i++) {
+        write_str(buf, "\talias ");
+        if (!write_key_name(keymap, buf, keymap->key_aliases[i].alias, -14))
+            return false;
+        write_str(buf, " = ");
+        if (!write_key_name(keymap, buf, keymap->key_aliases[i].real, 0))
+            return false;
+        write_str(buf, ";\n");
+    }
 
-    write_buf(buf, "};\n\n");
+    write_str(buf, "};\n\n");
     return true;
 }
 
@@ -194,9 +283,10 @@ write_types(struct xkb_keymap *keymap, struct buf *buf)
         write_buf(buf, "xkb_types \"%s\" {\n",
                   keymap->types_section_name);
     else
-        write_buf(buf, "xkb_types {\n");
+        write_str(buf, "xkb_types {\n");
 
-    write_vmods(keymap, buf);
+    if (!write_vmods(keymap, buf))
+        return false;
 
     for (unsigned i = 0; i < keymap->num_types; i++) {
         const struct xkb_key_type *type = &keymap->types[i];
@@ -233,10 +323,10 @@ write_types(struct xkb_keymap *keymap, struct buf *buf)
                 write_buf(buf, "\t\tlevel_name[Level%u]= \"%s\";\n", n + 1,
                           xkb_atom_text(keymap->ctx, type->level_names[n]));
 
-        write_buf(buf, "\t};\n");
+        write_str(buf, "\t};\n");
     }
 
-    write_buf(buf, "};\n\n");
+    write_str(buf, "};\n\n");
     return true;
 }
 
@@ -270,7 +360,7 @@ write_led_map(struct xkb_keymap *keymap, struct buf *buf,
                   ControlMaskText(keymap->ctx, led->ctrls));
     }
 
-    write_buf(buf, "\t};\n");
+    write_str(buf, "\t};\n");
     return true;
 }
 
@@ -352,7 +442,7 @@ write_action(struct xkb_keymap *keymap, struct buf *buf,
         if (action->btn.button > 0 && action->btn.button <= 5)
             write_buf(buf, "%d", action->btn.button);
         else
-            write_buf(buf, "default");
+            write_str(buf, "default");
         if (action->btn.count)
             write_buf(buf, ",count=%d", action->btn.count);
         if (args)
@@ -411,12 +501,13 @@ write_compat(struct xkb_keymap *keymap, struct buf *buf)
         write_buf(buf, "xkb_compatibility \"%s\" {\n",
                   keymap->compat_section_name);
     else
-        write_buf(buf, "xkb_compatibility {\n");
+        write_str(buf, "xkb_compatibility {\n");
 
-    write_vmods(keymap, buf);
+    if (!write_vmods(keymap, buf))
+        return false;
 
-    write_buf(buf, "\tinterpret.useModMapMods= AnyLevel;\n");
-    write_buf(buf, "\tinterpret.repeat= False;\n");
+    write_str(buf, "\tinterpret.useModMapMods= AnyLevel;\n");
+    write_str(buf, "\tinterpret.repeat= False;\n");
 
     for (unsigned i = 0; i < keymap->num_sym_interprets; i++) {
         const struct xkb_sym_interpret *si = &keymap->sym_interprets[i];
@@ -432,21 +523,23 @@ write_compat(struct xkb_keymap *keymap, struct buf *buf)
                                    si->virtual_mod));
 
         if (si->level_one_only)
-            write_buf(buf, "\t\tuseModMapMods=level1;\n");
+            write_str(buf, "\t\tuseModMapMods=level1;\n");
 
         if (si->repeat)
-            write_buf(buf, "\t\trepeat= True;\n");
+            write_str(buf, "\t\trepeat= True;\n");
 
-        write_action(keymap, buf, &si->action, "\t\taction= ", ";\n");
-        write_buf(buf, "\t};\n");
+        if (!write_action(keymap, buf, &si->action, "\t\taction= ", ";\n"))
+            return false;
+        write_str(buf, "\t};\n");
     }
 
     xkb_leds_foreach(led, keymap)
-        if (led->which_groups || led->groups || led->which_mods ||
-            led->mods.mods || led->ctrls)
-            write_led_map(keymap, buf, led);
+        if ((led->which_groups || led->groups || led->which_mods ||
+             led->mods.mods || led->ctrls) &&
+            !write_led_map(keymap, buf, led))
+            return false;
 
-    write_buf(buf, "};\n\n");
+    write_str(buf, "};\n\n");
 
     return true;
 }
@@ -461,24 +554,27 @@ write_keysyms(struct xkb_keymap *keymap, struct buf *buf,
         int num_syms;
 
         if (level != 0)
-            write_buf(buf, ", ");
+            write_str(buf, ", ");
 
         num_syms = xkb_keymap_key_get_syms_by_level(keymap, key->keycode,
                                                     group, level, &syms);
         if (num_syms == 0) {
-            write_buf(buf, "%15s", "NoSymbol");
+            if (!write_buf_padded(buf, "NoSymbol", 15))
+                return false;
         }
         else if (num_syms == 1) {
-            write_buf(buf, "%15s", KeysymText(keymap->ctx, syms[0]));
+            if (!write_keysym(keymap, buf, syms[0], 15))
+                return false;
         }
         else {
-            write_buf(buf, "{ ");
+            write_str(buf, "{ ");
             for (int s = 0; s < num_syms; s++) {
                 if (s != 0)
-                    write_buf(buf, ", ");
-                write_buf(buf, "%s", KeysymText(keymap->ctx, syms[s]));
+                    write_str(buf, ", ");
+                if (!write_keysym(keymap, buf, syms[s], 0))
+                    return false;
             }
-            write_buf(buf, " }");
+            write_str(buf, " }");
         }
     }
 
@@ -495,7 +591,10 @@ write_key(struct xkb_keymap *keymap, struct buf *buf,
     bool multi_type = false;
     bool show_actions;
 
-    write_buf(buf, "\tkey %-20s {", KeyNameText(keymap->ctx, key->name));
+    write_str(buf, "\tkey ");
+    if (!write_key_name(keymap, buf, key->name, -20))
+        return false;
+    write_str(buf, " {");
 
     for (group = 0; group < key->num_groups; group++) {
         if (key->groups[group].explicit_type)
@@ -529,9 +628,9 @@ write_key(struct xkb_keymap *keymap, struct buf *buf,
 
     if (key->explicit & EXPLICIT_REPEAT) {
         if (key->repeats)
-            write_buf(buf, "\n\t\trepeat= Yes,");
+            write_str(buf, "\n\t\trepeat= Yes,");
         else
-            write_buf(buf, "\n\t\trepeat= No,");
+            write_str(buf, "\n\t\trepeat= No,");
         simple = false;
     }
 
@@ -541,7 +640,7 @@ write_key(struct xkb_keymap *keymap, struct buf *buf,
 
     switch (key->out_of_range_group_action) {
     case RANGE_SATURATE:
-        write_buf(buf, "\n\t\tgroupsClamp,");
+        write_str(buf, "\n\t\tgroupsClamp,");
         break;
 
     case RANGE_REDIRECT:
@@ -559,35 +658,38 @@ write_key(struct xkb_keymap *keymap, struct buf *buf,
         simple = false;
 
     if (simple) {
-        write_buf(buf, "\t[ ");
+        write_str(buf, "\t[ ");
         if (!write_keysyms(keymap, buf, key, 0))
             return false;
-        write_buf(buf, " ] };\n");
+        write_str(buf, " ] };\n");
     }
     else {
         xkb_level_index_t level;
 
         for (group = 0; group < key->num_groups; group++) {
             if (group != 0)
-                write_buf(buf, ",");
+                write_str(buf, ",");
             write_buf(buf, "\n\t\tsymbols[Group%u]= [ ", group + 1);
             if (!write_keysyms(keymap, buf, key, group))
                 return false;
-            write_buf(buf, " ]");
+            write_str(buf, " ]");
             if (show_actions) {
                 write_buf(buf, ",\n\t\tactions[Group%u]= [ ", group + 1);
                 for (level = 0;
                         level < XkbKeyGroupWidth(key, group); level++) {
+                    union xkb_action action;
+
                     if (level != 0)
-                        write_buf(buf, ", ");
-                    write_action(keymap, buf,
-                                    &key->groups[group].levels[level].action,
-                                    NULL, NULL);
+                        write_str(buf, ", ");
+                    XkbUnpackAction(&action,
+                                    &key->groups[group].levels[level].action);
+                    if (!write_action(keymap, buf, &action, NULL, NULL))
+                        return false;
                 }
-                write_buf(buf, " ]");
+                write_str(buf, " ]");
             }
         }
-        write_buf(buf, "\n\t};\n");
+        write_str(buf, "\n\t};\n");
     }
 
     return true;
@@ -603,7 +705,7 @@ write_symbols(struct xkb_keymap *keymap, struct buf *buf)
         write_buf(buf, "xkb_symbols \"%s\" {\n",
                   keymap->symbols_section_name);
     else
-        write_buf(buf, "xkb_symbols {\n");
+        write_str(buf, "xkb_symbols {\n");
 
     for (group = 0; group < keymap->num_group_names; group++)
         if (keymap->group_names[group])
@@ -611,11 +713,11 @@ write_symbols(struct xkb_keymap *keymap, struct buf *buf)
                       "\tname[group%u]=\"%s\";\n", group + 1,
                       xkb_atom_text(keymap->ctx, keymap->group_names[group]));
     if (group > 0)
-        write_buf(buf, "\n");
+        write_str(buf, "\n");
 
     xkb_keys_foreach(key, keymap)
-        if (key->num_groups > 0)
-            write_key(keymap, buf, key);
+        if (key->num_groups > 0 && !write_key(keymap, buf, key))
+            return false;
 
     xkb_keys_foreach(key, keymap) {
         xkb_mod_index_t i;
@@ -624,37 +726,45 @@ write_symbols(struct xkb_keymap *keymap, struct buf *buf)
         if (key->modmap == 0)
             continue;
 
-        xkb_mods_enumerate(i, mod, &keymap->mods)
-            if (key->modmap & (1u << i))
-                write_buf(buf, "\tmodifier_map %s { %s };\n",
-                          xkb_atom_text(keymap->ctx, mod->name),
-                          KeyNameText(keymap->ctx, key->name));
+        xkb_mods_enumerate(i, mod, &keymap->mods) {
+            if (!(key->modmap & (1u << i)))
+                continue;
+
+            write_buf(buf, "\tmodifier_map %s { ",
+                      xkb_atom_text(keymap->ctx, mod->name));
+            if (!write_key_name(keymap, buf, key->name, 0))
+                return false;
+            write_str(buf, " };\n");
+        }
     }
 
-    write_buf(buf, "};\n\n");
+    write_str(buf, "};\n\n");
     return true;
 }
 
 static bool
 write_keymap(struct xkb_keymap *keymap, struct buf *buf)
 {
-    return (check_write_buf(buf, "xkb_keymap {\n") &&
+    return (write_buf_str(buf, "xkb_keymap {\n") &&
             write_keycodes(keymap, buf) &&
             write_types(keymap, buf) &&
             write_compat(keymap, buf) &&
             write_symbols(keymap, buf) &&
-            check_write_buf(buf, "};\n"));
+            write_buf_str(buf, "};\n") &&
+            flush_buf(buf));
 }
 
-char *
-text_v1_keymap_get_as_string(struct xkb_keymap *keymap)
+bool
+text_v1_keymap_write(struct xkb_keymap *keymap,
+                     int (*write_fn)(void *user_data, const char *data,
+                                     size_t length),
+                     void *user_data)
 {
-    struct buf buf = { NULL, 0, 0 };
+    struct buf buf;
 
-    if (!write_keymap(keymap, &buf)) {
-        free(buf.buf);
-        return NULL;
-    }
+    buf.size = 0;
+    buf.write_fn = write_fn;
+    buf.user_data = user_data;
 
-    return buf.buf;
+    return write_keymap(keymap, &buf);
 }
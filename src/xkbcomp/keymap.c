@@ -28,6 +28,7 @@
  */
 
 #include "xkbcomp-priv.h"
+#include "include.h"
 
 static void
 ComputeEffectiveMask(struct xkb_keymap *keymap, struct xkb_mods *mods)
@@ -161,7 +162,8 @@ ApplyInterpsToKey(struct xkb_keymap *keymap, struct xkb_key *key)
                     vmodmap |= (1u << interp->virtual_mod);
 
             if (interp->action.type != ACTION_TYPE_NONE)
-                key->groups[group].levels[level].action = interp->action;
+                XkbPackAction(&key->groups[group].levels[level].action,
+                              &interp->action);
         }
     }
 
@@ -171,6 +173,109 @@ ApplyInterpsToKey(struct xkb_keymap *keymap, struct xkb_key *key)
     return true;
 }
 
+static uint32_t
+HashLevels(const struct xkb_level *levels, xkb_level_index_t num_levels)
+{
+    /* FNV-1a over the keysyms and actions. */
+    uint32_t hash = 2166136261u;
+
+    for (xkb_level_index_t i = 0; i < num_levels; i++) {
+        const struct xkb_level *level = &levels[i];
+        const xkb_keysym_t *syms =
+            (level->num_syms > 1 ? level->u.syms : &level->u.sym);
+        const unsigned char *p = (const unsigned char *) &level->action;
+
+        for (size_t j = 0; j < sizeof(level->action); j++)
+            hash = (hash ^ p[j]) * 16777619u;
+        for (unsigned j = 0; j < level->num_syms; j++)
+            hash = (hash ^ syms[j]) * 16777619u;
+        hash = (hash ^ level->num_syms) * 16777619u;
+    }
+
+    return hash;
+}
+
+static bool
+LevelsEqual(const struct xkb_level *a, const struct xkb_level *b,
+            xkb_level_index_t num_levels)
+{
+    for (xkb_level_index_t i = 0; i < num_levels; i++) {
+        if (a[i].num_syms != b[i].num_syms)
+            return false;
+        if (memcmp(&a[i].action, &b[i].action, sizeof(a[i].action)) != 0)
+            return false;
+        if (a[i].num_syms == 1 && a[i].u.sym != b[i].u.sym)
+            return false;
+        if (a[i].num_syms > 1 &&
+            memcmp(a[i].u.syms, b[i].u.syms,
+                   a[i].num_syms * sizeof(*a[i].u.syms)) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ * Many keys end up with identical levels (e.g. the letters and the keypad
+ * keys). The levels don't change anymore once the keymap is compiled, so
+ * let such groups share a single array, which is owned by the first group
+ * which has it.
+ */
+static void
+ShareLevels(struct xkb_keymap *keymap)
+{
+    struct xkb_key *key;
+    struct xkb_group **table;
+    size_t size = 1, num_groups = 0;
+
+    xkb_keys_foreach(key, keymap)
+        num_groups += key->num_groups;
+
+    while (size < num_groups * 2)
+        size <<= 1;
+
+    /* Sharing is only an optimization, so don't fail. */
+    table = calloc(size, sizeof(*table));
+    if (!table)
+        return;
+
+    xkb_keys_foreach(key, keymap) {
+        for (xkb_layout_index_t i = 0; i < key->num_groups; i++) {
+            struct xkb_group *group = &key->groups[i];
+            xkb_level_index_t width = XkbKeyGroupWidth(key, i);
+            size_t pos;
+
+            if (!group->levels || width == 0)
+                continue;
+
+            pos = HashLevels(group->levels, width) & (size - 1);
+            while (table[pos]) {
+                const struct xkb_group *owner = table[pos];
+
+                if (owner->type->num_levels == width &&
+                    LevelsEqual(owner->levels, group->levels, width))
+                    break;
+
+                pos = (pos + 1) & (size - 1);
+            }
+
+            if (!table[pos]) {
+                table[pos] = group;
+                continue;
+            }
+
+            for (xkb_level_index_t j = 0; j < width; j++)
+                if (group->levels[j].num_syms > 1)
+                    free(group->levels[j].u.syms);
+            free(group->levels);
+            group->levels = table[pos]->levels;
+            group->shared_levels = true;
+        }
+    }
+
+    free(table);
+}
+
 /**
  * This collects a bunch of disparate functions which was done in the server
  * at various points that really should've been done within xkbcomp.  Turns out
@@ -208,11 +313,19 @@ UpdateDerivedKeymapFields(struct xkb_keymap *keymap)
     }
 
     /* Update action modifiers. */
-    xkb_keys_foreach(key, keymap)
-        for (i = 0; i < key->num_groups; i++)
-            for (j = 0; j < XkbKeyGroupWidth(key, i); j++)
-                UpdateActionMods(keymap, &key->groups[i].levels[j].action,
-                                 key->modmap);
+    xkb_keys_foreach(key, keymap) {
+        for (i = 0; i < key->num_groups; i++) {
+            for (j = 0; j < XkbKeyGroupWidth(key, i); j++) {
+                union xkb_packed_action *packed =
+                    &key->groups[i].levels[j].action;
+                union xkb_action action;
+
+                XkbUnpackAction(&action, packed);
+                UpdateActionMods(keymap, &action, key->modmap);
+                XkbPackAction(packed, &action);
+            }
+        }
+    }
 
     /* Update vmod -> led maps. */
     xkb_leds_foreach(led, keymap)
@@ -222,12 +335,15 @@ UpdateDerivedKeymapFields(struct xkb_keymap *keymap)
     xkb_keys_foreach(key, keymap)
         keymap->num_groups = MAX(keymap->num_groups, key->num_groups);
 
+    ShareLevels(keymap);
+
     return true;
 }
 
 typedef bool (*compile_file_fn)(XkbFile *file,
                                 struct xkb_keymap *keymap,
-                                enum merge_mode merge);
+                                enum merge_mode merge,
+                                darray_included_file *included_files);
 
 static const compile_file_fn compile_file_fns[LAST_KEYMAP_FILE_TYPE + 1] = {
     [FILE_TYPE_KEYCODES] = CompileKeycodes,
@@ -236,14 +352,166 @@ static const compile_file_fn compile_file_fns[LAST_KEYMAP_FILE_TYPE + 1] = {
     [FILE_TYPE_SYMBOLS] = CompileSymbols,
 };
 
+/*
+ * The following copy the result of compiling a section from a keymap
+ * created with the same components. They must leave @keymap in the same
+ * state the matching compile_file_fns would, which is why some of it
+ * comes from the base keymap's origin rather than the base itself: later
+ * sections and UpdateDerivedKeymapFields() modify it.
+ */
+
+static bool
+CopyKeycodesFromBase(struct xkb_keymap *keymap, const struct xkb_keymap *base)
+{
+    const struct xkb_keymap_origin *origin = base->origin;
+    xkb_keycode_t kc;
+
+    keymap->keycodes_section_name = strdup_safe(base->keycodes_section_name);
+
+    keymap->min_key_code = base->min_key_code;
+    keymap->max_key_code = base->max_key_code;
+
+    keymap->keys = calloc(keymap->max_key_code + 1, sizeof(*keymap->keys));
+    if (!keymap->keys)
+        return false;
+
+    for (kc = keymap->min_key_code; kc <= keymap->max_key_code; kc++) {
+        keymap->keys[kc].keycode = kc;
+        keymap->keys[kc].name = base->keys[kc].name;
+    }
+
+    keymap->num_key_aliases = base->num_key_aliases;
+    keymap->key_aliases = memdup(base->key_aliases, base->num_key_aliases,
+                                 sizeof(*base->key_aliases));
+    if (base->num_key_aliases > 0 && !keymap->key_aliases)
+        return false;
+
+    keymap->num_leds = origin->keycodes_num_leds;
+    for (xkb_led_index_t idx = 0; idx < origin->keycodes_num_leds; idx++)
+        keymap->leds[idx].name = origin->keycodes_led_names[idx];
+
+    return true;
+}
+
+static bool
+CopyKeyTypesFromBase(struct xkb_keymap *keymap, const struct xkb_keymap *base)
+{
+    keymap->types_section_name = strdup_safe(base->types_section_name);
+
+    keymap->mods = base->origin->types_mods;
+
+    keymap->types = calloc(base->num_types, sizeof(*keymap->types));
+    if (!keymap->types)
+        return false;
+    keymap->num_types = base->num_types;
+
+    for (unsigned i = 0; i < base->num_types; i++) {
+        const struct xkb_key_type *from = &base->types[i];
+        struct xkb_key_type *type = &keymap->types[i];
+
+        *type = *from;
+        type->entries = NULL;
+        type->level_names = NULL;
+
+        if (from->num_entries > 0) {
+            type->entries = memdup(from->entries, from->num_entries,
+                                   sizeof(*from->entries));
+            if (!type->entries)
+                return false;
+        }
+
+        if (from->level_names) {
+            type->level_names = memdup(from->level_names, from->num_levels,
+                                       sizeof(*from->level_names));
+            if (!type->level_names)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+static bool
+CopyCompatMapFromBase(struct xkb_keymap *keymap,
+                      const struct xkb_keymap *base)
+{
+    keymap->compat_section_name = strdup_safe(base->compat_section_name);
+
+    keymap->mods = base->origin->compat_mods;
+
+    if (base->num_sym_interprets > 0) {
+        keymap->sym_interprets = memdup(base->sym_interprets,
+                                        base->num_sym_interprets,
+                                        sizeof(*base->sym_interprets));
+        if (!keymap->sym_interprets)
+            return false;
+        keymap->num_sym_interprets = base->num_sym_interprets;
+    }
+
+    /* The symbols section doesn't touch the LEDs. */
+    memcpy(keymap->leds, base->leds, sizeof(keymap->leds));
+    keymap->num_leds = base->num_leds;
+
+    return true;
+}
+
+typedef bool (*copy_section_fn)(struct xkb_keymap *keymap,
+                                const struct xkb_keymap *base);
+
+static const copy_section_fn copy_section_fns[LAST_KEYMAP_FILE_TYPE + 1] = {
+    [FILE_TYPE_KEYCODES] = CopyKeycodesFromBase,
+    [FILE_TYPE_TYPES] = CopyKeyTypesFromBase,
+    [FILE_TYPE_COMPAT] = CopyCompatMapFromBase,
+};
+
+/*
+ * Remember what the section of type @type has left in the keymap, if it
+ * is needed later for reusing the section.
+ */
+static void
+UpdateKeymapOrigin(struct xkb_keymap *keymap, enum xkb_file_type type)
+{
+    struct xkb_keymap_origin *origin = keymap->origin;
+
+    if (!origin)
+        return;
+
+    switch (type) {
+    case FILE_TYPE_KEYCODES:
+        origin->keycodes_num_leds = keymap->num_leds;
+        for (xkb_led_index_t idx = 0; idx < keymap->num_leds; idx++)
+            origin->keycodes_led_names[idx] = keymap->leds[idx].name;
+        break;
+    case FILE_TYPE_TYPES:
+        origin->types_mods = keymap->mods;
+        break;
+    case FILE_TYPE_COMPAT:
+        origin->compat_mods = keymap->mods;
+        break;
+    default:
+        break;
+    }
+}
+
+/*
+ * Sections before @first_type are copied from @base instead of being
+ * compiled, if @base is not NULL.
+ */
 bool
-CompileKeymap(XkbFile *file, struct xkb_keymap *keymap, enum merge_mode merge)
+CompileKeymap(XkbFile *file, struct xkb_keymap *keymap,
+              const struct xkb_keymap *base, enum xkb_file_type first_type,
+              enum merge_mode merge)
 {
     bool ok;
     const char *main_name;
     XkbFile *files[LAST_KEYMAP_FILE_TYPE + 1] = { NULL };
     enum xkb_file_type type;
     struct xkb_context *ctx = keymap->ctx;
+    darray_included_file included_files = darray_new();
+
+    /* Only sections before the symbols can be reused. */
+    if (!base || !base->origin || first_type > FILE_TYPE_SYMBOLS)
+        first_type = FIRST_KEYMAP_FILE_TYPE;
 
     main_name = file->name ? file->name : "(unnamed)";
 
@@ -294,16 +562,32 @@ CompileKeymap(XkbFile *file, struct xkb_keymap *keymap, enum merge_mode merge)
     for (type = FIRST_KEYMAP_FILE_TYPE;
          type <= LAST_KEYMAP_FILE_TYPE;
          type++) {
-        log_dbg(ctx, "Compiling %s \"%s\"\n",
-                xkb_file_type_to_string(type), files[type]->topName);
+        if (type < first_type) {
+            log_dbg(ctx, "Reusing %s \"%s\" from base keymap\n",
+                    xkb_file_type_to_string(type), files[type]->topName);
 
-        ok = compile_file_fns[type](files[type], keymap, merge);
+            ok = copy_section_fns[type](keymap, base);
+        }
+        else {
+            log_dbg(ctx, "Compiling %s \"%s\"\n",
+                    xkb_file_type_to_string(type), files[type]->topName);
+
+            ok = compile_file_fns[type](files[type], keymap, merge,
+                                        &included_files);
+        }
         if (!ok) {
             log_err(ctx, "Failed to compile %s\n",
                     xkb_file_type_to_string(type));
-            return false;
+            break;
         }
+
+        UpdateKeymapOrigin(keymap, type);
     }
 
+    ClearIncludedFiles(&included_files);
+
+    if (!ok)
+        return false;
+
     return UpdateDerivedKeymapFields(keymap);
 }
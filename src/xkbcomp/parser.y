@@ -568,19 +568,19 @@ FieldSpec       :       Ident   { $$ = $1; }
                 ;
 
 Element         :       ACTION_TOK
-                        { $$ = xkb_atom_intern_literal(param->ctx, "action"); }
+                        { $$ = ATOM_ACTION; }
                 |       INTERPRET
-                        { $$ = xkb_atom_intern_literal(param->ctx, "interpret"); }
+                        { $$ = ATOM_INTERPRET; }
                 |       TYPE
-                        { $$ = xkb_atom_intern_literal(param->ctx, "type"); }
+                        { $$ = ATOM_TYPE; }
                 |       KEY
-                        { $$ = xkb_atom_intern_literal(param->ctx, "key"); }
+                        { $$ = ATOM_KEY; }
                 |       GROUP
-                        { $$ = xkb_atom_intern_literal(param->ctx, "group"); }
+                        { $$ = ATOM_GROUP; }
                 |       MODIFIER_MAP
-                        {$$ = xkb_atom_intern_literal(param->ctx, "modifier_map");}
+                        {$$ = ATOM_MODIFIER_MAP;}
                 |       INDICATOR
-                        { $$ = xkb_atom_intern_literal(param->ctx, "indicator"); }
+                        { $$ = ATOM_INDICATOR; }
                 |       SHAPE
                         { $$ = XKB_ATOM_NONE; }
                 |       ROW
@@ -746,7 +746,7 @@ KeyCode         :       INTEGER { $$ = $1; }
                 ;
 
 Ident           :       IDENT   { $$ = xkb_atom_steal(param->ctx, $1); }
-                |       DEFAULT { $$ = xkb_atom_intern_literal(param->ctx, "default"); }
+                |       DEFAULT { $$ = ATOM_DEFAULT; }
                 ;
 
 String          :       STRING  { $$ = xkb_atom_steal(param->ctx, $1); }
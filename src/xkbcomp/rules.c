@@ -47,6 +47,9 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "xkbcomp-priv.h"
 #include "rules.h"
 #include "include.h"
@@ -186,11 +189,15 @@ static const struct sval rules_kccgst_svals[_KCCGST_NUM_ENTRIES] = {
  * A broken-down version of xkb_rule_names (without the rules,
  * obviously).
  */
+typedef darray(uint32_t) darray_uint32;
+
 struct rule_names {
     struct sval model;
     darray_sval layouts;
     darray_sval variants;
     darray_sval options;
+    /* Hash set of the options; see has_option(). */
+    darray_uint32 option_slots;
 };
 
 struct group {
@@ -224,16 +231,169 @@ struct rule {
     bool skip;
 };
 
+/***====================================================================***/
+
+/*
+ * The compiled form of a rules file.
+ *
+ * The rule sets are kept in file order, but the rules of each set are
+ * indexed by their value at one position of the mapping (the one with
+ * the fewest wildcards), so that matching only needs to look at the rules
+ * which may match. Group names are resolved and expanded at compile time.
+ *
+ * Everything is kept in plain arrays which refer to each other by index,
+ * so that the db can be written to a cache file and read back as is.
+ */
+
+/* A NUL-terminated string in db->strings. */
+struct db_str {
+    uint32_t offset;
+    uint32_t len;
+};
+
+struct db_group {
+    struct db_str name;
+    /* Into db->group_elements. */
+    uint32_t first_element;
+    uint32_t num_elements;
+    /*
+     * Hash set of the elements; into db->group_slots. A slot holds an
+     * element index + 1, or 0 if empty.
+     */
+    uint32_t first_slot;
+    uint32_t num_slots;
+};
+
+struct db_mlvo_value {
+    uint32_t match_type;    /* enum mlvo_match_type */
+    struct db_str value;    /* MLVO_MATCH_NORMAL */
+    uint32_t group;         /* MLVO_MATCH_GROUP; into db->groups */
+};
+
+struct db_rule {
+    struct db_mlvo_value mlvo_value_at_pos[_MLVO_NUM_ENTRIES];
+    struct db_str kccgst_value_at_pos[_KCCGST_NUM_ENTRIES];
+    /* For error messages. */
+    uint32_t line, column;
+};
+
+struct db_bucket {
+    struct db_str key;
+    /* Into db->postings; an empty bucket has count 0. */
+    uint32_t first;
+    uint32_t count;
+};
+
+struct db_rule_set {
+    struct mapping mapping;
+    /* Into db->rules. */
+    uint32_t first_rule;
+    uint32_t num_rules;
+    /* The position in the mapping by which the rules are indexed. */
+    uint32_t index_pos;
+    /* Rules with a wildcard at index_pos; into db->postings. */
+    uint32_t first_wildcard;
+    uint32_t num_wildcards;
+    /* Hash table from the values at index_pos to rules; into db->buckets. */
+    uint32_t first_bucket;
+    uint32_t num_buckets;
+};
+
+struct rules_db {
+    /*
+     * The file the db was compiled from. For a file provided by the
+     * context's include_fn, the path is the file name and the mtime is
+     * a hash of the contents.
+     */
+    char *path;
+    bool provided;
+    int64_t mtime;
+    int64_t size;
+
+    darray_char strings;
+    darray(struct db_group) groups;
+    darray(struct db_str) group_elements;
+    darray_uint32 group_slots;
+    darray(struct db_rule_set) sets;
+    darray(struct db_rule) rules;
+    /* Lists of rule indices, in increasing order. */
+    darray_uint32 postings;
+    darray(struct db_bucket) buckets;
+};
+
+static struct sval
+db_sval(const struct rules_db *db, struct db_str str)
+{
+    struct sval val = { darray_mem(db->strings, str.offset), str.len };
+    return val;
+}
+
+static struct db_str
+db_add_string(struct rules_db *db, struct sval val)
+{
+    struct db_str str = { darray_size(db->strings), val.len };
+
+    if (val.len > 0)
+        darray_append_items(db->strings, val.start, val.len);
+    darray_append(db->strings, '\0');
+
+    return str;
+}
+
+static uint32_t
+db_hash(struct sval val)
+{
+    /* FNV-1a. */
+    uint32_t hash = 2166136261u;
+
+    for (unsigned i = 0; i < val.len; i++)
+        hash = (hash ^ (unsigned char) val.start[i]) * 16777619u;
+
+    return hash;
+}
+
+/*
+ * The number of slots in an open addressing hash table for @num entries,
+ * such that it always has some empty slots.
+ */
+static uint32_t
+hash_table_size(uint32_t num)
+{
+    uint32_t size = 1;
+
+    while (size < num * 2)
+        size <<= 1;
+
+    return size;
+}
+
+static void
+rules_db_free(struct rules_db *db)
+{
+    if (!db)
+        return;
+    free(db->path);
+    darray_free(db->strings);
+    darray_free(db->groups);
+    darray_free(db->group_elements);
+    darray_free(db->group_slots);
+    darray_free(db->sets);
+    darray_free(db->rules);
+    darray_free(db->postings);
+    darray_free(db->buckets);
+    free(db);
+}
+
+/***====================================================================***/
+
 /*
- * This is the main object used to match a given RMLVO against a rules
- * file and aggragate the results in a KcCGST. It goes through a simple
- * matching state machine, with tokens as transitions (see
- * matcher_match()).
+ * This is the main object used to compile a rules file into a rules_db.
+ * It goes through a simple parsing state machine, with tokens as
+ * transitions (see matcher_compile()).
  */
 struct matcher {
     struct xkb_context *ctx;
     /* Input.*/
-    struct rule_names rmlvo;
     union lvalue val;
     struct scanner scanner;
     darray(struct group) groups;
@@ -242,7 +402,7 @@ struct matcher {
     /* Current rule. */
     struct rule rule;
     /* Output. */
-    darray_char kccgst[_KCCGST_NUM_ENTRIES];
+    struct rules_db *db;
 };
 
 static struct sval
@@ -281,19 +441,14 @@ split_comma_separated_string(const char *s)
 }
 
 static struct matcher *
-matcher_new(struct xkb_context *ctx,
-            const struct xkb_rule_names *rmlvo)
+matcher_new(struct xkb_context *ctx, struct rules_db *db)
 {
     struct matcher *m = calloc(1, sizeof(*m));
     if (!m)
         return NULL;
 
     m->ctx = ctx;
-    m->rmlvo.model.start = rmlvo->model;
-    m->rmlvo.model.len = strlen_safe(rmlvo->model);
-    m->rmlvo.layouts = split_comma_separated_string(rmlvo->layout);
-    m->rmlvo.variants = split_comma_separated_string(rmlvo->variant);
-    m->rmlvo.options = split_comma_separated_string(rmlvo->options);
+    m->db = db;
 
     return m;
 }
@@ -304,9 +459,6 @@ matcher_free(struct matcher *m)
     struct group *group;
     if (!m)
         return;
-    darray_free(m->rmlvo.layouts);
-    darray_free(m->rmlvo.variants);
-    darray_free(m->rmlvo.options);
     darray_foreach(group, m->groups)
         darray_free(group->elements);
     darray_free(m->groups);
@@ -330,6 +482,19 @@ matcher_group_add_element(struct matcher *m, struct sval element)
                   element);
 }
 
+static bool
+matcher_find_group(struct matcher *m, struct sval name, uint32_t *idx_out)
+{
+    for (unsigned i = 0; i < darray_size(m->groups); i++) {
+        if (svaleq(darray_item(m->groups, i).name, name)) {
+            *idx_out = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
 static void
 matcher_mapping_start_new(struct matcher *m)
 {
@@ -359,7 +524,6 @@ extract_layout_index(const char *s, size_t max_len, xkb_layout_index_t *out)
     *out = s[1] - '0' - 1;
     return 3;
 }
-
 static void
 matcher_mapping_set_mlvo(struct matcher *m, struct sval ident)
 {
@@ -452,6 +616,7 @@ matcher_mapping_set_kccgst(struct matcher *m, struct sval ident)
     m->mapping.num_kccgst++;
 }
 
+
 static void
 matcher_mapping_verify(struct matcher *m)
 {
@@ -465,41 +630,23 @@ matcher_mapping_verify(struct matcher *m)
         goto skip;
     }
 
-    /*
-     * This following is very stupid, but this is how it works.
-     * See the "Notes" section in the overview above.
-     */
-
-    if (m->mapping.defined_mlvo_mask & (1u << MLVO_LAYOUT)) {
-        if (m->mapping.layout_idx == XKB_LAYOUT_INVALID) {
-            if (darray_size(m->rmlvo.layouts) > 1)
-                goto skip;
-        }
-        else {
-            if (darray_size(m->rmlvo.layouts) == 1 ||
-                m->mapping.layout_idx >= darray_size(m->rmlvo.layouts))
-                goto skip;
-        }
-    }
-
-    if (m->mapping.defined_mlvo_mask & (1u << MLVO_VARIANT)) {
-        if (m->mapping.variant_idx == XKB_LAYOUT_INVALID) {
-            if (darray_size(m->rmlvo.variants) > 1)
-                goto skip;
-        }
-        else {
-            if (darray_size(m->rmlvo.variants) == 1 ||
-                m->mapping.variant_idx >= darray_size(m->rmlvo.variants))
-                goto skip;
-        }
-    }
-
     return;
 
 skip:
     m->mapping.skip = true;
 }
 
+static void
+matcher_rule_set_start_new(struct matcher *m)
+{
+    struct db_rule_set set;
+
+    memset(&set, 0, sizeof(set));
+    set.mapping = m->mapping;
+    set.first_rule = darray_size(m->db->rules);
+    darray_append(m->db->sets, set);
+}
+
 static void
 matcher_rule_start_new(struct matcher *m)
 {
@@ -552,255 +699,242 @@ matcher_rule_set_kccgst(struct matcher *m, struct sval ident)
     m->rule.num_kccgst_values++;
 }
 
-static bool
-match_group(struct matcher *m, struct sval group_name, struct sval to)
-{
-    struct group *group;
-    struct sval *element;
-    bool found = false;
 
-    darray_foreach(group, m->groups) {
-        if (svaleq(group->name, group_name)) {
-            found = true;
-            break;
-        }
+static void
+matcher_rule_verify(struct matcher *m)
+{
+    if (m->rule.num_mlvo_values != m->mapping.num_mlvo ||
+        m->rule.num_kccgst_values != m->mapping.num_kccgst) {
+        matcher_err(m, "invalid rule: must have same number of values as mapping line; ignoring rule");
+        m->rule.skip = true;
     }
+}
+
+static void
+matcher_rule_add(struct matcher *m)
+{
+    struct rules_db *db = m->db;
+    struct db_rule rule;
+
+    memset(&rule, 0, sizeof(rule));
+    rule.line = m->scanner.token_line;
+    rule.column = m->scanner.token_column;
+
+    for (unsigned i = 0; i < m->rule.num_mlvo_values; i++) {
+        rule.mlvo_value_at_pos[i].match_type = m->rule.match_type_at_pos[i];
 
-    if (!found) {
         /*
          * rules/evdev intentionally uses some undeclared group names
          * in rules (e.g. commented group definitions which may be
-         * uncommented if needed). So we continue silently.
+         * uncommented if needed). Such rules can never match, so we
+         * drop them silently.
          */
-        return false;
+        if (m->rule.match_type_at_pos[i] == MLVO_MATCH_GROUP &&
+            !matcher_find_group(m, m->rule.mlvo_value_at_pos[i],
+                                &rule.mlvo_value_at_pos[i].group))
+            return;
     }
 
-    darray_foreach(element, group->elements)
-        if (svaleq(to, *element))
-            return true;
+    for (unsigned i = 0; i < m->rule.num_mlvo_values; i++)
+        if (m->rule.match_type_at_pos[i] == MLVO_MATCH_NORMAL)
+            rule.mlvo_value_at_pos[i].value =
+                db_add_string(db, m->rule.mlvo_value_at_pos[i]);
 
-    return false;
+    for (unsigned i = 0; i < m->rule.num_kccgst_values; i++)
+        rule.kccgst_value_at_pos[i] =
+            db_add_string(db, m->rule.kccgst_value_at_pos[i]);
+
+    darray_append(db->rules, rule);
+    darray_item(db->sets, darray_size(db->sets) - 1).num_rules++;
 }
 
-static bool
-match_value(struct matcher *m, struct sval val, struct sval to,
-          enum mlvo_match_type match_type)
+struct index_entry {
+    struct sval key;
+    struct db_str str;
+    uint32_t rule;
+};
+
+static int
+cmp_index_entries(const void *a, const void *b)
 {
-    if (match_type == MLVO_MATCH_WILDCARD)
-        return true;
-    if (match_type == MLVO_MATCH_GROUP)
-        return match_group(m, val, to);
-    return svaleq(val, to);
+    const struct index_entry *ea = a, *eb = b;
+    unsigned len = MIN(ea->key.len, eb->key.len);
+    int ret = (len > 0 ? memcmp(ea->key.start, eb->key.start, len) : 0);
+
+    if (ret != 0)
+        return ret;
+    if (ea->key.len != eb->key.len)
+        return ea->key.len < eb->key.len ? -1 : 1;
+    if (ea->rule != eb->rule)
+        return ea->rule < eb->rule ? -1 : 1;
+    return 0;
 }
 
-/*
- * This function performs %-expansion on @value (see overview above),
- * and appends the result to @to.
- */
-static bool
-append_expanded_kccgst_value(struct matcher *m, darray_char *to,
-                             struct sval value)
+static void
+rules_db_insert_bucket(struct rules_db *db, struct db_rule_set *set,
+                       const struct index_entry *entry,
+                       uint32_t first, uint32_t count)
 {
-    const char *s = value.start;
-    darray_char expanded = darray_new();
-    char ch;
-    bool expanded_plus, to_plus;
+    uint32_t mask = set->num_buckets - 1;
+    uint32_t pos = db_hash(entry->key) & mask;
+    struct db_bucket *bucket;
 
-    /*
-     * Some ugly hand-lexing here, but going through the scanner is more
-     * trouble than it's worth, and the format is ugly on its own merit.
-     */
-    for (unsigned i = 0; i < value.len; ) {
-        enum rules_mlvo mlv;
-        xkb_layout_index_t idx;
-        char pfx, sfx;
-        struct sval expanded_value;
-
-        /* Check if that's a start of an expansion. */
-        if (s[i] != '%') {
-            /* Just a normal character. */
-            darray_appends_nullterminate(expanded, &s[i++], 1);
-            continue;
-        }
-        if (++i >= value.len) goto error;
-
-        pfx = sfx = 0;
+    while (true) {
+        bucket = &darray_item(db->buckets, set->first_bucket + pos);
+        if (bucket->count == 0)
+            break;
+        pos = (pos + 1) & mask;
+    }
 
-        /* Check for prefix. */
-        if (s[i] == '(' || s[i] == '+' || s[i] == '|' ||
-            s[i] == '_' || s[i] == '-') {
-            pfx = s[i];
-            if (s[i] == '(') sfx = ')';
-            if (++i >= value.len) goto error;
-        }
+    bucket->key = entry->str;
+    bucket->first = first;
+    bucket->count = count;
+}
 
-        /* Mandatory model/layout/variant specifier. */
-        switch (s[i++]) {
-        case 'm': mlv = MLVO_MODEL; break;
-        case 'l': mlv = MLVO_LAYOUT; break;
-        case 'v': mlv = MLVO_VARIANT; break;
-        default: goto error;
+/*
+ * Index the rules of @set by their value at the position with the fewest
+ * wildcards. Rules which match a group are indexed under every element
+ * of the group.
+ */
+static void
+rules_db_index_rule_set(struct rules_db *db, struct db_rule_set *set)
+{
+    darray(struct index_entry) entries = darray_new();
+    struct index_entry *entry;
+    unsigned num_wildcards[_MLVO_NUM_ENTRIES] = { 0 };
+    unsigned num_keys = 0;
+    uint32_t r;
+
+    for (r = set->first_rule; r < set->first_rule + set->num_rules; r++)
+        for (unsigned i = 0; i < set->mapping.num_mlvo; i++)
+            if (darray_item(db->rules, r).mlvo_value_at_pos[i].match_type ==
+                MLVO_MATCH_WILDCARD)
+                num_wildcards[i]++;
+
+    set->index_pos = 0;
+    for (unsigned i = 1; i < set->mapping.num_mlvo; i++)
+        if (num_wildcards[i] < num_wildcards[set->index_pos])
+            set->index_pos = i;
+
+    set->first_wildcard = darray_size(db->postings);
+    set->num_wildcards = num_wildcards[set->index_pos];
+
+    for (r = set->first_rule; r < set->first_rule + set->num_rules; r++) {
+        const struct db_mlvo_value *value =
+            &darray_item(db->rules, r).mlvo_value_at_pos[set->index_pos];
+        struct index_entry new;
+
+        new.rule = r;
+
+        if (value->match_type == MLVO_MATCH_WILDCARD) {
+            darray_append(db->postings, r);
         }
-
-        /* Check for index. */
-        idx = XKB_LAYOUT_INVALID;
-        if (i < value.len && s[i] == '[') {
-            int consumed;
-
-            if (mlv != MLVO_LAYOUT && mlv != MLVO_VARIANT) {
-                matcher_err(m, "invalid index in %%-expansion; may only index layout or variant");
-                goto error;
+        else if (value->match_type == MLVO_MATCH_GROUP) {
+            const struct db_group *group =
+                &darray_item(db->groups, value->group);
+
+            for (uint32_t i = 0; i < group->num_elements; i++) {
+                new.str = darray_item(db->group_elements,
+                                      group->first_element + i);
+                new.key = db_sval(db, new.str);
+                darray_append(entries, new);
             }
-
-            consumed = extract_layout_index(s + i, value.len - i, &idx);
-            if (consumed == -1) goto error;
-            i += consumed;
         }
-
-        /* Check for suffix, if there supposed to be one. */
-        if (sfx != 0) {
-            if (i >= value.len) goto error;
-            if (s[i++] != sfx) goto error;
+        else {
+            new.str = value->value;
+            new.key = db_sval(db, new.str);
+            darray_append(entries, new);
         }
+    }
 
-        /* Get the expanded value. */
-        expanded_value.len = 0;
-
-        if (mlv == MLVO_LAYOUT) {
-            if (idx != XKB_LAYOUT_INVALID &&
-                idx < darray_size(m->rmlvo.layouts) &&
-                darray_size(m->rmlvo.layouts) > 1)
-                expanded_value = darray_item(m->rmlvo.layouts, idx);
-            else if (idx == XKB_LAYOUT_INVALID &&
-                     darray_size(m->rmlvo.layouts) == 1)
-                expanded_value = darray_item(m->rmlvo.layouts, 0);
-        }
-        else if (mlv == MLVO_VARIANT) {
-            if (idx != XKB_LAYOUT_INVALID &&
-                idx < darray_size(m->rmlvo.variants) &&
-                darray_size(m->rmlvo.variants) > 1)
-                expanded_value = darray_item(m->rmlvo.variants, idx);
-            else if (idx == XKB_LAYOUT_INVALID &&
-                     darray_size(m->rmlvo.variants) == 1)
-                expanded_value = darray_item(m->rmlvo.variants, 0);
-        }
-        else if (mlv == MLVO_MODEL) {
-            expanded_value = m->rmlvo.model;
+    if (darray_empty(entries))
+        goto out;
+
+    qsort(darray_mem(entries, 0), darray_size(entries),
+          sizeof(struct index_entry), cmp_index_entries);
+
+    darray_foreach(entry, entries)
+        if (entry == &darray_item(entries, 0) ||
+            !svaleq(entry->key, entry[-1].key))
+            num_keys++;
+
+    set->first_bucket = darray_size(db->buckets);
+    set->num_buckets = hash_table_size(num_keys);
+    darray_resize0(db->buckets, set->first_bucket + set->num_buckets);
+
+    for (unsigned i = 0; i < darray_size(entries); ) {
+        const struct index_entry *first = &darray_item(entries, i);
+        uint32_t first_posting = darray_size(db->postings);
+
+        for (; i < darray_size(entries); i++) {
+            entry = &darray_item(entries, i);
+            if (!svaleq(entry->key, first->key))
+                break;
+            /* A group may have the same element more than once. */
+            if (darray_size(db->postings) == first_posting ||
+                darray_item(db->postings,
+                            darray_size(db->postings) - 1) != entry->rule)
+                darray_append(db->postings, entry->rule);
         }
 
-        /* If we didn't get one, skip silently. */
-        if (expanded_value.len <= 0)
-            continue;
-
-        if (pfx != 0)
-            darray_appends_nullterminate(expanded, &pfx, 1);
-        darray_appends_nullterminate(expanded,
-                                     expanded_value.start, expanded_value.len);
-        if (sfx != 0)
-            darray_appends_nullterminate(expanded, &sfx, 1);
+        rules_db_insert_bucket(db, set, first, first_posting,
+                               darray_size(db->postings) - first_posting);
     }
 
-    /*
-     * Appending  bar to  foo ->  foo (not an error if this happens)
-     * Appending +bar to  foo ->  foo+bar
-     * Appending  bar to +foo ->  bar+foo
-     * Appending +bar to +foo -> +foo+bar
-     */
+out:
+    darray_free(entries);
+}
 
-    ch = (darray_empty(expanded) ? '\0' : darray_item(expanded, 0));
-    expanded_plus = (ch == '+' || ch == '|');
-    ch = (darray_empty(*to) ? '\0' : darray_item(*to, 0));
-    to_plus = (ch == '+' || ch == '|');
+static void
+matcher_finish(struct matcher *m)
+{
+    struct rules_db *db = m->db;
+    struct group *group;
+    struct db_rule_set *set;
+    struct sval *element;
+    uint32_t i;
 
-    if (expanded_plus || darray_empty(*to))
-        darray_appends_nullterminate(*to, expanded.item, expanded.size);
-    else if (to_plus)
-        darray_prepends_nullterminate(*to, expanded.item, expanded.size);
+    darray_foreach(group, m->groups) {
+        struct db_group new;
+
+        new.name = db_add_string(db, group->name);
+        new.first_element = darray_size(db->group_elements);
+        new.num_elements = darray_size(group->elements);
+        new.first_slot = darray_size(db->group_slots);
+        new.num_slots = hash_table_size(new.num_elements);
+        darray_resize0(db->group_slots, new.first_slot + new.num_slots);
+
+        darray_enumerate(i, element, group->elements) {
+            uint32_t mask = new.num_slots - 1;
+            uint32_t pos = db_hash(*element) & mask;
+            uint32_t *slot;
+
+            darray_append(db->group_elements, db_add_string(db, *element));
+
+            while (*(slot = &darray_item(db->group_slots,
+                                         new.first_slot + pos)) != 0)
+                pos = (pos + 1) & mask;
+            *slot = i + 1;
+        }
 
-    darray_free(expanded);
-    return true;
+        darray_append(db->groups, new);
+    }
 
-error:
-    darray_free(expanded);
-    matcher_err(m, "invalid %%-expansion in value; not used");
-    return false;
+    darray_foreach(set, db->sets)
+        rules_db_index_rule_set(db, set);
 }
 
-static void
-matcher_rule_verify(struct matcher *m)
+static enum rules_token
+gettok(struct matcher *m)
 {
-    if (m->rule.num_mlvo_values != m->mapping.num_mlvo ||
-        m->rule.num_kccgst_values != m->mapping.num_kccgst) {
-        matcher_err(m, "invalid rule: must have same number of values as mapping line; ignoring rule");
-        m->rule.skip = true;
-    }
+    return lex(&m->scanner, &m->val);
 }
 
-static void
-matcher_rule_apply_if_matches(struct matcher *m)
+static bool
+matcher_compile(struct matcher *m, const char *string, size_t len,
+                const char *file_name)
 {
-    for (unsigned i = 0; i < m->mapping.num_mlvo; i++) {
-        enum rules_mlvo mlvo = m->mapping.mlvo_at_pos[i];
-        struct sval value = m->rule.mlvo_value_at_pos[i];
-        enum mlvo_match_type match_type = m->rule.match_type_at_pos[i];
-        bool matched = false;
-
-        if (mlvo == MLVO_MODEL) {
-            matched = match_value(m, value, m->rmlvo.model, match_type);
-        }
-        else if (mlvo == MLVO_LAYOUT) {
-            xkb_layout_index_t idx = m->mapping.layout_idx;
-            idx = (idx == XKB_LAYOUT_INVALID ? 0 : idx);
-            matched = match_value(m, value,
-                                  darray_item(m->rmlvo.layouts, idx),
-                                  match_type);
-        }
-        else if (mlvo == MLVO_VARIANT) {
-            xkb_layout_index_t idx = m->mapping.layout_idx;
-            idx = (idx == XKB_LAYOUT_INVALID ? 0 : idx);
-            matched = match_value(m, value,
-                                  darray_item(m->rmlvo.variants, idx),
-                                  match_type);
-        }
-        else if (mlvo == MLVO_OPTION) {
-            struct sval *option;
-            darray_foreach(option, m->rmlvo.options) {
-                matched = match_value(m, value, *option, match_type);
-                if (matched)
-                    break;
-            }
-        }
-
-        if (!matched)
-            return;
-    }
-
-    for (unsigned i = 0; i < m->mapping.num_kccgst; i++) {
-        enum rules_kccgst kccgst = m->mapping.kccgst_at_pos[i];
-        struct sval value = m->rule.kccgst_value_at_pos[i];
-        append_expanded_kccgst_value(m, &m->kccgst[kccgst], value);
-    }
-
-    /*
-     * If a rule matches in a rule set, the rest of the set should be
-     * skipped. However, rule sets matching against options may contain
-     * several legitimate rules, so they are processed entirely.
-     */
-    if (!(m->mapping.defined_mlvo_mask & (1 << MLVO_OPTION)))
-        m->mapping.skip = true;
-}
-
-static enum rules_token
-gettok(struct matcher *m)
-{
-    return lex(&m->scanner, &m->val);
-}
-
-static bool
-matcher_match(struct matcher *m, const char *string, size_t len,
-              const char *file_name, struct xkb_component_names *out)
-{
-    enum rules_token tok;
+    enum rules_token tok;
 
     if (!m)
         return false;
@@ -872,6 +1006,8 @@ mapping_kccgst:
     case TOK_END_OF_LINE:
         if (!m->mapping.skip)
             matcher_mapping_verify(m);
+        if (!m->mapping.skip)
+            matcher_rule_set_start_new(m);
         goto rule_mlvo_first;
     default:
         goto unexpected;
@@ -922,7 +1058,7 @@ rule_kccgst:
         if (!m->rule.skip)
             matcher_rule_verify(m);
         if (!m->rule.skip)
-            matcher_rule_apply_if_matches(m);
+            matcher_rule_add(m);
         goto rule_mlvo_first;
     default:
         goto unexpected;
@@ -937,20 +1073,7 @@ unexpected:
     }
 
 finish:
-    if (darray_empty(m->kccgst[KCCGST_KEYCODES]) ||
-        darray_empty(m->kccgst[KCCGST_TYPES]) ||
-        darray_empty(m->kccgst[KCCGST_COMPAT]) ||
-        /* darray_empty(m->kccgst[KCCGST_GEOMETRY]) || */
-        darray_empty(m->kccgst[KCCGST_SYMBOLS]))
-        goto error;
-
-    out->keycodes = darray_mem(m->kccgst[KCCGST_KEYCODES], 0);
-    out->types = darray_mem(m->kccgst[KCCGST_TYPES], 0);
-    out->compat = darray_mem(m->kccgst[KCCGST_COMPAT], 0);
-    /* out->geometry = darray_mem(m->kccgst[KCCGST_GEOMETRY], 0); */
-    darray_free(m->kccgst[KCCGST_GEOMETRY]);
-    out->symbols = darray_mem(m->kccgst[KCCGST_SYMBOLS], 0);
-
+    matcher_finish(m);
     return true;
 
 state_error:
@@ -959,39 +1082,1139 @@ error:
     return false;
 }
 
-bool
-xkb_components_from_rules(struct xkb_context *ctx,
-                          const struct xkb_rule_names *rmlvo,
-                          struct xkb_component_names *out)
+/***====================================================================***/
+
+#define rule_err(ctx, db, rule, fmt, ...) \
+    log_err((ctx), "%s:%u:%u: " fmt "\n", (db)->path, \
+            (rule)->line, (rule)->column, ##__VA_ARGS__)
+
+/*
+ * This function performs %-expansion on @value (see overview above),
+ * and appends the result to @to.
+ */
+static bool
+append_expanded_kccgst_value(struct xkb_context *ctx,
+                             const struct rules_db *db,
+                             const struct db_rule *rule,
+                             const struct rule_names *rmlvo,
+                             darray_char *to, struct sval value)
+{
+    const char *s = value.start;
+    darray_char expanded = darray_new();
+    char ch;
+    bool expanded_plus, to_plus;
+
+    /*
+     * Some ugly hand-lexing here, but going through the scanner is more
+     * trouble than it's worth, and the format is ugly on its own merit.
+     */
+    for (unsigned i = 0; i < value.len; ) {
+        enum rules_mlvo mlv;
+        xkb_layout_index_t idx;
+        char pfx, sfx;
+        struct sval expanded_value;
+
+        /* Check if that's a start of an expansion. */
+        if (s[i] != '%') {
+            /* Just a normal character. */
+            darray_appends_nullterminate(expanded, &s[i++], 1);
+            continue;
+        }
+        if (++i >= value.len) goto error;
+
+        pfx = sfx = 0;
+
+        /* Check for prefix. */
+        if (s[i] == '(' || s[i] == '+' || s[i] == '|' ||
+            s[i] == '_' || s[i] == '-') {
+            pfx = s[i];
+            if (s[i] == '(') sfx = ')';
+            if (++i >= value.len) goto error;
+        }
+
+        /* Mandatory model/layout/variant specifier. */
+        switch (s[i++]) {
+        case 'm': mlv = MLVO_MODEL; break;
+        case 'l': mlv = MLVO_LAYOUT; break;
+        case 'v': mlv = MLVO_VARIANT; break;
+        default: goto error;
+        }
+
+        /* Check for index. */
+        idx = XKB_LAYOUT_INVALID;
+        if (i < value.len && s[i] == '[') {
+            int consumed;
+
+            if (mlv != MLVO_LAYOUT && mlv != MLVO_VARIANT) {
+                rule_err(ctx, db, rule, "invalid index in %%-expansion; may only index layout or variant");
+                goto error;
+            }
+
+            consumed = extract_layout_index(s + i, value.len - i, &idx);
+            if (consumed == -1) goto error;
+            i += consumed;
+        }
+
+        /* Check for suffix, if there supposed to be one. */
+        if (sfx != 0) {
+            if (i >= value.len) goto error;
+            if (s[i++] != sfx) goto error;
+        }
+
+        /* Get the expanded value. */
+        expanded_value.len = 0;
+
+        if (mlv == MLVO_LAYOUT) {
+            if (idx != XKB_LAYOUT_INVALID &&
+                idx < darray_size(rmlvo->layouts) &&
+                darray_size(rmlvo->layouts) > 1)
+                expanded_value = darray_item(rmlvo->layouts, idx);
+            else if (idx == XKB_LAYOUT_INVALID &&
+                     darray_size(rmlvo->layouts) == 1)
+                expanded_value = darray_item(rmlvo->layouts, 0);
+        }
+        else if (mlv == MLVO_VARIANT) {
+            if (idx != XKB_LAYOUT_INVALID &&
+                idx < darray_size(rmlvo->variants) &&
+                darray_size(rmlvo->variants) > 1)
+                expanded_value = darray_item(rmlvo->variants, idx);
+            else if (idx == XKB_LAYOUT_INVALID &&
+                     darray_size(rmlvo->variants) == 1)
+                expanded_value = darray_item(rmlvo->variants, 0);
+        }
+        else if (mlv == MLVO_MODEL) {
+            expanded_value = rmlvo->model;
+        }
+
+        /* If we didn't get one, skip silently. */
+        if (expanded_value.len <= 0)
+            continue;
+
+        if (pfx != 0)
+            darray_appends_nullterminate(expanded, &pfx, 1);
+        darray_appends_nullterminate(expanded,
+                                     expanded_value.start, expanded_value.len);
+        if (sfx != 0)
+            darray_appends_nullterminate(expanded, &sfx, 1);
+    }
+
+    /*
+     * Appending  bar to  foo ->  foo (not an error if this happens)
+     * Appending +bar to  foo ->  foo+bar
+     * Appending  bar to +foo ->  bar+foo
+     * Appending +bar to +foo -> +foo+bar
+     */
+
+    ch = (darray_empty(expanded) ? '\0' : darray_item(expanded, 0));
+    expanded_plus = (ch == '+' || ch == '|');
+    ch = (darray_empty(*to) ? '\0' : darray_item(*to, 0));
+    to_plus = (ch == '+' || ch == '|');
+
+    if (expanded_plus || darray_empty(*to))
+        darray_appends_nullterminate(*to, expanded.item, expanded.size);
+    else if (to_plus)
+        darray_prepends_nullterminate(*to, expanded.item, expanded.size);
+
+    darray_free(expanded);
+    return true;
+
+error:
+    darray_free(expanded);
+    rule_err(ctx, db, rule, "invalid %%-expansion in value; not used");
+    return false;
+}
+
+/*
+ * Whether the rules of the set apply to the given RMLVO at all.
+ * This following is very stupid, but this is how it works.
+ * See the "Notes" section in the overview above.
+ */
+static bool
+rule_set_applies(const struct mapping *mapping,
+                 const struct rule_names *rmlvo)
+{
+    if (mapping->defined_mlvo_mask & (1u << MLVO_LAYOUT)) {
+        if (mapping->layout_idx == XKB_LAYOUT_INVALID) {
+            if (darray_size(rmlvo->layouts) > 1)
+                return false;
+        }
+        else {
+            if (darray_size(rmlvo->layouts) == 1 ||
+                mapping->layout_idx >= darray_size(rmlvo->layouts))
+                return false;
+        }
+    }
+
+    if (mapping->defined_mlvo_mask & (1u << MLVO_VARIANT)) {
+        if (mapping->variant_idx == XKB_LAYOUT_INVALID) {
+            if (darray_size(rmlvo->variants) > 1)
+                return false;
+        }
+        else {
+            if (darray_size(rmlvo->variants) == 1 ||
+                mapping->variant_idx >= darray_size(rmlvo->variants))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/* The value a model, layout or variant position is matched against. */
+static struct sval
+rule_set_input(const struct mapping *mapping, enum rules_mlvo mlvo,
+               const struct rule_names *rmlvo)
+{
+    struct sval none = { NULL, 0 };
+    xkb_layout_index_t idx;
+
+    if (mlvo == MLVO_MODEL)
+        return rmlvo->model;
+
+    idx = mapping->layout_idx;
+    idx = (idx == XKB_LAYOUT_INVALID ? 0 : idx);
+
+    if (mlvo == MLVO_LAYOUT && idx < darray_size(rmlvo->layouts))
+        return darray_item(rmlvo->layouts, idx);
+    if (mlvo == MLVO_VARIANT && idx < darray_size(rmlvo->variants))
+        return darray_item(rmlvo->variants, idx);
+
+    return none;
+}
+
+static void
+hash_options(struct rule_names *rmlvo)
+{
+    uint32_t num_slots = hash_table_size(darray_size(rmlvo->options));
+    struct sval *option;
+    uint32_t i;
+
+    darray_resize0(rmlvo->option_slots, num_slots);
+
+    darray_enumerate(i, option, rmlvo->options) {
+        uint32_t pos = db_hash(*option) & (num_slots - 1);
+
+        while (darray_item(rmlvo->option_slots, pos) != 0)
+            pos = (pos + 1) & (num_slots - 1);
+        darray_item(rmlvo->option_slots, pos) = i + 1;
+    }
+}
+
+static bool
+has_option(const struct rule_names *rmlvo, struct sval option)
+{
+    uint32_t mask = darray_size(rmlvo->option_slots) - 1;
+    uint32_t pos = db_hash(option) & mask;
+    uint32_t slot;
+
+    while ((slot = darray_item(rmlvo->option_slots, pos)) != 0) {
+        if (svaleq(darray_item(rmlvo->options, slot - 1), option))
+            return true;
+        pos = (pos + 1) & mask;
+    }
+
+    return false;
+}
+
+static struct sval
+group_element(const struct rules_db *db, const struct db_group *group,
+              uint32_t idx)
+{
+    return db_sval(db, darray_item(db->group_elements,
+                                   group->first_element + idx));
+}
+
+static bool
+match_group(const struct rules_db *db, const struct db_group *group,
+            struct sval to)
+{
+    uint32_t mask = group->num_slots - 1;
+    uint32_t pos = db_hash(to) & mask;
+    uint32_t slot;
+
+    while ((slot = darray_item(db->group_slots,
+                               group->first_slot + pos)) != 0) {
+        if (svaleq(group_element(db, group, slot - 1), to))
+            return true;
+        pos = (pos + 1) & mask;
+    }
+
+    return false;
+}
+
+static bool
+match_value(const struct rules_db *db, const struct db_mlvo_value *value,
+            struct sval to)
+{
+    if (value->match_type == MLVO_MATCH_WILDCARD)
+        return true;
+    if (value->match_type == MLVO_MATCH_GROUP)
+        return match_group(db, &darray_item(db->groups, value->group), to);
+    return svaleq(db_sval(db, value->value), to);
+}
+
+/* Whether @value matches any of the options. */
+static bool
+match_options(const struct rules_db *db, const struct db_mlvo_value *value,
+              const struct rule_names *rmlvo)
+{
+    const struct db_group *group;
+    struct sval *option;
+
+    if (value->match_type == MLVO_MATCH_WILDCARD)
+        return true;
+    if (value->match_type == MLVO_MATCH_NORMAL)
+        return has_option(rmlvo, db_sval(db, value->value));
+
+    /* Probe the bigger set with the elements of the smaller one. */
+    group = &darray_item(db->groups, value->group);
+    if (group->num_elements < darray_size(rmlvo->options)) {
+        for (uint32_t i = 0; i < group->num_elements; i++)
+            if (has_option(rmlvo, group_element(db, group, i)))
+                return true;
+    }
+    else {
+        darray_foreach(option, rmlvo->options)
+            if (match_group(db, group, *option))
+                return true;
+    }
+
+    return false;
+}
+
+static bool
+rule_matches(const struct rules_db *db, const struct db_rule_set *set,
+             const struct db_rule *rule, const struct rule_names *rmlvo)
+{
+    for (unsigned i = 0; i < set->mapping.num_mlvo; i++) {
+        enum rules_mlvo mlvo = set->mapping.mlvo_at_pos[i];
+        const struct db_mlvo_value *value = &rule->mlvo_value_at_pos[i];
+        bool matched = false;
+
+        if (mlvo == MLVO_OPTION)
+            matched = match_options(db, value, rmlvo);
+        else
+            matched = match_value(db, value,
+                                  rule_set_input(&set->mapping, mlvo, rmlvo));
+
+        if (!matched)
+            return false;
+    }
+
+    return true;
+}
+
+static const struct db_bucket *
+rule_set_lookup(const struct rules_db *db, const struct db_rule_set *set,
+                struct sval key)
+{
+    uint32_t mask, pos;
+
+    if (set->num_buckets == 0)
+        return NULL;
+
+    mask = set->num_buckets - 1;
+    pos = db_hash(key) & mask;
+
+    while (true) {
+        const struct db_bucket *bucket =
+            &darray_item(db->buckets, set->first_bucket + pos);
+
+        if (bucket->count == 0)
+            return NULL;
+        if (svaleq(db_sval(db, bucket->key), key))
+            return bucket;
+
+        pos = (pos + 1) & mask;
+    }
+}
+
+static int
+cmp_uint32(const void *a, const void *b)
+{
+    uint32_t ua = *(const uint32_t *) a, ub = *(const uint32_t *) b;
+    return ua < ub ? -1 : ua > ub;
+}
+
+/*
+ * Get the rules of @set which may match @rmlvo, in file order: those
+ * indexed under the input value(s), and those with a wildcard.
+ */
+static void
+rule_set_get_candidates(const struct rules_db *db,
+                        const struct db_rule_set *set,
+                        const struct rule_names *rmlvo,
+                        darray_uint32 *candidates)
+{
+    enum rules_mlvo mlvo = set->mapping.mlvo_at_pos[set->index_pos];
+    const struct db_bucket *bucket;
+    unsigned num_sources = 0;
+
+    darray_resize(*candidates, 0);
+
+    if (mlvo == MLVO_OPTION) {
+        struct sval *option;
+        darray_foreach(option, rmlvo->options) {
+            bucket = rule_set_lookup(db, set, *option);
+            if (bucket) {
+                darray_append_items(*candidates,
+                                    darray_mem(db->postings, bucket->first),
+                                    bucket->count);
+                num_sources++;
+            }
+        }
+    }
+    else {
+        bucket = rule_set_lookup(db, set,
+                                 rule_set_input(&set->mapping, mlvo, rmlvo));
+        if (bucket) {
+            darray_append_items(*candidates,
+                                darray_mem(db->postings, bucket->first),
+                                bucket->count);
+            num_sources++;
+        }
+    }
+
+    if (set->num_wildcards > 0) {
+        darray_append_items(*candidates,
+                            darray_mem(db->postings, set->first_wildcard),
+                            set->num_wildcards);
+        num_sources++;
+    }
+
+    /* Each list is sorted, but they need to be merged. */
+    if (num_sources > 1) {
+        uint32_t *item, *out;
+
+        qsort(darray_mem(*candidates, 0), darray_size(*candidates),
+              sizeof(uint32_t), cmp_uint32);
+
+        out = darray_mem(*candidates, 0);
+        darray_foreach(item, *candidates)
+            if (out == darray_mem(*candidates, 0) || *item != out[-1])
+                *out++ = *item;
+        darray_resize(*candidates, out - darray_mem(*candidates, 0));
+    }
+}
+
+static bool
+rules_db_match(struct xkb_context *ctx, const struct rules_db *db,
+               const struct xkb_rule_names *names,
+               struct xkb_component_names *out)
 {
+    struct rule_names rmlvo;
+    darray_char kccgst[_KCCGST_NUM_ENTRIES];
+    darray_uint32 candidates = darray_new();
+    const struct db_rule_set *set;
+    uint32_t *idx;
     bool ret = false;
+
+    rmlvo.model.start = names->model;
+    rmlvo.model.len = strlen_safe(names->model);
+    rmlvo.layouts = split_comma_separated_string(names->layout);
+    rmlvo.variants = split_comma_separated_string(names->variant);
+    rmlvo.options = split_comma_separated_string(names->options);
+    darray_init(rmlvo.option_slots);
+    hash_options(&rmlvo);
+    for (unsigned i = 0; i < _KCCGST_NUM_ENTRIES; i++)
+        darray_init(kccgst[i]);
+
+    darray_foreach(set, db->sets) {
+        if (!rule_set_applies(&set->mapping, &rmlvo))
+            continue;
+
+        rule_set_get_candidates(db, set, &rmlvo, &candidates);
+
+        darray_foreach(idx, candidates) {
+            const struct db_rule *rule = &darray_item(db->rules, *idx);
+
+            if (!rule_matches(db, set, rule, &rmlvo))
+                continue;
+
+            for (unsigned i = 0; i < set->mapping.num_kccgst; i++) {
+                enum rules_kccgst type = set->mapping.kccgst_at_pos[i];
+                struct sval value =
+                    db_sval(db, rule->kccgst_value_at_pos[i]);
+                append_expanded_kccgst_value(ctx, db, rule, &rmlvo,
+                                             &kccgst[type], value);
+            }
+
+            /*
+             * If a rule matches in a rule set, the rest of the set should
+             * be skipped. However, rule sets matching against options may
+             * contain several legitimate rules, so they are processed
+             * entirely.
+             */
+            if (!(set->mapping.defined_mlvo_mask & (1 << MLVO_OPTION)))
+                break;
+        }
+    }
+
+    if (darray_empty(kccgst[KCCGST_KEYCODES]) ||
+        darray_empty(kccgst[KCCGST_TYPES]) ||
+        darray_empty(kccgst[KCCGST_COMPAT]) ||
+        /* darray_empty(kccgst[KCCGST_GEOMETRY]) || */
+        darray_empty(kccgst[KCCGST_SYMBOLS])) {
+        for (unsigned i = 0; i < _KCCGST_NUM_ENTRIES; i++)
+            darray_free(kccgst[i]);
+        goto out;
+    }
+
+    out->keycodes = darray_mem(kccgst[KCCGST_KEYCODES], 0);
+    out->types = darray_mem(kccgst[KCCGST_TYPES], 0);
+    out->compat = darray_mem(kccgst[KCCGST_COMPAT], 0);
+    /* out->geometry = darray_mem(kccgst[KCCGST_GEOMETRY], 0); */
+    darray_free(kccgst[KCCGST_GEOMETRY]);
+    out->symbols = darray_mem(kccgst[KCCGST_SYMBOLS], 0);
+    ret = true;
+
+out:
+    darray_free(candidates);
+    darray_free(rmlvo.layouts);
+    darray_free(rmlvo.variants);
+    darray_free(rmlvo.options);
+    darray_free(rmlvo.option_slots);
+    return ret;
+}
+
+/***====================================================================***/
+
+/*
+ * Compiled rules files may also be cached on disk, in the directory named
+ * by the XKB_RULES_CACHE_DIR environment variable. A cache file is a
+ * header followed by the path of the rules file and the db arrays, and is
+ * only used if the rules file did not change since it was written.
+ */
+
+#define RULES_CACHE_MAGIC "xkbrules"
+#define RULES_CACHE_VERSION 2
+
+struct rules_cache_header {
+    char magic[8];
+    uint32_t version;
+    /* Make sure the cache was written by a compatible build. */
+    uint32_t sizeof_rule_set;
+    uint32_t sizeof_rule;
+    uint32_t sizeof_bucket;
+    int64_t mtime;
+    int64_t size;
+    uint32_t path_len;
+    uint32_t num_strings;
+    uint32_t num_groups;
+    uint32_t num_group_elements;
+    uint32_t num_group_slots;
+    uint32_t num_sets;
+    uint32_t num_rules;
+    uint32_t num_postings;
+    uint32_t num_buckets;
+};
+
+static char *
+rules_cache_get_path(const char *cache_dir, const char *path)
+{
+    const char *base = strrchr(path, '/');
+    struct sval val = { path, strlen(path) };
+    char *cache_path;
+
+    base = (base ? base + 1 : path);
+    if (asprintf(&cache_path, "%s/%s-%08x.cache",
+                 cache_dir, base, db_hash(val)) < 0)
+        return NULL;
+
+    return cache_path;
+}
+
+static bool
+db_str_valid(const struct rules_db *db, struct db_str str)
+{
+    return str.offset < darray_size(db->strings) &&
+           str.len < darray_size(db->strings) - str.offset &&
+           darray_item(db->strings, str.offset + str.len) == '\0';
+}
+
+static bool
+db_range_valid(uint32_t first, uint32_t count, size_t size)
+{
+    return first <= size && count <= size - first;
+}
+
+/* Don't trust anything read from a cache file. */
+static bool
+rules_db_validate(const struct rules_db *db)
+{
+    const struct db_group *group;
+    const struct db_str *str;
+    const struct db_rule_set *set;
+    const struct db_rule *rule;
+    const struct db_bucket *bucket;
+    const uint32_t *posting;
+    uint32_t num_used;
+
+    darray_foreach(group, db->groups) {
+        if (!db_str_valid(db, group->name) ||
+            !db_range_valid(group->first_element, group->num_elements,
+                            darray_size(db->group_elements)) ||
+            !db_range_valid(group->first_slot, group->num_slots,
+                            darray_size(db->group_slots)) ||
+            group->num_slots != hash_table_size(group->num_elements))
+            return false;
+
+        /* Lookups stop at the first empty slot; there must be one. */
+        num_used = 0;
+        for (uint32_t i = 0; i < group->num_slots; i++) {
+            uint32_t slot = darray_item(db->group_slots,
+                                        group->first_slot + i);
+            if (slot > group->num_elements)
+                return false;
+            if (slot != 0)
+                num_used++;
+        }
+        if (num_used >= group->num_slots)
+            return false;
+    }
+
+    darray_foreach(str, db->group_elements)
+        if (!db_str_valid(db, *str))
+            return false;
+
+    darray_foreach(posting, db->postings)
+        if (*posting >= darray_size(db->rules))
+            return false;
+
+    darray_foreach(bucket, db->buckets)
+        if (bucket->count > 0 &&
+            (!db_str_valid(db, bucket->key) ||
+             !db_range_valid(bucket->first, bucket->count,
+                             darray_size(db->postings))))
+            return false;
+
+    darray_foreach(set, db->sets) {
+        const struct mapping *mapping = &set->mapping;
+
+        if (mapping->num_mlvo == 0 ||
+            mapping->num_mlvo > _MLVO_NUM_ENTRIES ||
+            mapping->num_kccgst == 0 ||
+            mapping->num_kccgst > _KCCGST_NUM_ENTRIES ||
+            set->index_pos >= mapping->num_mlvo ||
+            !db_range_valid(set->first_rule, set->num_rules,
+                            darray_size(db->rules)) ||
+            !db_range_valid(set->first_wildcard, set->num_wildcards,
+                            darray_size(db->postings)) ||
+            !db_range_valid(set->first_bucket, set->num_buckets,
+                            darray_size(db->buckets)) ||
+            (set->num_buckets & (set->num_buckets - 1)) != 0)
+            return false;
+
+        num_used = 0;
+        for (uint32_t i = 0; i < set->num_buckets; i++)
+            if (darray_item(db->buckets, set->first_bucket + i).count > 0)
+                num_used++;
+        if (set->num_buckets > 0 && num_used >= set->num_buckets)
+            return false;
+
+        for (unsigned i = 0; i < mapping->num_mlvo; i++)
+            if (mapping->mlvo_at_pos[i] < 0 ||
+                mapping->mlvo_at_pos[i] >= _MLVO_NUM_ENTRIES)
+                return false;
+
+        for (unsigned i = 0; i < mapping->num_kccgst; i++)
+            if (mapping->kccgst_at_pos[i] < 0 ||
+                mapping->kccgst_at_pos[i] >= _KCCGST_NUM_ENTRIES)
+                return false;
+
+        for (uint32_t r = set->first_rule;
+             r < set->first_rule + set->num_rules; r++) {
+            rule = &darray_item(db->rules, r);
+
+            for (unsigned i = 0; i < mapping->num_mlvo; i++) {
+                const struct db_mlvo_value *value =
+                    &rule->mlvo_value_at_pos[i];
+
+                if (value->match_type == MLVO_MATCH_NORMAL) {
+                    if (!db_str_valid(db, value->value))
+                        return false;
+                }
+                else if (value->match_type == MLVO_MATCH_GROUP) {
+                    if (value->group >= darray_size(db->groups))
+                        return false;
+                }
+                else if (value->match_type != MLVO_MATCH_WILDCARD) {
+                    return false;
+                }
+            }
+
+            for (unsigned i = 0; i < mapping->num_kccgst; i++)
+                if (!db_str_valid(db, rule->kccgst_value_at_pos[i]))
+                    return false;
+        }
+    }
+
+    return true;
+}
+
+static bool
+read_items(const char **pos, const char *end, void *to, size_t size)
+{
+    if (size > (size_t) (end - *pos))
+        return false;
+    if (size > 0)
+        memcpy(to, *pos, size);
+    *pos += size;
+    return true;
+}
+
+#define read_darray(pos, end, arr) \
+    read_items((pos), (end), (arr).item, darray_size(arr) * sizeof(*(arr).item))
+
+static struct rules_db *
+rules_db_read_cache(struct xkb_context *ctx, const char *cache_path,
+                    const char *path, int64_t mtime, int64_t size)
+{
     FILE *file;
-    char *path;
-    const char *string;
-    size_t size;
-    struct matcher *matcher;
+    const char *string, *pos, *end;
+    size_t string_size;
+    struct rules_cache_header header;
+    struct rules_db *db = NULL;
+    bool ok;
 
-    file = FindFileInXkbPath(ctx, rmlvo->rules, FILE_TYPE_RULES, &path);
+    file = fopen(cache_path, "rb");
     if (!file)
-        goto err_out;
+        return NULL;
 
-    ret = map_file(file, &string, &size);
-    if (!ret) {
-        log_err(ctx, "Couldn't read rules file \"%s\": %s\n",
-                path, strerror(errno));
+    if (!map_file(file, &string, &string_size))
         goto err_file;
+
+    pos = string;
+    end = string + string_size;
+
+    if (!read_items(&pos, end, &header, sizeof(header)) ||
+        memcmp(header.magic, RULES_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != RULES_CACHE_VERSION ||
+        header.sizeof_rule_set != sizeof(struct db_rule_set) ||
+        header.sizeof_rule != sizeof(struct db_rule) ||
+        header.sizeof_bucket != sizeof(struct db_bucket) ||
+        header.mtime != mtime || header.size != size ||
+        header.path_len != strlen(path) ||
+        header.path_len > (size_t) (end - pos) ||
+        memcmp(pos, path, header.path_len) != 0)
+        goto err_map;
+    pos += header.path_len;
+
+    db = calloc(1, sizeof(*db));
+    if (!db)
+        goto err_map;
+
+    /* Check the sizes before allocating anything. */
+    ok = (uint64_t) (end - pos) ==
+         (uint64_t) header.num_strings * sizeof(*db->strings.item) +
+         (uint64_t) header.num_groups * sizeof(*db->groups.item) +
+         (uint64_t) header.num_group_elements *
+             sizeof(*db->group_elements.item) +
+         (uint64_t) header.num_group_slots * sizeof(*db->group_slots.item) +
+         (uint64_t) header.num_sets * sizeof(*db->sets.item) +
+         (uint64_t) header.num_rules * sizeof(*db->rules.item) +
+         (uint64_t) header.num_postings * sizeof(*db->postings.item) +
+         (uint64_t) header.num_buckets * sizeof(*db->buckets.item);
+    if (ok) {
+        darray_resize(db->strings, header.num_strings);
+        darray_resize(db->groups, header.num_groups);
+        darray_resize(db->group_elements, header.num_group_elements);
+        darray_resize(db->group_slots, header.num_group_slots);
+        darray_resize(db->sets, header.num_sets);
+        darray_resize(db->rules, header.num_rules);
+        darray_resize(db->postings, header.num_postings);
+        darray_resize(db->buckets, header.num_buckets);
+
+        ok = read_darray(&pos, end, db->strings) &&
+             read_darray(&pos, end, db->groups) &&
+             read_darray(&pos, end, db->group_elements) &&
+             read_darray(&pos, end, db->group_slots) &&
+             read_darray(&pos, end, db->sets) &&
+             read_darray(&pos, end, db->rules) &&
+             read_darray(&pos, end, db->postings) &&
+             read_darray(&pos, end, db->buckets) &&
+             rules_db_validate(db);
+    }
+    if (!ok) {
+        log_warn(ctx, "Ignoring invalid rules cache file \"%s\"\n",
+                 cache_path);
+        rules_db_free(db);
+        db = NULL;
+        goto err_map;
     }
 
-    matcher = matcher_new(ctx, rmlvo);
-    ret = matcher_match(matcher, string, size, path, out);
-    if (!ret)
-        log_err(ctx, "No components returned from XKB rules \"%s\"\n", path);
-    matcher_free(matcher);
+    log_dbg(ctx, "Read compiled rules \"%s\" from cache file \"%s\"\n",
+            path, cache_path);
 
-    unmap_file(string, size);
+err_map:
+    unmap_file(string, string_size);
 err_file:
-    free(path);
     fclose(file);
-err_out:
-    return ret;
+    return db;
+}
+
+static bool
+write_items(FILE *file, const void *items, size_t size)
+{
+    return size == 0 || fwrite(items, size, 1, file) == 1;
+}
+
+#define write_darray(file, arr) \
+    write_items((file), (arr).item, darray_size(arr) * sizeof(*(arr).item))
+
+static void
+rules_db_write_cache(struct xkb_context *ctx, const struct rules_db *db,
+                     const char *cache_path)
+{
+    struct rules_cache_header header;
+    char *tmp_path;
+    int fd;
+    FILE *file;
+    bool ok;
+
+    if (asprintf(&tmp_path, "%s.XXXXXX", cache_path) < 0)
+        return;
+
+    fd = mkstemp(tmp_path);
+    if (fd < 0)
+        goto err_path;
+
+    file = fdopen(fd, "wb");
+    if (!file) {
+        close(fd);
+        goto err_unlink;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RULES_CACHE_MAGIC, sizeof(header.magic));
+    header.version = RULES_CACHE_VERSION;
+    header.sizeof_rule_set = sizeof(struct db_rule_set);
+    header.sizeof_rule = sizeof(struct db_rule);
+    header.sizeof_bucket = sizeof(struct db_bucket);
+    header.mtime = db->mtime;
+    header.size = db->size;
+    header.path_len = strlen(db->path);
+    header.num_strings = darray_size(db->strings);
+    header.num_groups = darray_size(db->groups);
+    header.num_group_elements = darray_size(db->group_elements);
+    header.num_group_slots = darray_size(db->group_slots);
+    header.num_sets = darray_size(db->sets);
+    header.num_rules = darray_size(db->rules);
+    header.num_postings = darray_size(db->postings);
+    header.num_buckets = darray_size(db->buckets);
+
+    ok = write_items(file, &header, sizeof(header)) &&
+         write_items(file, db->path, header.path_len) &&
+         write_darray(file, db->strings) &&
+         write_darray(file, db->groups) &&
+         write_darray(file, db->group_elements) &&
+         write_darray(file, db->group_slots) &&
+         write_darray(file, db->sets) &&
+         write_darray(file, db->rules) &&
+         write_darray(file, db->postings) &&
+         write_darray(file, db->buckets);
+    ok = (fclose(file) == 0) && ok;
+
+    if (!ok || rename(tmp_path, cache_path) != 0) {
+        log_warn(ctx, "Couldn't write rules cache file \"%s\": %s\n",
+                 cache_path, strerror(errno));
+        goto err_unlink;
+    }
+
+    free(tmp_path);
+    return;
+
+err_unlink:
+    unlink(tmp_path);
+err_path:
+    free(tmp_path);
+}
+
+static struct rules_db *
+rules_db_compile(struct xkb_context *ctx, const char *string, size_t size,
+                 const char *path)
+{
+    struct rules_db *db;
+    struct matcher *matcher;
+    bool ok;
+
+    db = calloc(1, sizeof(*db));
+    matcher = (db ? matcher_new(ctx, db) : NULL);
+    ok = matcher_compile(matcher, string, size, path);
+    matcher_free(matcher);
+
+    if (!ok) {
+        rules_db_free(db);
+        return NULL;
+    }
+
+    return db;
+}
+
+/* Find a db compiled with this context, dropping it if it is stale. */
+static struct rules_db *
+rules_db_find(struct xkb_context *ctx, const char *path, bool provided,
+              int64_t mtime, int64_t size)
+{
+    struct rules_db **cached;
+
+    darray_foreach(cached, ctx->rules_dbs) {
+        if ((*cached)->provided != provided || !streq((*cached)->path, path))
+            continue;
+
+        if ((*cached)->mtime == mtime && (*cached)->size == size)
+            return *cached;
+
+        /* The file was modified; replace the stale db. */
+        rules_db_free(*cached);
+        *cached = darray_item(ctx->rules_dbs,
+                              darray_size(ctx->rules_dbs) - 1);
+        darray_resize(ctx->rules_dbs, darray_size(ctx->rules_dbs) - 1);
+        break;
+    }
+
+    return NULL;
+}
+
+static struct rules_db *
+rules_db_add(struct xkb_context *ctx, struct rules_db *db, const char *path,
+             bool provided, int64_t mtime, int64_t size)
+{
+    db->provided = provided;
+    db->mtime = mtime;
+    db->size = size;
+    db->path = strdup(path);
+    if (!db->path) {
+        rules_db_free(db);
+        return NULL;
+    }
+
+    darray_append(ctx->rules_dbs, db);
+    return db;
+}
+
+/*
+ * Get the compiled form of the rules file, from the context if it was
+ * already compiled, else from the disk cache, else by compiling it.
+ */
+static struct rules_db *
+rules_db_get(struct xkb_context *ctx, FILE *file, const char *path)
+{
+    struct stat stat_buf;
+    struct rules_db *db;
+    const char *cache_dir;
+    char *cache_path = NULL;
+    bool write_cache = false;
+    const char *string;
+    size_t size;
+
+    if (fstat(fileno(file), &stat_buf) != 0) {
+        log_err(ctx, "Couldn't stat rules file \"%s\": %s\n",
+                path, strerror(errno));
+        return NULL;
+    }
+
+    db = rules_db_find(ctx, path, false, stat_buf.st_mtime, stat_buf.st_size);
+    if (db)
+        return db;
+
+    cache_dir = secure_getenv("XKB_RULES_CACHE_DIR");
+    if (cache_dir && cache_dir[0] != '\0')
+        cache_path = rules_cache_get_path(cache_dir, path);
+
+    if (cache_path)
+        db = rules_db_read_cache(ctx, cache_path, path,
+                                 stat_buf.st_mtime, stat_buf.st_size);
+
+    if (!db) {
+        if (!map_file(file, &string, &size)) {
+            log_err(ctx, "Couldn't read rules file \"%s\": %s\n",
+                    path, strerror(errno));
+            goto out;
+        }
+
+        db = rules_db_compile(ctx, string, size, path);
+        unmap_file(string, size);
+        if (!db)
+            goto out;
+
+        write_cache = (cache_path != NULL);
+    }
+
+    db = rules_db_add(ctx, db, path, false,
+                      stat_buf.st_mtime, stat_buf.st_size);
+
+    if (db && write_cache)
+        rules_db_write_cache(ctx, db, cache_path);
+
+out:
+    free(cache_path);
+    return db;
+}
+
+/* Like rules_db_get(), for a rules file provided by the include_fn. */
+static struct rules_db *
+rules_db_get_provided(struct xkb_context *ctx, const char *name,
+                      const char *string, size_t size)
+{
+    /* FNV-1a, 64 bit. */
+    uint64_t hash = 14695981039346656037u;
+    struct rules_db *db;
+
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ (unsigned char) string[i]) * 1099511628211u;
+
+    db = rules_db_find(ctx, name, true, (int64_t) hash, size);
+    if (db)
+        return db;
+
+    db = rules_db_compile(ctx, string, size, name);
+    if (!db)
+        return NULL;
+
+    return rules_db_add(ctx, db, name, true, (int64_t) hash, size);
+}
+
+/*
+ * Like rules_db_get(), for a rules file in a packed archive. The archive
+ * is already mapped, so there is no point in the disk cache.
+ */
+static struct rules_db *
+rules_db_get_archived(struct xkb_context *ctx, const char *path,
+                      const struct xkb_file_source *src)
+{
+    struct rules_db *db;
+
+    db = rules_db_find(ctx, path, false, src->archive_mtime, src->len);
+    if (db)
+        return db;
+
+    db = rules_db_compile(ctx, src->string, src->len, path);
+    if (!db)
+        return NULL;
+
+    return rules_db_add(ctx, db, path, false, src->archive_mtime, src->len);
+}
+
+void
+xkb_context_clear_rules_cache(struct xkb_context *ctx)
+{
+    struct rules_db **db;
+
+    darray_foreach(db, ctx->rules_dbs)
+        rules_db_free(*db);
+    darray_free(ctx->rules_dbs);
+}
+
+/*
+ * Find the rules file @rules and get its compiled form. Must be called
+ * with the context locked.
+ */
+static const struct rules_db *
+rules_db_lookup(struct xkb_context *ctx, const char *rules, char **path_out)
+{
+    struct xkb_file_source src;
+    const char *string;
+    size_t size;
+    const struct rules_db *db;
+
+    *path_out = NULL;
+
+    if (GetProvidedFile(ctx, rules, FILE_TYPE_RULES, &string, &size)) {
+        *path_out = strdup(rules);
+        if (!*path_out)
+            return NULL;
+        return rules_db_get_provided(ctx, rules, string, size);
+    }
+
+    if (!FindFileInXkbPath(ctx, rules, FILE_TYPE_RULES, path_out, &src))
+        return NULL;
+
+    if (!src.file)
+        return rules_db_get_archived(ctx, *path_out, &src);
+
+    db = rules_db_get(ctx, src.file, *path_out);
+    CloseXkbFileSource(&src);
+    return db;
+}
+
+bool
+xkb_components_from_rules(struct xkb_context *ctx,
+                          const struct xkb_rule_names *rmlvo,
+                          struct xkb_component_names *out)
+{
+    return xkb_components_from_rules_batch(ctx, rmlvo, 1, out) == 1;
+}
+
+size_t
+xkb_components_from_rules_batch(struct xkb_context *ctx,
+                                const struct xkb_rule_names *rmlvo,
+                                size_t num,
+                                struct xkb_component_names *out)
+{
+    const char *rules = NULL;
+    char *path = NULL;
+    const struct rules_db *db = NULL;
+    size_t num_resolved = 0;
+
+    /* For the compiled rules files. */
+    xkb_context_lock(ctx);
+
+    for (size_t i = 0; i < num; i++) {
+        memset(&out[i], 0, sizeof(out[i]));
+
+        /* Consecutive names usually share the rules file. */
+        if (i == 0 || !streq_not_null(rules, rmlvo[i].rules)) {
+            free(path);
+            rules = rmlvo[i].rules;
+            db = rules_db_lookup(ctx, rules, &path);
+        }
+
+        if (!db)
+            continue;
+
+        if (rules_db_match(ctx, db, &rmlvo[i], &out[i]))
+            num_resolved++;
+        else
+            log_err(ctx, "No components returned from XKB rules \"%s\"\n",
+                    path);
+    }
+
+    xkb_context_unlock(ctx);
+
+    free(path);
+    return num_resolved;
+}
+
+XKB_EXPORT size_t
+xkb_context_resolve_rule_names(struct xkb_context *ctx,
+                               const struct xkb_rule_names *names,
+                               size_t num_names,
+                               struct xkb_component_names *components_out)
+{
+    struct xkb_rule_names *rmlvo;
+    size_t num_resolved;
+
+    if (num_names == 0)
+        return 0;
+
+    rmlvo = calloc(num_names, sizeof(*rmlvo));
+    if (!rmlvo) {
+        log_err_func1(ctx, "couldn't allocate the names\n");
+        memset(components_out, 0, num_names * sizeof(*components_out));
+        return 0;
+    }
+
+    for (size_t i = 0; i < num_names; i++) {
+        rmlvo[i] = names[i];
+        xkb_context_sanitize_rule_names(ctx, &rmlvo[i]);
+    }
+
+    xkb_context_invalidate_include_dirs(ctx);
+
+    num_resolved = xkb_components_from_rules_batch(ctx, rmlvo, num_names,
+                                                   components_out);
+
+    free(rmlvo);
+    return num_resolved;
 }
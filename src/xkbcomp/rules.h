@@ -29,4 +29,17 @@ xkb_components_from_rules(struct xkb_context *ctx,
                           const struct xkb_rule_names *rmlvo,
                           struct xkb_component_names *out);
 
+/*
+ * Like xkb_components_from_rules(), for @num names at once. Each rules
+ * file is only looked up once for each run of names which share it. If
+ * some names could not be resolved, their @out entry is zeroed.
+ *
+ * Returns the number of names which were resolved.
+ */
+size_t
+xkb_components_from_rules_batch(struct xkb_context *ctx,
+                                const struct xkb_rule_names *rmlvo,
+                                size_t num,
+                                struct xkb_component_names *out);
+
 #endif
@@ -142,7 +142,7 @@ InitKeyInfo(struct xkb_context *ctx, KeyInfo *keyi)
 {
     memset(keyi, 0, sizeof(*keyi));
     keyi->merge = MERGE_OVERRIDE;
-    keyi->name = xkb_atom_intern_literal(ctx, "*");
+    keyi->name = ATOM_STAR;
     keyi->out_of_range_group_action = RANGE_WRAP;
 }
 
@@ -180,16 +180,19 @@ typedef struct {
     struct xkb_mod_set mods;
 
     struct xkb_context *ctx;
+    darray_included_file *included_files;
     /* Needed for AddKeySymbols. */
     const struct xkb_keymap *keymap;
 } SymbolsInfo;
 
 static void
 InitSymbolsInfo(SymbolsInfo *info, const struct xkb_keymap *keymap,
+                darray_included_file *included_files,
                 ActionsInfo *actions, const struct xkb_mod_set *mods)
 {
     memset(info, 0, sizeof(*info));
     info->ctx = keymap->ctx;
+    info->included_files = included_files;
     info->keymap = keymap;
     info->merge = MERGE_OVERRIDE;
     InitKeyInfo(keymap->ctx, &info->default_key);
@@ -273,7 +276,7 @@ MergeGroups(SymbolsInfo *info, GroupInfo *into, GroupInfo *from, bool clobber,
             intoLevel->action = fromLevel->action;
         }
         else {
-            union xkb_action *use, *ignore;
+            union xkb_packed_action *use, *ignore;
             use = (clobber ? &fromLevel->action : &intoLevel->action);
             ignore = (clobber ? &intoLevel->action : &fromLevel->action);
 
@@ -550,23 +553,24 @@ HandleIncludeSymbols(SymbolsInfo *info, IncludeStmt *include)
 {
     SymbolsInfo included;
 
-    InitSymbolsInfo(&included, info->keymap, info->actions, &info->mods);
-    included.name = include->stmt;
-    include->stmt = NULL;
+    InitSymbolsInfo(&included, info->keymap, info->included_files,
+                    info->actions, &info->mods);
+    included.name = strdup_safe(include->stmt);
 
     for (IncludeStmt *stmt = include; stmt; stmt = stmt->next_incl) {
         SymbolsInfo next_incl;
         XkbFile *file;
 
-        file = ProcessIncludeFile(info->ctx, stmt, FILE_TYPE_SYMBOLS);
+        file = ProcessIncludeFile(info->ctx, info->included_files, stmt,
+                                  FILE_TYPE_SYMBOLS);
         if (!file) {
             info->errorCount += 10;
             ClearSymbolsInfo(&included);
             return false;
         }
 
-        InitSymbolsInfo(&next_incl, info->keymap, info->actions,
-                        &included.mods);
+        InitSymbolsInfo(&next_incl, info->keymap, info->included_files,
+                        info->actions, &included.mods);
         if (stmt->modifier) {
             next_incl.explicit_group = atoi(stmt->modifier) - 1;
             if (next_incl.explicit_group >= XKB_MAX_GROUPS) {
@@ -586,7 +590,7 @@ HandleIncludeSymbols(SymbolsInfo *info, IncludeStmt *include)
         MergeIncludedSymbols(&included, &next_incl, stmt->merge);
 
         ClearSymbolsInfo(&next_incl);
-        FreeXkbFile(file);
+        ReleaseIncludeFile(info->included_files, file);
     }
 
     MergeIncludedSymbols(info, &included, include->merge);
@@ -759,13 +763,18 @@ AddActionsToKey(SymbolsInfo *info, KeyInfo *keyi, ExprDef *arrayNdx,
 
     act = value->unary.child;
     for (unsigned i = 0; i < nActs; i++) {
-        union xkb_action *toAct = &darray_item(groupi->levels, i).action;
+        union xkb_packed_action *toAct =
+            &darray_item(groupi->levels, i).action;
+        union xkb_action action;
 
-        if (!HandleActionDef(info->ctx, info->actions, &info->mods, act, toAct))
+        XkbUnpackAction(&action, toAct);
+        if (!HandleActionDef(info->ctx, info->actions, &info->mods, act,
+                             &action))
             log_err(info->ctx,
                     "Illegal action definition for %s; "
                     "Action for group %u/level %u ignored\n",
                     KeyInfoText(info, keyi), ndx + 1, i + 1);
+        XkbPackAction(toAct, &action);
 
         act = (ExprDef *) act->common.next;
     }
@@ -1303,19 +1312,19 @@ FindAutomaticType(struct xkb_context *ctx, GroupInfo *groupi)
         darray_item(groupi->levels, level).u.syms[0])
 
     if (width == 1 || width <= 0)
-        return xkb_atom_intern_literal(ctx, "ONE_LEVEL");
+        return ATOM_ONE_LEVEL;
 
     sym0 = GET_SYM(0);
     sym1 = GET_SYM(1);
 
     if (width == 2) {
         if (xkb_keysym_is_lower(sym0) && xkb_keysym_is_upper(sym1))
-            return xkb_atom_intern_literal(ctx, "ALPHABETIC");
+            return ATOM_ALPHABETIC;
 
         if (xkb_keysym_is_keypad(sym0) || xkb_keysym_is_keypad(sym1))
-            return xkb_atom_intern_literal(ctx, "KEYPAD");
+            return ATOM_KEYPAD;
 
-        return xkb_atom_intern_literal(ctx, "TWO_LEVEL");
+        return ATOM_TWO_LEVEL;
     }
 
     if (width <= 4) {
@@ -1324,15 +1333,15 @@ FindAutomaticType(struct xkb_context *ctx, GroupInfo *groupi)
             sym3 = (width == 4 ? GET_SYM(3) : XKB_KEY_NoSymbol);
 
             if (xkb_keysym_is_lower(sym2) && xkb_keysym_is_upper(sym3))
-                return xkb_atom_intern_literal(ctx, "FOUR_LEVEL_ALPHABETIC");
+                return ATOM_FOUR_LEVEL_ALPHABETIC;
 
-            return xkb_atom_intern_literal(ctx, "FOUR_LEVEL_SEMIALPHABETIC");
+            return ATOM_FOUR_LEVEL_SEMIALPHABETIC;
         }
 
         if (xkb_keysym_is_keypad(sym0) || xkb_keysym_is_keypad(sym1))
-            return xkb_atom_intern_literal(ctx, "FOUR_LEVEL_KEYPAD");
+            return ATOM_FOUR_LEVEL_KEYPAD;
 
-        return xkb_atom_intern_literal(ctx, "FOUR_LEVEL");
+        return ATOM_FOUR_LEVEL;
     }
 
     return XKB_ATOM_NONE;
@@ -1572,7 +1581,7 @@ CopySymbolsToKeymap(struct xkb_keymap *keymap, SymbolsInfo *info)
 
 bool
 CompileSymbols(XkbFile *file, struct xkb_keymap *keymap,
-               enum merge_mode merge)
+               enum merge_mode merge, darray_included_file *included_files)
 {
     SymbolsInfo info;
     ActionsInfo *actions;
@@ -1581,7 +1590,7 @@ CompileSymbols(XkbFile *file, struct xkb_keymap *keymap,
     if (!actions)
         return false;
 
-    InitSymbolsInfo(&info, keymap, actions, &keymap->mods);
+    InitSymbolsInfo(&info, keymap, included_files, actions, &keymap->mods);
     info.default_key.merge = merge;
 
     HandleSymbolsFile(&info, file, merge);
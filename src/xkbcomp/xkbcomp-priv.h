@@ -30,15 +30,15 @@
 #include "keymap.h"
 #include "ast.h"
 
-struct xkb_component_names {
-    char *keycodes;
-    char *types;
-    char *compat;
-    char *symbols;
-};
+/* The files included by a compilation; see xkbcomp/include.c. */
+struct included_file;
+typedef darray(struct included_file) darray_included_file;
 
-char *
-text_v1_keymap_get_as_string(struct xkb_keymap *keymap);
+bool
+text_v1_keymap_write(struct xkb_keymap *keymap,
+                     int (*write_fn)(void *user_data, const char *data,
+                                     size_t length),
+                     void *user_data);
 
 XkbFile *
 XkbParseFile(struct xkb_context *ctx, FILE *file,
@@ -58,22 +58,23 @@ XkbFileFromComponents(struct xkb_context *ctx,
 
 bool
 CompileKeycodes(XkbFile *file, struct xkb_keymap *keymap,
-                enum merge_mode merge);
+                enum merge_mode merge, darray_included_file *included_files);
 
 bool
 CompileKeyTypes(XkbFile *file, struct xkb_keymap *keymap,
-                enum merge_mode merge);
+                enum merge_mode merge, darray_included_file *included_files);
 
 bool
 CompileCompatMap(XkbFile *file, struct xkb_keymap *keymap,
-                 enum merge_mode merge);
+                 enum merge_mode merge, darray_included_file *included_files);
 
 bool
 CompileSymbols(XkbFile *file, struct xkb_keymap *keymap,
-               enum merge_mode merge);
+               enum merge_mode merge, darray_included_file *included_files);
 
 bool
 CompileKeymap(XkbFile *file, struct xkb_keymap *keymap,
+              const struct xkb_keymap *base, enum xkb_file_type first_type,
               enum merge_mode merge);
 
 /***====================================================================***/
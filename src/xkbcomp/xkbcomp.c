@@ -31,7 +31,9 @@
 #include "rules.h"
 
 static bool
-compile_keymap_file(struct xkb_keymap *keymap, XkbFile *file)
+compile_keymap_file(struct xkb_keymap *keymap, XkbFile *file,
+                    const struct xkb_keymap *base,
+                    enum xkb_file_type first_type)
 {
     if (file->file_type != FILE_TYPE_KEYMAP) {
         log_err(keymap->ctx,
@@ -40,7 +42,7 @@ compile_keymap_file(struct xkb_keymap *keymap, XkbFile *file)
         return false;
     }
 
-    if (!CompileKeymap(file, keymap, MERGE_OVERRIDE)) {
+    if (!CompileKeymap(file, keymap, base, first_type, MERGE_OVERRIDE)) {
         log_err(keymap->ctx,
                 "Failed to compile keymap\n");
         return false;
@@ -49,12 +51,59 @@ compile_keymap_file(struct xkb_keymap *keymap, XkbFile *file)
     return true;
 }
 
+/*
+ * Return the first section which must be compiled for @origin, if the
+ * sections before it may be reused from @base.
+ */
+static enum xkb_file_type
+first_changed_section(const struct xkb_keymap *base,
+                      const struct xkb_keymap_origin *origin)
+{
+    if (!base || !base->origin)
+        return FIRST_KEYMAP_FILE_TYPE;
+    if (!streq(base->origin->keycodes, origin->keycodes))
+        return FILE_TYPE_KEYCODES;
+    if (!streq(base->origin->types, origin->types))
+        return FILE_TYPE_TYPES;
+    if (!streq(base->origin->compat, origin->compat))
+        return FILE_TYPE_COMPAT;
+    return FILE_TYPE_SYMBOLS;
+}
+
+static struct xkb_keymap_origin *
+keymap_origin_new(const struct xkb_component_names *kccgst)
+{
+    struct xkb_keymap_origin *origin = calloc(1, sizeof(*origin));
+
+    if (!origin)
+        return NULL;
+
+    origin->keycodes = strdup(kccgst->keycodes);
+    origin->types = strdup(kccgst->types);
+    origin->compat = strdup(kccgst->compat);
+    origin->symbols = strdup(kccgst->symbols);
+
+    if (!origin->keycodes || !origin->types ||
+        !origin->compat || !origin->symbols) {
+        free(origin->keycodes);
+        free(origin->types);
+        free(origin->compat);
+        free(origin->symbols);
+        free(origin);
+        return NULL;
+    }
+
+    return origin;
+}
+
 static bool
-text_v1_keymap_new_from_names(struct xkb_keymap *keymap,
-                              const struct xkb_rule_names *rmlvo)
+compile_keymap_from_names(struct xkb_keymap *keymap,
+                          const struct xkb_keymap *base,
+                          const struct xkb_rule_names *rmlvo)
 {
     bool ok;
     struct xkb_component_names kccgst;
+    enum xkb_file_type first_type;
     XkbFile *file;
 
     log_dbg(keymap->ctx,
@@ -63,6 +112,8 @@ text_v1_keymap_new_from_names(struct xkb_keymap *keymap,
             rmlvo->rules, rmlvo->model, rmlvo->layout, rmlvo->variant,
             rmlvo->options);
 
+    xkb_context_invalidate_include_dirs(keymap->ctx);
+
     ok = xkb_components_from_rules(keymap->ctx, rmlvo, &kccgst);
     if (!ok) {
         log_err(keymap->ctx,
@@ -78,6 +129,9 @@ text_v1_keymap_new_from_names(struct xkb_keymap *keymap,
             "compat '%s', symbols '%s'\n",
             kccgst.keycodes, kccgst.types, kccgst.compat, kccgst.symbols);
 
+    /* Before XkbFileFromComponents(), which chops up the components. */
+    keymap->origin = keymap_origin_new(&kccgst);
+
     file = XkbFileFromComponents(keymap->ctx, &kccgst);
 
     free(kccgst.keycodes);
@@ -85,17 +139,37 @@ text_v1_keymap_new_from_names(struct xkb_keymap *keymap,
     free(kccgst.compat);
     free(kccgst.symbols);
 
-    if (!file) {
+    if (!file || !keymap->origin) {
         log_err(keymap->ctx,
                 "Failed to generate parsed XKB file from components\n");
+        FreeXkbFile(file);
         return false;
     }
 
-    ok = compile_keymap_file(keymap, file);
+    if (base && base->flags != keymap->flags)
+        base = NULL;
+    first_type = first_changed_section(base, keymap->origin);
+
+    ok = compile_keymap_file(keymap, file, base, first_type);
     FreeXkbFile(file);
     return ok;
 }
 
+static bool
+text_v1_keymap_new_from_names(struct xkb_keymap *keymap,
+                              const struct xkb_rule_names *rmlvo)
+{
+    return compile_keymap_from_names(keymap, NULL, rmlvo);
+}
+
+static bool
+text_v1_keymap_new_from_names_derived(struct xkb_keymap *keymap,
+                                      const struct xkb_keymap *base,
+                                      const struct xkb_rule_names *rmlvo)
+{
+    return compile_keymap_from_names(keymap, base, rmlvo);
+}
+
 static bool
 text_v1_keymap_new_from_string(struct xkb_keymap *keymap,
                                const char *string, size_t len)
@@ -103,13 +177,16 @@ text_v1_keymap_new_from_string(struct xkb_keymap *keymap,
     bool ok;
     XkbFile *xkb_file;
 
+    xkb_context_invalidate_include_dirs(keymap->ctx);
+
     xkb_file = XkbParseString(keymap->ctx, string, len, "(input string)", NULL);
     if (!xkb_file) {
         log_err(keymap->ctx, "Failed to parse input xkb string\n");
         return NULL;
     }
 
-    ok = compile_keymap_file(keymap, xkb_file);
+    ok = compile_keymap_file(keymap, xkb_file,
+                             NULL, FIRST_KEYMAP_FILE_TYPE);
     FreeXkbFile(xkb_file);
     return ok;
 }
@@ -120,20 +197,25 @@ text_v1_keymap_new_from_file(struct xkb_keymap *keymap, FILE *file)
     bool ok;
     XkbFile *xkb_file;
 
+    xkb_context_invalidate_include_dirs(keymap->ctx);
+
     xkb_file = XkbParseFile(keymap->ctx, file, "(unknown file)", NULL);
     if (!xkb_file) {
         log_err(keymap->ctx, "Failed to parse input xkb file\n");
         return false;
     }
 
-    ok = compile_keymap_file(keymap, xkb_file);
+    ok = compile_keymap_file(keymap, xkb_file,
+                             NULL, FIRST_KEYMAP_FILE_TYPE);
     FreeXkbFile(xkb_file);
     return ok;
 }
 
 const struct xkb_keymap_format_ops text_v1_keymap_format_ops = {
+    .is_text = true,
     .keymap_new_from_names = text_v1_keymap_new_from_names,
+    .keymap_new_from_names_derived = text_v1_keymap_new_from_names_derived,
     .keymap_new_from_string = text_v1_keymap_new_from_string,
     .keymap_new_from_file = text_v1_keymap_new_from_file,
-    .keymap_get_as_string = text_v1_keymap_get_as_string,
+    .keymap_write = text_v1_keymap_write,
 };
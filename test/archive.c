@@ -0,0 +1,167 @@
+/*
+ * Copyright © 2014 The libxkbcommon authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "archive.h"
+
+static char *
+compile_to_string(struct xkb_context *ctx)
+{
+    struct xkb_keymap *keymap;
+    char *dump;
+
+    keymap = test_compile_rules(ctx, "evdev", "pc105", "us,de", "",
+                                "grp:alt_shift_toggle");
+    assert(keymap);
+    dump = xkb_keymap_get_as_string(keymap, XKB_KEYMAP_USE_ORIGINAL_FORMAT);
+    assert(dump);
+    xkb_keymap_unref(keymap);
+
+    return dump;
+}
+
+/* Links which can't be included are skipped, rather than failing. */
+static void
+test_pack_links(const char *data_path)
+{
+    char dir[] = "/tmp/xkb-pack-XXXXXX";
+    char archive_path[] = "/tmp/xkb-archive-XXXXXX";
+    char *symbols, *us, *data, *target, *compiled, *loop;
+    struct xkb_archive *archive;
+    const char *string;
+    size_t len;
+    int fd;
+
+    assert(mkdtemp(dir));
+    fd = mkstemp(archive_path);
+    assert(fd >= 0);
+    close(fd);
+
+    assert(asprintf(&symbols, "%s/symbols", dir) >= 0);
+    assert(asprintf(&us, "%s/symbols/us", dir) >= 0);
+    /* The link is relative to its own directory otherwise. */
+    data = realpath(data_path, NULL);
+    assert(data);
+    assert(asprintf(&target, "%s/symbols/us", data) >= 0);
+    assert(asprintf(&compiled, "%s/compiled", dir) >= 0);
+    assert(asprintf(&loop, "%s/symbols/loop", dir) >= 0);
+    assert(mkdir(symbols, 0700) == 0);
+    assert(symlink(target, us) == 0);
+    assert(symlink("/nonexistent/xkb", compiled) == 0);
+    assert(symlink("..", loop) == 0);
+
+    assert(xkb_archive_pack(dir, archive_path));
+
+    archive = xkb_archive_open(archive_path);
+    assert(archive);
+    assert(xkb_archive_find(archive, "symbols", "us", &string, &len));
+    assert(len > 0);
+    assert(!xkb_archive_find(archive, "symbols", "loop/symbols/us",
+                             &string, &len));
+    xkb_archive_close(archive);
+
+    assert(unlink(loop) == 0);
+    assert(unlink(compiled) == 0);
+    assert(unlink(us) == 0);
+    assert(rmdir(symbols) == 0);
+    assert(rmdir(dir) == 0);
+    assert(unlink(archive_path) == 0);
+    free(symbols);
+    free(us);
+    free(data);
+    free(target);
+    free(compiled);
+    free(loop);
+}
+
+int
+main(void)
+{
+    char archive_path[] = "/tmp/xkb-archive-XXXXXX";
+    char *data_path;
+    struct xkb_context *ctx;
+    struct xkb_archive *archive;
+    const char *string;
+    size_t len;
+    char *expected, *got;
+    FILE *file;
+    int fd;
+
+    fd = mkstemp(archive_path);
+    assert(fd >= 0);
+    close(fd);
+
+    data_path = test_get_path("");
+    assert(data_path);
+    assert(xkb_archive_pack(data_path, archive_path));
+    test_pack_links(data_path);
+
+    archive = xkb_archive_open(archive_path);
+    assert(archive);
+    assert(xkb_archive_find(archive, "symbols", "us", &string, &len));
+    assert(len > 0);
+    assert(xkb_archive_find(archive, "rules", "evdev", &string, &len));
+    assert(!xkb_archive_find(archive, "symbols", "nonexistent",
+                             &string, &len));
+    assert(!xkb_archive_find(archive, "symbol", "us", &string, &len));
+    xkb_archive_close(archive);
+
+    /* Compiling from the archive is the same as from the directory. */
+    ctx = test_get_context(0);
+    assert(ctx);
+    expected = compile_to_string(ctx);
+    xkb_context_unref(ctx);
+
+    ctx = xkb_context_new(XKB_CONTEXT_NO_DEFAULT_INCLUDES |
+                          XKB_CONTEXT_NO_ENVIRONMENT_NAMES);
+    assert(ctx);
+    assert(xkb_context_include_path_append(ctx, archive_path));
+    got = compile_to_string(ctx);
+    assert(streq(expected, got));
+    xkb_context_unref(ctx);
+
+    /* A truncated archive is rejected. */
+    file = fopen(archive_path, "r+");
+    assert(file);
+    assert(ftruncate(fileno(file), 32) == 0);
+    fclose(file);
+
+    ctx = xkb_context_new(XKB_CONTEXT_NO_DEFAULT_INCLUDES |
+                          XKB_CONTEXT_NO_ENVIRONMENT_NAMES);
+    assert(ctx);
+    xkb_context_set_log_level(ctx, XKB_LOG_LEVEL_CRITICAL);
+    assert(!xkb_context_include_path_append(ctx, archive_path));
+    assert(xkb_context_num_include_paths(ctx) == 0);
+    xkb_context_unref(ctx);
+
+    assert(unlink(archive_path) == 0);
+    free(data_path);
+    free(expected);
+    free(got);
+
+    return 0;
+}
@@ -144,6 +144,42 @@ test_random_strings(void)
     atom_table_free(table);
 }
 
+static void
+test_stable_text(void)
+{
+    struct atom_table *table;
+    xkb_atom_t atom;
+    const char *text;
+    char buf[16];
+    char *long_string;
+
+    table = atom_table_new();
+    assert(table);
+
+    atom = INTERN_LITERAL(table, "first");
+    text = atom_text(table, atom);
+
+    /* Strings don't move as the table grows. */
+    for (int i = 0; i < 10000; i++) {
+        snprintf(buf, sizeof(buf), "atom%d", i);
+        assert(atom_intern(table, buf, strlen(buf), false) != XKB_ATOM_NONE);
+    }
+    assert(atom_text(table, atom) == text);
+    assert(streq(text, "first"));
+    assert(LOOKUP_LITERAL(table, "atom9999") != XKB_ATOM_NONE);
+
+    long_string = malloc(10001);
+    assert(long_string);
+    memset(long_string, 'x', 10000);
+    long_string[10000] = '\0';
+    atom = atom_intern(table, long_string, 10000, true);
+    assert(atom != XKB_ATOM_NONE);
+    assert(strlen(atom_text(table, atom)) == 10000);
+    assert(LOOKUP_LITERAL(table, "atom0") != XKB_ATOM_NONE);
+
+    atom_table_free(table);
+}
+
 int
 main(void)
 {
@@ -156,6 +192,13 @@ main(void)
     assert(atom_text(table, XKB_ATOM_NONE) == NULL);
     assert(atom_lookup(table, NULL, 0) == XKB_ATOM_NONE);
 
+    /* The builtin atoms are already there. */
+    assert(streq(atom_text(table, ATOM_SHIFT), "Shift"));
+    assert(streq(atom_text(table, ATOM_MOD5), "Mod5"));
+    assert(INTERN_LITERAL(table, "FOUR_LEVEL") == ATOM_FOUR_LEVEL);
+    assert(LOOKUP_LITERAL(table, "Caps Lock") == ATOM_CAPS_LOCK);
+    assert(atom_text(table, _ATOM_NUM_BUILTIN) == NULL);
+
     atom1 = INTERN_LITERAL(table, "hello");
     assert(atom1 != XKB_ATOM_NONE);
     assert(atom1 == LOOKUP_LITERAL(table, "hello"));
@@ -176,6 +219,7 @@ main(void)
     atom_table_free(table);
 
     test_random_strings();
+    test_stable_text();
 
     return 0;
 }
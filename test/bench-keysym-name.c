@@ -0,0 +1,219 @@
+/*
+ * Copyright © 2014 The libxkbcommon authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "test.h"
+#include "keysym.h"
+#include "ks_tables.h"
+
+#define BENCHMARK_ITERATIONS 500
+
+/*
+ * The previous lookup, a bsearch() over name_to_keysym, then a walk over
+ * the case-insensitive duplicates. Kept to compare against.
+ */
+static int
+compare_by_name(const void *a, const void *b)
+{
+    const char *key = a;
+    const struct name_keysym *entry = b;
+    return strcasecmp(key, keysym_names + entry->offset);
+}
+
+static xkb_keysym_t
+bsearch_keysym_from_name(const char *name, bool icase)
+{
+    const struct name_keysym *entry, *iter, *last;
+
+    entry = bsearch(name, name_to_keysym, ARRAY_SIZE(name_to_keysym),
+                    sizeof(*name_to_keysym), compare_by_name);
+    if (!entry)
+        return XKB_KEY_NoSymbol;
+
+    if (!icase && strcmp(keysym_names + entry->offset, name) == 0)
+        return entry->keysym;
+    if (icase && xkb_keysym_is_lower(entry->keysym))
+        return entry->keysym;
+
+    for (iter = entry - 1; iter >= name_to_keysym; --iter) {
+        if (strcasecmp(keysym_names + iter->offset, name) != 0)
+            break;
+        if (!icase && strcmp(keysym_names + iter->offset, name) == 0)
+            return iter->keysym;
+        if (icase && xkb_keysym_is_lower(iter->keysym))
+            return iter->keysym;
+    }
+
+    last = name_to_keysym + ARRAY_SIZE(name_to_keysym);
+    for (iter = entry + 1; iter < last; ++iter) {
+        if (strcasecmp(keysym_names + iter->offset, name) != 0)
+            break;
+        if (!icase && strcmp(keysym_names + iter->offset, name) == 0)
+            return iter->keysym;
+        if (icase && xkb_keysym_is_lower(iter->keysym))
+            return iter->keysym;
+    }
+
+    return icase ? entry->keysym : XKB_KEY_NoSymbol;
+}
+
+/* The previous xkb_keysym_get_name(), for keysyms with names. */
+static int
+compare_by_keysym(const void *a, const void *b)
+{
+    const xkb_keysym_t *key = a;
+    const struct name_keysym *entry = b;
+    if (*key < entry->keysym)
+        return -1;
+    if (*key > entry->keysym)
+        return 1;
+    return 0;
+}
+
+static int
+bsearch_keysym_get_name(xkb_keysym_t ks, char *buffer, size_t size)
+{
+    const struct name_keysym *entry;
+
+    entry = bsearch(&ks, keysym_to_name, ARRAY_SIZE(keysym_to_name),
+                    sizeof(*keysym_to_name), compare_by_keysym);
+    if (!entry)
+        return -1;
+
+    return snprintf(buffer, size, "%s", keysym_names + entry->offset);
+}
+
+static double
+elapsed_since(const struct timespec *start)
+{
+    struct timespec stop;
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    return (stop.tv_sec - start->tv_sec) +
+           (stop.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int
+main(void)
+{
+    const size_t num_names = ARRAY_SIZE(name_to_keysym);
+    const char **names;
+    char **upper_names;
+    const size_t num_keysyms = ARRAY_SIZE(keysym_to_name);
+    struct timespec start;
+    xkb_keysym_t sum = 0;
+    char buf[64], expected[64];
+
+    names = calloc(num_names, sizeof(*names));
+    upper_names = calloc(num_names, sizeof(*upper_names));
+    assert(names && upper_names);
+
+    for (size_t i = 0; i < num_names; i++) {
+        names[i] = keysym_names + name_to_keysym[i].offset;
+        upper_names[i] = strdup(names[i]);
+        assert(upper_names[i]);
+        for (char *c = upper_names[i]; *c; c++)
+            *c = toupper((unsigned char) *c);
+    }
+
+    /* Both agree, before comparing their speed. */
+    for (size_t i = 0; i < num_names; i++) {
+        assert(xkb_keysym_from_name(names[i], 0) ==
+               bsearch_keysym_from_name(names[i], false));
+        assert(xkb_keysym_from_name(upper_names[i], 0) ==
+               bsearch_keysym_from_name(upper_names[i], false));
+        if (xkb_keysym_is_lower(bsearch_keysym_from_name(names[i], true)))
+            assert(xkb_keysym_from_name(upper_names[i],
+                                        XKB_KEYSYM_CASE_INSENSITIVE) ==
+                   bsearch_keysym_from_name(upper_names[i], true));
+    }
+
+    for (size_t i = 0; i < num_keysyms; i++) {
+        xkb_keysym_t ks = keysym_to_name[i].keysym;
+
+        assert(xkb_keysym_get_name(ks, buf, sizeof(buf)) ==
+               bsearch_keysym_get_name(ks, expected, sizeof(expected)));
+        assert(streq(buf, expected));
+        assert(xkb_keysym_get_name(ks, buf, 4) ==
+               bsearch_keysym_get_name(ks, expected, 4));
+        assert(streq(buf, expected));
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int j = 0; j < BENCHMARK_ITERATIONS; j++)
+        for (size_t i = 0; i < num_names; i++)
+            sum += bsearch_keysym_from_name(names[i], false);
+    fprintf(stderr, "%-20s %d iterations in %fs\n", "bsearch:",
+            BENCHMARK_ITERATIONS, elapsed_since(&start));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int j = 0; j < BENCHMARK_ITERATIONS; j++)
+        for (size_t i = 0; i < num_names; i++)
+            sum += xkb_keysym_from_name(names[i], 0);
+    fprintf(stderr, "%-20s %d iterations in %fs\n", "perfect hash:",
+            BENCHMARK_ITERATIONS, elapsed_since(&start));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int j = 0; j < BENCHMARK_ITERATIONS; j++)
+        for (size_t i = 0; i < num_names; i++)
+            sum += bsearch_keysym_from_name(upper_names[i], true);
+    fprintf(stderr, "%-20s %d iterations in %fs\n", "bsearch, icase:",
+            BENCHMARK_ITERATIONS, elapsed_since(&start));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int j = 0; j < BENCHMARK_ITERATIONS; j++)
+        for (size_t i = 0; i < num_names; i++)
+            sum += xkb_keysym_from_name(upper_names[i],
+                                        XKB_KEYSYM_CASE_INSENSITIVE);
+    fprintf(stderr, "%-20s %d iterations in %fs\n", "perfect hash, icase:",
+            BENCHMARK_ITERATIONS, elapsed_since(&start));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int j = 0; j < BENCHMARK_ITERATIONS; j++)
+        for (size_t i = 0; i < num_keysyms; i++)
+            sum += bsearch_keysym_get_name(keysym_to_name[i].keysym,
+                                           buf, sizeof(buf));
+    fprintf(stderr, "%-20s %d iterations in %fs\n", "bsearch, get name:",
+            BENCHMARK_ITERATIONS, elapsed_since(&start));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int j = 0; j < BENCHMARK_ITERATIONS; j++)
+        for (size_t i = 0; i < num_keysyms; i++)
+            sum += xkb_keysym_get_name(keysym_to_name[i].keysym,
+                                       buf, sizeof(buf));
+    fprintf(stderr, "%-20s %d iterations in %fs\n", "index, get name:",
+            BENCHMARK_ITERATIONS, elapsed_since(&start));
+
+    /* Don't let the lookups be optimized out. */
+    fprintf(stderr, "(%#x)\n", sum);
+
+    for (size_t i = 0; i < num_names; i++)
+        free(upper_names[i]);
+    free(upper_names);
+    free(names);
+
+    return 0;
+}
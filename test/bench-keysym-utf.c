@@ -0,0 +1,135 @@
+/*
+ * Copyright © 2014 The libxkbcommon authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "test.h"
+
+#define BENCHMARK_ITERATIONS 20000
+
+typedef darray(xkb_keysym_t) darray_keysym;
+
+static void
+print_elapsed(const char *what, struct timespec *start, struct timespec *stop,
+              size_t num_keysyms, unsigned long sum)
+{
+    struct timespec elapsed;
+
+    elapsed.tv_sec = stop->tv_sec - start->tv_sec;
+    elapsed.tv_nsec = stop->tv_nsec - start->tv_nsec;
+    if (elapsed.tv_nsec < 0) {
+        elapsed.tv_nsec += 1000000000;
+        elapsed.tv_sec--;
+    }
+
+    fprintf(stderr, "%s: converted %u keysyms %d times in %ld.%09lds (%lu)\n",
+            what, (unsigned) num_keysyms, BENCHMARK_ITERATIONS,
+            elapsed.tv_sec, elapsed.tv_nsec, sum);
+}
+
+static void
+bench(const char *what, darray_keysym keysyms)
+{
+    struct timespec start, stop;
+    xkb_keysym_t *keysym;
+    size_t size = 4 * darray_size(keysyms) + 1;
+    char buf[7], *text;
+    unsigned long sum = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+        darray_foreach(keysym, keysyms)
+            sum += xkb_keysym_to_utf8(*keysym, buf, sizeof(buf));
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    print_elapsed(what, &start, &stop, darray_size(keysyms), sum);
+
+    /* The same keysyms, as one string. */
+    text = malloc(size);
+    assert(text);
+    sum = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+        sum += xkb_keysyms_to_utf8(darray_mem(keysyms, 0),
+                                   darray_size(keysyms), text, size);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    print_elapsed("  as one string", &start, &stop, darray_size(keysyms), sum);
+    free(text);
+}
+
+int
+main(void)
+{
+    struct xkb_context *ctx;
+    struct xkb_keymap *keymap;
+    darray_keysym keysyms = darray_new();
+    xkb_keycode_t kc;
+    const char *paste = "The quick brown fox jumps over the lazy dog. ";
+
+    ctx = test_get_context(0);
+    assert(ctx);
+
+    keymap = test_compile_rules(ctx, "evdev", "pc104", "us,ru,il,cz",
+                                NULL, NULL);
+    assert(keymap);
+
+    /* The keysyms a user of these layouts may type. */
+    for (kc = xkb_keymap_min_keycode(keymap);
+         kc <= xkb_keymap_max_keycode(keymap); kc++) {
+        xkb_layout_index_t layout;
+
+        for (layout = 0;
+             layout < xkb_keymap_num_layouts_for_key(keymap, kc); layout++) {
+            xkb_level_index_t level;
+
+            for (level = 0;
+                 level < xkb_keymap_num_levels_for_key(keymap, kc, layout);
+                 level++) {
+                const xkb_keysym_t *syms;
+                int num_syms;
+
+                num_syms = xkb_keymap_key_get_syms_by_level(keymap, kc,
+                                                            layout, level,
+                                                            &syms);
+                for (int i = 0; i < num_syms; i++)
+                    darray_append(keysyms, syms[i]);
+            }
+        }
+    }
+
+    bench("keymap", keysyms);
+
+    /* Pasted text; printable ASCII keysyms are the characters. */
+    darray_resize(keysyms, 0);
+    for (int i = 0; i < 20; i++)
+        for (const char *c = paste; *c; c++)
+            darray_append(keysyms, *c);
+
+    bench("paste", keysyms);
+
+    darray_free(keysyms);
+    xkb_keymap_unref(keymap);
+    xkb_context_unref(ctx);
+
+    return 0;
+}
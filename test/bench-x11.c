@@ -0,0 +1,200 @@
+/*
+ * Copyright © 2014 The libxkbcommon authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Measures how long xkb_x11_keymap_new_from_device() takes, directly and
+ * through a relay which delays everything the server sends, as a remote
+ * display would. The latter is dominated by the number of round trips.
+ *
+ * Needs a local X server with XKB and no authorization, e.g.:
+ *      Xvfb :99 & DISPLAY=:99 ./test/bench-x11
+ */
+
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "test.h"
+#include "xkbcommon/xkbcommon-x11.h"
+
+#define BENCHMARK_ITERATIONS 20
+#define LATENCY_MS 10
+
+struct relay {
+    int client_fd;
+    int server_fd;
+};
+
+static bool
+write_all(int fd, const char *data, ssize_t length)
+{
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0)
+            return false;
+        data += written;
+        length -= written;
+    }
+    return true;
+}
+
+static void *
+relay_thread(void *data)
+{
+    struct relay *relay = data;
+    struct pollfd fds[2] = {
+        { relay->client_fd, POLLIN, 0 },
+        { relay->server_fd, POLLIN, 0 },
+    };
+    const struct timespec latency = { 0, LATENCY_MS * 1000000L };
+    char buf[65536];
+    ssize_t n;
+
+    while (poll(fds, 2, -1) > 0) {
+        if (fds[0].revents) {
+            n = read(relay->client_fd, buf, sizeof(buf));
+            if (n <= 0 || !write_all(relay->server_fd, buf, n))
+                break;
+        }
+        if (fds[1].revents) {
+            n = read(relay->server_fd, buf, sizeof(buf));
+            if (n <= 0)
+                break;
+            nanosleep(&latency, NULL);
+            if (!write_all(relay->client_fd, buf, n))
+                break;
+        }
+    }
+
+    close(relay->client_fd);
+    close(relay->server_fd);
+    return NULL;
+}
+
+/* Connect to the local socket of $DISPLAY, through a delaying relay. */
+static xcb_connection_t *
+connect_with_latency(pthread_t *thread, struct relay *relay)
+{
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    const char *display = getenv("DISPLAY");
+    int fds[2];
+
+    if (!display || display[0] != ':')
+        return NULL;
+
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "/tmp/.X11-unix/X%d",
+             atoi(display + 1));
+
+    relay->server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (relay->server_fd < 0)
+        return NULL;
+    if (connect(relay->server_fd, (struct sockaddr *) &addr,
+                sizeof(addr)) < 0 ||
+        socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) {
+        close(relay->server_fd);
+        return NULL;
+    }
+
+    relay->client_fd = fds[1];
+    if (pthread_create(thread, NULL, relay_thread, relay) != 0) {
+        close(fds[0]);
+        close(fds[1]);
+        close(relay->server_fd);
+        return NULL;
+    }
+
+    /* It ends by itself when either side hangs up. */
+    pthread_detach(*thread);
+
+    return xcb_connect_to_fd(fds[0], NULL);
+}
+
+static bool
+bench(struct xkb_context *ctx, xcb_connection_t *conn, const char *what)
+{
+    struct timespec start, stop;
+    int32_t device_id;
+    double elapsed;
+
+    if (xcb_connection_has_error(conn) ||
+        !xkb_x11_setup_xkb_extension(conn,
+                                     XKB_X11_MIN_MAJOR_XKB_VERSION,
+                                     XKB_X11_MIN_MINOR_XKB_VERSION,
+                                     XKB_X11_SETUP_XKB_EXTENSION_NO_FLAGS,
+                                     NULL, NULL, NULL, NULL))
+        return false;
+
+    device_id = xkb_x11_get_core_keyboard_device_id(conn);
+    assert(device_id != -1);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+        struct xkb_keymap *keymap =
+            xkb_x11_keymap_new_from_device(ctx, conn, device_id,
+                                           XKB_KEYMAP_COMPILE_NO_FLAGS);
+        assert(keymap);
+        xkb_keymap_unref(keymap);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    elapsed = (stop.tv_sec - start.tv_sec) * 1e3 +
+              (stop.tv_nsec - start.tv_nsec) / 1e6;
+    fprintf(stderr, "%s: %.2fms per keymap (%d iterations)\n",
+            what, elapsed / BENCHMARK_ITERATIONS, BENCHMARK_ITERATIONS);
+    return true;
+}
+
+int
+main(void)
+{
+    struct xkb_context *ctx = test_get_context(0);
+    xcb_connection_t *conn;
+    pthread_t thread;
+    struct relay relay;
+
+    assert(ctx);
+
+    conn = xcb_connect(NULL, NULL);
+    if (!conn || !bench(ctx, conn, "direct")) {
+        xcb_disconnect(conn);
+        xkb_context_unref(ctx);
+        return SKIP_TEST;
+    }
+    xkb_x11_context_forget_connection(ctx, conn);
+    xcb_disconnect(conn);
+
+    conn = connect_with_latency(&thread, &relay);
+    if (conn) {
+        fprintf(stderr, "adding %dms of latency\n", LATENCY_MS);
+        if (!bench(ctx, conn, "with latency"))
+            fprintf(stderr, "couldn't use the X server through a relay\n");
+        xkb_x11_context_forget_connection(ctx, conn);
+        xcb_disconnect(conn);
+    }
+
+    xkb_context_unref(ctx);
+    return 0;
+}
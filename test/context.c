@@ -23,8 +23,134 @@
  * Author: Daniel Stone <daniel@fooishbar.org>
  */
 
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
 #include "test.h"
 #include "context.h"
+#include "xkbcomp-priv.h"
+#include "include.h"
+
+static void
+test_include_dirs(void)
+{
+    char dir[] = "/tmp/xkb-include-XXXXXX";
+    char path[PATH_MAX];
+    struct xkb_context *ctx;
+    struct xkb_file_source src;
+    FILE *file;
+
+    assert(mkdtemp(dir));
+    snprintf(path, sizeof(path), "%s/keycodes", dir);
+    assert(mkdir(path, 0700) == 0);
+
+    ctx = test_get_context(0);
+    assert(ctx);
+    xkb_context_set_log_level(ctx, XKB_LOG_LEVEL_CRITICAL);
+    xkb_context_include_path_clear(ctx);
+    assert(xkb_context_include_path_append(ctx, dir));
+
+    assert(!FindFileInXkbPath(ctx, "foo", FILE_TYPE_KEYCODES, NULL, &src));
+
+    /* New files are picked up once the index is revalidated. */
+    snprintf(path, sizeof(path), "%s/keycodes/foo", dir);
+    file = fopen(path, "w");
+    assert(file);
+    fclose(file);
+    xkb_context_invalidate_include_dirs(ctx);
+
+    assert(FindFileInXkbPath(ctx, "foo", FILE_TYPE_KEYCODES, NULL, &src));
+    assert(src.file);
+    CloseXkbFileSource(&src);
+    assert(!FindFileInXkbPath(ctx, "bar", FILE_TYPE_KEYCODES, NULL, &src));
+
+    assert(unlink(path) == 0);
+    xkb_context_invalidate_include_dirs(ctx);
+    assert(!FindFileInXkbPath(ctx, "foo", FILE_TYPE_KEYCODES, NULL, &src));
+
+    xkb_context_unref(ctx);
+
+    snprintf(path, sizeof(path), "%s/keycodes", dir);
+    assert(rmdir(path) == 0);
+    assert(rmdir(dir) == 0);
+}
+
+#define NUM_THREADS 4
+
+static const char *thread_layouts[] = { "us", "de", "us,de", "ru" };
+
+struct compile_thread {
+    pthread_t thread;
+    struct xkb_context *ctx;
+    char *dumps[ARRAY_SIZE(thread_layouts)];
+};
+
+static void *
+compile_layouts(void *data)
+{
+    struct compile_thread *thread = data;
+
+    for (unsigned i = 0; i < ARRAY_SIZE(thread_layouts); i++) {
+        struct xkb_rule_names rmlvo = {
+            "evdev", "pc105", thread_layouts[i], NULL, NULL
+        };
+        struct xkb_keymap *keymap;
+
+        keymap = xkb_keymap_new_from_names(thread->ctx, &rmlvo, 0);
+        assert(keymap);
+        thread->dumps[i] =
+            xkb_keymap_get_as_string(keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
+        assert(thread->dumps[i]);
+        xkb_keymap_unref(keymap);
+    }
+
+    return NULL;
+}
+
+static void
+test_thread_safe(enum xkb_context_flags flags)
+{
+    struct xkb_context *ctx;
+    struct compile_thread threads[NUM_THREADS];
+    char *path;
+
+    ctx = xkb_context_new(XKB_CONTEXT_NO_DEFAULT_INCLUDES |
+                          XKB_CONTEXT_NO_ENVIRONMENT_NAMES |
+                          XKB_CONTEXT_THREAD_SAFE | flags);
+#ifndef THREAD_LOCAL
+    /* Not supported without thread-local storage. */
+    assert(!ctx);
+    return;
+#endif
+    assert(ctx);
+    path = test_get_path("");
+    assert(xkb_context_include_path_append(ctx, path));
+    free(path);
+
+    for (int i = 0; i < NUM_THREADS; i++) {
+        threads[i].ctx = ctx;
+        assert(pthread_create(&threads[i].thread, NULL,
+                              compile_layouts, &threads[i]) == 0);
+    }
+
+    for (int i = 0; i < NUM_THREADS; i++)
+        assert(pthread_join(threads[i].thread, NULL) == 0);
+
+    /* All threads got the same keymaps. */
+    for (int i = 0; i < NUM_THREADS; i++) {
+        for (unsigned j = 0; j < ARRAY_SIZE(thread_layouts); j++) {
+            assert(streq(threads[i].dumps[j], threads[0].dumps[j]));
+            if (i > 0)
+                free(threads[i].dumps[j]);
+        }
+    }
+    for (unsigned j = 0; j < ARRAY_SIZE(thread_layouts); j++)
+        free(threads[0].dumps[j]);
+
+    xkb_context_unref(ctx);
+}
 
 int
 main(void)
@@ -48,5 +174,9 @@ main(void)
 
     xkb_context_unref(context);
 
+    test_include_dirs();
+    test_thread_safe(0);
+    test_thread_safe(XKB_CONTEXT_CACHE_KEYMAPS);
+
     return 0;
 }
@@ -0,0 +1,118 @@
+/*
+ * Copyright © 2014 The libxkbcommon authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+
+#include "test.h"
+#include "context.h"
+
+/*
+ * A provider which serves the files from the test data, as an
+ * application would serve its bundled files.
+ */
+struct provider {
+    unsigned int num_calls;
+    unsigned int num_provided;
+    char *files[256];
+};
+
+static int
+include_fn(struct xkb_context *ctx, const char *type, const char *name,
+           const char **buffer_out, size_t *length_out)
+{
+    struct provider *provider = xkb_context_get_user_data(ctx);
+    char path_rel[PATH_MAX];
+    char *file;
+
+    provider->num_calls++;
+
+    snprintf(path_rel, sizeof(path_rel), "%s/%s", type, name);
+    file = test_read_file(path_rel);
+    if (!file)
+        return 0;
+
+    assert(provider->num_provided < ARRAY_SIZE(provider->files));
+    provider->files[provider->num_provided++] = file;
+
+    *buffer_out = file;
+    *length_out = strlen(file);
+    return 1;
+}
+
+static int
+decline_fn(struct xkb_context *ctx, const char *type, const char *name,
+           const char **buffer_out, size_t *length_out)
+{
+    struct provider *provider = xkb_context_get_user_data(ctx);
+
+    provider->num_calls++;
+    return 0;
+}
+
+int
+main(void)
+{
+    struct xkb_context *ctx;
+    struct xkb_keymap *keymap;
+    struct provider provider = { 0 };
+    struct xkb_rule_names rmlvo = {
+        "evdev", "pc105", "us,de", "", "grp:alt_shift_toggle",
+    };
+
+    /* No include paths; everything comes from the provider. */
+    ctx = xkb_context_new(XKB_CONTEXT_NO_DEFAULT_INCLUDES |
+                          XKB_CONTEXT_NO_ENVIRONMENT_NAMES);
+    assert(ctx);
+    assert(xkb_context_num_include_paths(ctx) == 0);
+    xkb_context_set_user_data(ctx, &provider);
+
+    keymap = xkb_keymap_new_from_names(ctx, &rmlvo, 0);
+    assert(!keymap);
+
+    xkb_context_set_include_fn(ctx, include_fn);
+    keymap = xkb_keymap_new_from_names(ctx, &rmlvo, 0);
+    assert(keymap);
+    assert(provider.num_provided > 0);
+    assert(xkb_keymap_num_layouts(keymap) == 2);
+    xkb_keymap_unref(keymap);
+
+    /* The provided rules file is compiled only once. */
+    keymap = xkb_keymap_new_from_names(ctx, &rmlvo, 0);
+    assert(keymap);
+    xkb_keymap_unref(keymap);
+    assert(darray_size(ctx->rules_dbs) == 1);
+
+    /* Declining falls back to the (empty) include path. */
+    xkb_context_set_include_fn(ctx, decline_fn);
+    provider.num_calls = 0;
+    keymap = xkb_keymap_new_from_names(ctx, &rmlvo, 0);
+    assert(!keymap);
+    assert(provider.num_calls == 1);
+
+    xkb_context_unref(ctx);
+
+    for (unsigned i = 0; i < provider.num_provided; i++)
+        free(provider.files[i]);
+
+    return 0;
+}
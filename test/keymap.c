@@ -0,0 +1,103 @@
+/*
+ * Copyright © 2014 The libxkbcommon authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "test.h"
+#include "keymap.h"
+
+struct level_stats {
+    unsigned num_groups;
+    unsigned num_shared;
+};
+
+static void
+get_level_stats(struct xkb_keymap *keymap, struct level_stats *stats)
+{
+    const struct xkb_key *key;
+
+    memset(stats, 0, sizeof(*stats));
+
+    xkb_keys_foreach(key, keymap) {
+        for (xkb_layout_index_t i = 0; i < key->num_groups; i++) {
+            stats->num_groups++;
+            if (key->groups[i].shared_levels)
+                stats->num_shared++;
+        }
+    }
+}
+
+static void
+test_shared_levels(struct xkb_context *ctx, const char *layout)
+{
+    struct xkb_keymap *keymap;
+    struct level_stats stats;
+
+    keymap = test_compile_rules(ctx, "evdev", "pc105", layout, NULL, NULL);
+    assert(keymap);
+
+    get_level_stats(keymap, &stats);
+    assert(stats.num_shared > 0);
+    assert(stats.num_shared < stats.num_groups);
+
+    xkb_keymap_unref(keymap);
+}
+
+int
+main(void)
+{
+    struct xkb_context *ctx = test_get_context(0);
+    struct xkb_keymap *keymap;
+    const struct xkb_key *key;
+
+    assert(ctx);
+
+    /* The actions are stored packed in the levels. */
+    assert(sizeof(union xkb_packed_action) <= 8);
+
+    test_shared_levels(ctx, "us");
+    test_shared_levels(ctx, "us,de,ru");
+
+    /* Every shared array has an owner, which frees it. */
+    keymap = test_compile_rules(ctx, "evdev", "pc105", "us,de", NULL, NULL);
+    assert(keymap);
+    xkb_keys_foreach(key, keymap) {
+        for (xkb_layout_index_t i = 0; i < key->num_groups; i++) {
+            const struct xkb_key *other;
+            unsigned num_owners = 0;
+
+            if (!key->groups[i].shared_levels)
+                continue;
+
+            xkb_keys_foreach(other, keymap)
+                for (xkb_layout_index_t j = 0; j < other->num_groups; j++)
+                    if (!other->groups[j].shared_levels &&
+                        other->groups[j].levels == key->groups[i].levels)
+                        num_owners++;
+            assert(num_owners == 1);
+        }
+    }
+    xkb_keymap_unref(keymap);
+
+    xkb_context_unref(ctx);
+
+    return 0;
+}
@@ -23,6 +23,7 @@
 
 #include "test.h"
 #include "keysym.h" /* For unexported is_lower/upper/keypad() */
+#include "utf8.h"
 
 static int
 test_string(const char *string, xkb_keysym_t expected)
@@ -81,6 +82,52 @@ test_utf8(xkb_keysym_t keysym, const char *expected)
     return streq(s, expected);
 }
 
+static void
+test_utf8_batch(void)
+{
+    const xkb_keysym_t syms[] = {
+        XKB_KEY_H, XKB_KEY_e, XKB_KEY_l, XKB_KEY_l, XKB_KEY_o,
+        XKB_KEY_comma, XKB_KEY_space, XKB_KEY_w, XKB_KEY_o, XKB_KEY_r,
+        XKB_KEY_l, XKB_KEY_d, XKB_KEY_exclam, XKB_KEY_space,
+        XKB_KEY_Cyrillic_em, XKB_KEY_Shift_L, XKB_KEY_oslash,
+        XKB_KEY_Return, 0x101f600, XKB_KEY_x,
+    };
+    const char *expected = "Hello, world! \xd0\xbc\xc3\xb8\r\xf0\x9f\x98\x80x";
+    const int len = strlen(expected);
+    char s[64];
+    int ret;
+
+    assert(xkb_keysyms_to_utf8(syms, ARRAY_SIZE(syms), NULL, 0) == len);
+    assert(xkb_keysyms_to_utf8(syms, 0, s, sizeof(s)) == 0);
+    assert(s[0] == '\0');
+
+    ret = xkb_keysyms_to_utf8(syms, ARRAY_SIZE(syms), s, sizeof(s));
+    assert(ret == len);
+    assert(streq(s, expected));
+
+    /* Truncation does not split the UTF-8 sequence of a keysym. */
+    for (int size = 1; size <= len + 1; size++) {
+        ret = xkb_keysyms_to_utf8(syms, ARRAY_SIZE(syms), s, size);
+        assert(ret == len);
+        assert((int) strlen(s) < size);
+        assert(strncmp(s, expected, strlen(s)) == 0);
+        assert(is_valid_utf8(s, strlen(s)));
+    }
+    ret = xkb_keysyms_to_utf8(syms, ARRAY_SIZE(syms), s, 17);
+    assert(streq(s, "Hello, world! \xd0\xbc"));
+
+    /* Each keysym on its own agrees with xkb_keysym_to_utf8(). */
+    for (xkb_keysym_t ks = 0; ks < 0x11000; ks++) {
+        char one[8], many[8];
+        xkb_keysym_t sym = ks < 0x10000 ? ks : 0x1000000 + ks;
+        int n = xkb_keysym_to_utf8(sym, one, sizeof(one));
+
+        ret = xkb_keysyms_to_utf8(&sym, 1, many, sizeof(many));
+        assert(ret == (n > 0 ? n - 1 : 0));
+        assert(n <= 0 || streq(one, many));
+    }
+}
+
 int
 main(void)
 {
@@ -155,6 +202,8 @@ main(void)
     assert(test_utf8(XKB_KEY_KP_Multiply, "*"));
     assert(test_utf8(XKB_KEY_KP_Subtract, "-"));
 
+    test_utf8_batch();
+
     assert(xkb_keysym_is_lower(XKB_KEY_a));
     assert(xkb_keysym_is_lower(XKB_KEY_Greek_lambda));
     assert(xkb_keysym_is_lower(xkb_keysym_from_name("U03b1", 0))); /* GREEK SMALL LETTER ALPHA */
@@ -196,5 +245,16 @@ main(void)
     assert(xkb_keysym_to_upper(XKB_KEY_eacute) == XKB_KEY_Eacute);
     assert(xkb_keysym_to_lower(XKB_KEY_Eacute) == XKB_KEY_eacute);
 
+    /* Scripts beyond the legacy keysyms. */
+    assert(xkb_keysym_to_upper(0x10010d0) == 0x1001c90); /* GEORGIAN LETTER AN */
+    assert(xkb_keysym_to_lower(0x1001c90) == 0x10010d0); /* GEORGIAN MTAVRULI CAPITAL LETTER AN */
+    assert(xkb_keysym_to_lower(0x10013a0) == 0x100ab70); /* CHEROKEE LETTER A */
+    assert(xkb_keysym_to_upper(0x101e922) == 0x101e900); /* ADLAM SMALL LETTER ALIF */
+    assert(xkb_keysym_is_upper(0x1002c00)); /* GLAGOLITIC CAPITAL LETTER AZU */
+    assert(xkb_keysym_is_lower(0x1002c30)); /* GLAGOLITIC SMALL LETTER AZU */
+    assert(!xkb_keysym_is_lower(0x10001c5)); /* LATIN CAPITAL LETTER D WITH SMALL LETTER Z WITH CARON */
+    assert(!xkb_keysym_is_upper(0x10001c5));
+    assert(xkb_keysym_to_upper(0x1ffffff) == 0x1ffffff);
+
     return 0;
 }
@@ -21,12 +21,17 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <dirent.h>
+#include <stdlib.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "test.h"
 #include "xkbcomp-priv.h"
 #include "rules.h"
 
+#pragma GCC diagnostic ignored "-Wmissing-format-attribute"
+
 #define BENCHMARK_ITERATIONS 20000
 
 struct test_data {
@@ -88,6 +93,54 @@ test_rules(struct xkb_context *ctx, struct test_data *data)
     return passed;
 }
 
+static bool
+test_rules_batch(struct xkb_context *ctx, struct test_data **data,
+                 size_t num)
+{
+    struct xkb_rule_names rmlvo[num];
+    struct xkb_component_names kccgst[num];
+    size_t num_resolved, num_expected = 0;
+    bool passed = true;
+
+    for (size_t i = 0; i < num; i++) {
+        rmlvo[i].rules = data[i]->rules;
+        rmlvo[i].model = data[i]->model;
+        rmlvo[i].layout = data[i]->layout;
+        rmlvo[i].variant = data[i]->variant;
+        rmlvo[i].options = data[i]->options;
+        if (!data[i]->should_fail)
+            num_expected++;
+    }
+
+    num_resolved = xkb_context_resolve_rule_names(ctx, rmlvo, num, kccgst);
+    if (num_resolved != num_expected) {
+        fprintf(stderr, "Batch resolved %zu names, expected %zu\n",
+                num_resolved, num_expected);
+        passed = false;
+    }
+
+    for (size_t i = 0; i < num; i++) {
+        if (data[i]->should_fail) {
+            passed = passed && !kccgst[i].keycodes && !kccgst[i].types &&
+                     !kccgst[i].compat && !kccgst[i].symbols;
+            continue;
+        }
+
+        passed = passed &&
+                 streq_not_null(kccgst[i].keycodes, data[i]->keycodes) &&
+                 streq_not_null(kccgst[i].types, data[i]->types) &&
+                 streq_not_null(kccgst[i].compat, data[i]->compat) &&
+                 streq_not_null(kccgst[i].symbols, data[i]->symbols);
+
+        free(kccgst[i].keycodes);
+        free(kccgst[i].types);
+        free(kccgst[i].compat);
+        free(kccgst[i].symbols);
+    }
+
+    return passed;
+}
+
 static void
 benchmark(struct xkb_context *ctx)
 {
@@ -127,6 +180,74 @@ benchmark(struct xkb_context *ctx)
             BENCHMARK_ITERATIONS, elapsed.tv_sec, elapsed.tv_nsec);
 }
 
+static bool read_from_cache;
+
+ATTR_PRINTF(3, 0) static void
+cache_log_fn(struct xkb_context *ctx, enum xkb_log_level level,
+             const char *fmt, va_list args)
+{
+    char buf[1024];
+
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    if (strstr(buf, "from cache file"))
+        read_from_cache = true;
+}
+
+static void
+test_rules_cache(void)
+{
+    char cache_dir[] = "/tmp/xkb-rules-cache-XXXXXX";
+    struct xkb_context *ctx;
+    DIR *dir;
+    struct dirent *ent;
+    struct test_data data = {
+        .rules = "groups",
+
+        .model = "foo", .layout = "ar", .variant = "bar", .options = "",
+
+        .keycodes = "default_keycodes", .types = "default_types",
+        .compat = "default_compat", .symbols = "my_symbols+(bar)",
+    };
+
+    /* A rules file is only compiled once per context. */
+    ctx = test_get_context(0);
+    assert(ctx);
+    assert(test_rules(ctx, &data));
+    assert(test_rules(ctx, &data));
+    assert(darray_size(ctx->rules_dbs) == 1);
+    xkb_context_unref(ctx);
+
+    /* The first context writes the cache file, the second reads it. */
+    assert(mkdtemp(cache_dir));
+    setenv("XKB_RULES_CACHE_DIR", cache_dir, 1);
+
+    for (int i = 0; i < 2; i++) {
+        ctx = test_get_context(0);
+        assert(ctx);
+        xkb_context_set_log_level(ctx, XKB_LOG_LEVEL_DEBUG);
+        xkb_context_set_log_fn(ctx, cache_log_fn);
+        read_from_cache = false;
+        assert(test_rules(ctx, &data));
+        assert(read_from_cache == (i == 1));
+        xkb_context_unref(ctx);
+    }
+
+    unsetenv("XKB_RULES_CACHE_DIR");
+
+    dir = opendir(cache_dir);
+    assert(dir);
+    while ((ent = readdir(dir))) {
+        char path[PATH_MAX];
+
+        if (ent->d_name[0] == '.')
+            continue;
+        snprintf(path, sizeof(path), "%s/%s", cache_dir, ent->d_name);
+        unlink(path);
+    }
+    closedir(dir);
+    assert(rmdir(cache_dir) == 0);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -216,6 +337,54 @@ main(int argc, char *argv[])
     };
     assert(test_rules(ctx, &test7));
 
+    struct test_data test8 = {
+        .rules = "groups",
+
+        .model = "pc105", .layout = "br", .variant = "bar",
+        .options = "caps:none,grp:win_space_toggle",
+
+        .keycodes = "something(pc105)", .types = "default_types",
+        .compat = "default_compat", .symbols = "my_symbols+(bar)+group(br)",
+    };
+    assert(test_rules(ctx, &test8));
+
+    /* A repeated option only applies its rules once. */
+    struct test_data test9 = {
+        .rules = "multiple-options",
+
+        .model = "my_model", .layout = "my_layout", .variant = "my_variant",
+        .options = "option3,option3,colon:opt",
+
+        .keycodes = "my_keycodes", .types = "my_types",
+        .compat = "my_compat",
+        .symbols = "my_symbols+extra_variant+compose(foo)+keypad(bar)+altwin(menu)",
+    };
+    assert(test_rules(ctx, &test9));
+
+    struct test_data missing = {
+        .rules = "does-not-exist",
+
+        .model = "my_model", .layout = "my_layout", .variant = "",
+        .options = "",
+
+        .should_fail = true
+    };
+
+    /*
+     * Names with empty fields would get default values, which the test
+     * rules don't know.
+     */
+    struct test_data *batch[] = {
+        &test1, &test4, &test7, &test1, &missing, &test8, &test9, &test1,
+    };
+    enum xkb_log_level level = xkb_context_get_log_level(ctx);
+    xkb_context_set_log_level(ctx, XKB_LOG_LEVEL_CRITICAL);
+    assert(test_rules_batch(ctx, batch, ARRAY_SIZE(batch)));
+    xkb_context_set_log_level(ctx, level);
+
     xkb_context_unref(ctx);
+
+    test_rules_cache();
+
     return 0;
 }
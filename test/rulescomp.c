@@ -25,6 +25,7 @@
 #include <time.h>
 
 #include "test.h"
+#include "context.h"
 
 #define BENCHMARK_ITERATIONS 2500
 
@@ -124,6 +125,172 @@ test_rmlvo_env(struct xkb_context *ctx, const char *rules, const char *model,
     return ret;
 }
 
+/*
+ * Check that deriving a keymap from @base gives the same result as
+ * compiling it from scratch.
+ */
+static struct xkb_keymap *
+test_derived(struct xkb_context *ctx, struct xkb_keymap *base,
+             const char *rules, const char *model, const char *layout,
+             const char *variant, const char *options)
+{
+    struct xkb_keymap *derived, *fresh;
+    char *derived_str, *fresh_str;
+    struct xkb_rule_names rmlvo = {
+        .rules = rules,
+        .model = model,
+        .layout = layout,
+        .variant = variant,
+        .options = options,
+    };
+
+    derived = xkb_keymap_new_from_names_derived(base, &rmlvo, 0);
+    assert(derived);
+    fresh = xkb_keymap_new_from_names(ctx, &rmlvo, 0);
+    assert(fresh);
+
+    derived_str = xkb_keymap_get_as_string(derived, XKB_KEYMAP_FORMAT_TEXT_V1);
+    fresh_str = xkb_keymap_get_as_string(fresh, XKB_KEYMAP_FORMAT_TEXT_V1);
+    assert(derived_str && fresh_str);
+    assert(streq(derived_str, fresh_str));
+
+    free(derived_str);
+    free(fresh_str);
+    xkb_keymap_unref(fresh);
+
+    return derived;
+}
+
+static void
+test_derive_keymaps(struct xkb_context *ctx)
+{
+    struct xkb_keymap *base, *nocaps, *ru, *other_rules, *keymap;
+
+    base = test_compile_rules(ctx, "evdev", "pc105", "us", "", "");
+    assert(base);
+
+    nocaps = test_derived(ctx, base, "evdev", "pc105", "us", "",
+                          "ctrl:nocaps");
+    assert(test_key_seq(nocaps,
+                        KEY_CAPSLOCK,   BOTH, XKB_KEY_Control_L,        FINISH));
+
+    /* Derive in turn from a derived keymap. */
+    ru = test_derived(ctx, nocaps, "evdev", "pc105", "us,ru", "",
+                      "ctrl:nocaps,grp:alts_toggle,grp_led:scroll");
+    assert(test_key_seq(ru,
+                        KEY_CAPSLOCK,   BOTH, XKB_KEY_Control_L,        NEXT,
+                        KEY_LEFTALT,    DOWN, XKB_KEY_Alt_L,            NEXT,
+                        KEY_RIGHTALT,   DOWN, XKB_KEY_ISO_Next_Group,   NEXT,
+                        KEY_RIGHTALT,   UP,   XKB_KEY_ISO_Next_Group,   NEXT,
+                        KEY_LEFTALT,    UP,   XKB_KEY_Alt_L,            NEXT,
+                        KEY_Q,          BOTH, XKB_KEY_Cyrillic_shorti,  FINISH));
+
+    /* Nothing changed; still gives a correct keymap. */
+    keymap = test_derived(ctx, ru, "evdev", "pc105", "us,ru", "",
+                          "ctrl:nocaps,grp:alts_toggle,grp_led:scroll");
+    xkb_keymap_unref(keymap);
+
+    /* Everything changed. */
+    other_rules = test_derived(ctx, base, "base", "empty", "empty", "", "");
+    keymap = test_derived(ctx, other_rules, "evdev", "pc105", "us", "",
+                          "");
+    xkb_keymap_unref(keymap);
+
+    /* Not created from names; compiled from scratch. */
+    keymap = test_compile_file(ctx, "keymaps/stringcomp.data");
+    assert(keymap);
+    xkb_keymap_unref(test_derived(ctx, keymap, "evdev", "", "us", "", ""));
+    xkb_keymap_unref(keymap);
+
+    xkb_keymap_unref(other_rules);
+    xkb_keymap_unref(ru);
+    xkb_keymap_unref(nocaps);
+    xkb_keymap_unref(base);
+}
+
+static void
+test_keymap_cache(void)
+{
+    struct xkb_context *ctx;
+    struct xkb_keymap *a, *b, *c, *d;
+    char *path;
+    struct xkb_rule_names names = {
+        "evdev", "pc105", "us,ru", "", "grp:alts_toggle,ctrl:nocaps",
+    };
+    struct xkb_rule_names same = {
+        "evdev", "pc105", "us , ru", " ", "ctrl:nocaps,,grp:alts_toggle",
+    };
+    struct xkb_rule_names other = {
+        "evdev", "pc105", "ru,us", "", "grp:alts_toggle,ctrl:nocaps",
+    };
+    /* Layouts and variants are positional, even when empty. */
+    struct xkb_rule_names second = {
+        "evdev", "pc105", "de,de", ",nodeadkeys", "",
+    };
+    struct xkb_rule_names first = {
+        "evdev", "pc105", "de,de", "nodeadkeys", "",
+    };
+
+    ctx = xkb_context_new(XKB_CONTEXT_NO_DEFAULT_INCLUDES |
+                          XKB_CONTEXT_NO_ENVIRONMENT_NAMES |
+                          XKB_CONTEXT_CACHE_KEYMAPS);
+    assert(ctx);
+    path = test_get_path("");
+    assert(path);
+    assert(xkb_context_include_path_append(ctx, path));
+    free(path);
+
+    a = xkb_keymap_new_from_names(ctx, &names, 0);
+    assert(a);
+    b = xkb_keymap_new_from_names(ctx, &same, 0);
+    assert(b == a);
+    c = xkb_keymap_new_from_names(ctx, &other, 0);
+    assert(c && c != a);
+    xkb_keymap_unref(c);
+
+    c = xkb_keymap_new_from_names(ctx, &second, 0);
+    d = xkb_keymap_new_from_names(ctx, &first, 0);
+    assert(c && d && c != d);
+    assert(streq(xkb_keymap_layout_get_name(c, 1),
+                 "German (eliminate dead keys)"));
+    assert(streq(xkb_keymap_layout_get_name(d, 1), "German"));
+    xkb_keymap_unref(c);
+    xkb_keymap_unref(d);
+
+    /* Still alive through b. */
+    xkb_keymap_unref(a);
+    a = xkb_keymap_new_from_names(ctx, &names, 0);
+    assert(a == b);
+    xkb_keymap_unref(a);
+    xkb_keymap_unref(b);
+    assert(darray_empty(ctx->keymap_cache));
+
+    /* Changing the include path drops the cache. */
+    a = xkb_keymap_new_from_names(ctx, &names, 0);
+    assert(a);
+    assert(darray_size(ctx->keymap_cache) == 1);
+    path = test_get_path("");
+    assert(path);
+    assert(xkb_context_include_path_append(ctx, path));
+    free(path);
+    assert(darray_empty(ctx->keymap_cache));
+    b = xkb_keymap_new_from_names(ctx, &names, 0);
+    assert(b && b != a);
+    xkb_keymap_unref(a);
+    xkb_keymap_unref(b);
+
+    xkb_context_unref(ctx);
+
+    /* Not enabled by default. */
+    ctx = test_get_context(0);
+    a = xkb_keymap_new_from_names(ctx, &names, 0);
+    b = xkb_keymap_new_from_names(ctx, &names, 0);
+    assert(a && b && a != b);
+    xkb_keymap_unref(a);
+    xkb_keymap_unref(b);
+    xkb_context_unref(ctx);
+}
+
 static void
 benchmark(struct xkb_context *context)
 {
@@ -245,6 +412,8 @@ main(int argc, char *argv[])
     assert(test_rmlvo_env(ctx, "broken", "but", "ignored", "per", "ctx flags",
                           KEY_A,          BOTH, XKB_KEY_a,                FINISH));
 
+    test_derive_keymaps(ctx);
+
     /* Test response to invalid flags. */
     {
         struct xkb_rule_names rmlvo = { NULL };
@@ -253,4 +422,6 @@ main(int argc, char *argv[])
     }
 
     xkb_context_unref(ctx);
+
+    test_keymap_cache();
 }
@@ -22,13 +22,289 @@
  */
 
 #include <assert.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 #include "test.h"
 
 #define DATA_PATH "keymaps/stringcomp.data"
 
+struct write_state {
+    char *data;
+    size_t size;
+    size_t calls;
+    size_t fail_after;
+};
+
+static int
+write_fn(void *user_data, const char *data, size_t length)
+{
+    struct write_state *state = user_data;
+
+    if (++state->calls > state->fail_after)
+        return 0;
+
+    state->data = realloc(state->data, state->size + length + 1);
+    assert(state->data);
+    memcpy(state->data + state->size, data, length);
+    state->size += length;
+    state->data[state->size] = '\0';
+    return 1;
+}
+
+static void
+test_write(struct xkb_keymap *keymap, const char *expected)
+{
+    struct write_state state = { NULL, 0, 0, (size_t) -1 };
+    FILE *file;
+    char *written;
+    long size;
+
+    /* Streamed in pieces, which add up to the string. */
+    assert(xkb_keymap_write(keymap, XKB_KEYMAP_USE_ORIGINAL_FORMAT,
+                            write_fn, &state));
+    assert(state.calls > 1);
+    assert(streq(state.data, expected));
+    free(state.data);
+
+    /* A failing write function stops the writing. */
+    state = (struct write_state) { NULL, 0, 0, 1 };
+    assert(!xkb_keymap_write(keymap, XKB_KEYMAP_USE_ORIGINAL_FORMAT,
+                             write_fn, &state));
+    assert(state.calls == 2);
+    free(state.data);
+
+    assert(!xkb_keymap_write(keymap, 0, write_fn, &state));
+
+    file = tmpfile();
+    assert(file);
+    assert(xkb_keymap_write_to_fd(keymap, XKB_KEYMAP_FORMAT_TEXT_V1,
+                                  fileno(file)));
+    size = lseek(fileno(file), 0, SEEK_CUR);
+    assert(size == (long) strlen(expected));
+    written = malloc(size + 1);
+    assert(written);
+    assert(pread(fileno(file), written, size, 0) == size);
+    written[size] = '\0';
+    assert(streq(written, expected));
+    free(written);
+    fclose(file);
+
+    assert(!xkb_keymap_write_to_fd(keymap, XKB_KEYMAP_FORMAT_TEXT_V1, -1));
+}
+
+static void
+test_get_as_fd(struct xkb_keymap *keymap, const char *expected)
+{
+    size_t size, size2;
+    char *map, *dump;
+    int fd;
+
+    fd = xkb_keymap_get_as_fd(keymap, XKB_KEYMAP_USE_ORIGINAL_FORMAT, &size);
+    if (fd < 0) {
+        assert(errno == ENOSYS);
+        return;
+    }
+    assert(size == strlen(expected) + 1);
+
+    /* Shared, not recreated. */
+    assert(xkb_keymap_get_as_fd(keymap, XKB_KEYMAP_FORMAT_TEXT_V1,
+                                &size2) == fd);
+    assert(size2 == size);
+
+    map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    assert(map != MAP_FAILED);
+    assert(map[size - 1] == '\0');
+    assert(streq(map, expected));
+    munmap(map, size);
+
+    /* Sealed against writing and resizing. */
+    assert(pwrite(fd, "x", 1, 0) < 0);
+    assert(ftruncate(fd, 0) < 0);
+    assert(mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                fd, 0) == MAP_FAILED);
+
+    /* The string comes from the same serialization. */
+    dump = xkb_keymap_get_as_string(keymap, XKB_KEYMAP_USE_ORIGINAL_FORMAT);
+    assert(dump);
+    assert(streq(dump, expected));
+    free(dump);
+
+    assert(xkb_keymap_get_as_fd(keymap, 0, NULL) < 0);
+}
+
+/* Press and release every key, as a user of a loaded keymap would. */
+static void
+press_all_keys(struct xkb_keymap *keymap)
+{
+    struct xkb_state *state = xkb_state_new(keymap);
+    const xkb_keysym_t *syms;
+
+    assert(state);
+
+    for (xkb_keycode_t kc = xkb_keymap_min_keycode(keymap);
+         kc <= xkb_keymap_max_keycode(keymap); kc++) {
+        xkb_state_update_key(state, kc, XKB_KEY_DOWN);
+        xkb_state_key_get_syms(state, kc, &syms);
+        xkb_state_key_get_utf32(state, kc);
+        xkb_state_update_key(state, kc, XKB_KEY_UP);
+    }
+
+    xkb_state_unref(state);
+}
+
+/*
+ * A binary keymap with one key, with one group of a type with
+ * @num_levels levels (0 or 1), redirecting out of range groups to
+ * @redirect.
+ */
+static struct xkb_keymap *
+load_tiny_binary(struct xkb_context *ctx, uint8_t num_levels,
+                 uint8_t redirect)
+{
+    unsigned char body[64];
+    char data[sizeof(body) + 6];
+    size_t n = 0;
+
+    body[n++] = 0;                      /* strings */
+    body[n++] = 0;                      /* enabled controls */
+    body[n++] = 0; body[n++] = 0;       /* section names */
+    body[n++] = 0; body[n++] = 0;
+    body[n++] = 0;                      /* modifiers */
+    body[n++] = 1;                      /* types */
+    body[n++] = 0;                      /*   name */
+    body[n++] = 0; body[n++] = 0;       /*   mods */
+    body[n++] = num_levels;
+    for (uint8_t i = 0; i < num_levels; i++)
+        body[n++] = 0;                  /*   level name */
+    body[n++] = 0;                      /*   entries */
+    body[n++] = 0;                      /* interprets */
+    body[n++] = 0;                      /* LEDs */
+    body[n++] = 1;                      /* groups */
+    body[n++] = 0;                      /* group names */
+    body[n++] = 0;                      /* key aliases */
+    body[n++] = 8; body[n++] = 8;       /* keycodes */
+    body[n++] = 0;                      /* key name */
+    body[n++] = 0; body[n++] = 0;       /*   explicit, modmap */
+    body[n++] = 0; body[n++] = 0;       /*   vmodmap, repeats */
+    body[n++] = 2;                      /*   RANGE_REDIRECT */
+    body[n++] = redirect;
+    body[n++] = 1;                      /*   groups */
+    body[n++] = 0; body[n++] = 0;       /*     flags, type */
+    for (uint8_t i = 0; i < num_levels; i++) {
+        body[n++] = 0;                  /*     no action */
+        body[n++] = 1;                  /*     one keysym */
+        body[n++] = XKB_KEY_a;
+    }
+
+    memcpy(data, "xkbB", 4);
+    data[4] = 1;                        /* version */
+    data[5] = n;                        /* size */
+    memcpy(data + 6, body, n);
+
+    return xkb_keymap_new_from_buffer(ctx, data, n + 6,
+                                      XKB_KEYMAP_FORMAT_BINARY_V1, 0);
+}
+
+static void
+test_binary_invalid(struct xkb_context *ctx)
+{
+    struct xkb_keymap *keymap;
+    enum xkb_log_level level;
+
+    keymap = load_tiny_binary(ctx, 1, 0);
+    assert(keymap);
+    press_all_keys(keymap);
+    xkb_keymap_unref(keymap);
+
+    level = xkb_context_get_log_level(ctx);
+    xkb_context_set_log_level(ctx, XKB_LOG_LEVEL_CRITICAL);
+    /* A type without levels, which would leave the key's levels NULL. */
+    assert(!load_tiny_binary(ctx, 0, 0));
+    /* A redirect to a group the key doesn't have. */
+    assert(!load_tiny_binary(ctx, 1, 1));
+    xkb_context_set_log_level(ctx, level);
+}
+
+static void
+test_binary(struct xkb_context *ctx, struct xkb_keymap *keymap)
+{
+    struct write_state state = { NULL, 0, 0, (size_t) -1 };
+    struct xkb_keymap *loaded, *derived;
+    struct xkb_rule_names rmlvo = {
+        .rules = "evdev", .model = "pc105", .layout = "us",
+    };
+    char *dump, *dump2, *copy;
+    enum xkb_log_level level;
+
+    assert(xkb_keymap_write(keymap, XKB_KEYMAP_FORMAT_BINARY_V1,
+                            write_fn, &state));
+    assert(!xkb_keymap_get_as_string(keymap, XKB_KEYMAP_FORMAT_BINARY_V1));
+
+    /* Loads back into the same keymap, without any compiling. */
+    loaded = xkb_keymap_new_from_buffer(ctx, state.data, state.size,
+                                        XKB_KEYMAP_FORMAT_BINARY_V1, 0);
+    assert(loaded);
+    dump = xkb_keymap_get_as_string(keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
+    dump2 = xkb_keymap_get_as_string(loaded, XKB_KEYMAP_FORMAT_TEXT_V1);
+    assert(dump && dump2);
+    assert(streq(dump, dump2));
+    assert(!xkb_keymap_get_as_string(loaded, XKB_KEYMAP_USE_ORIGINAL_FORMAT));
+    press_all_keys(loaded);
+    free(dump2);
+
+    /* Nothing to derive from; compiled from scratch. */
+    derived = xkb_keymap_new_from_names_derived(loaded, &rmlvo, 0);
+    assert(derived);
+    press_all_keys(derived);
+    xkb_keymap_unref(derived);
+    xkb_keymap_unref(loaded);
+
+    /* Trailing data, e.g. a NUL terminator, is ignored. */
+    loaded = xkb_keymap_new_from_buffer(ctx, state.data, state.size + 1,
+                                        XKB_KEYMAP_FORMAT_BINARY_V1, 0);
+    assert(loaded);
+    xkb_keymap_unref(loaded);
+
+    /* Nothing but the exact data is accepted as text, and vice versa. */
+    assert(!xkb_keymap_new_from_string(ctx, state.data,
+                                       XKB_KEYMAP_FORMAT_BINARY_V1, 0));
+    assert(!xkb_keymap_new_from_string(ctx, dump,
+                                       XKB_KEYMAP_FORMAT_BINARY_V1, 0));
+    free(dump);
+
+    /*
+     * Truncated data fails to load. Corrupted data may load, but must
+     * give a keymap which is safe to use.
+     */
+    level = xkb_context_get_log_level(ctx);
+    xkb_context_set_log_level(ctx, XKB_LOG_LEVEL_CRITICAL);
+    copy = malloc(state.size);
+    assert(copy);
+    for (size_t i = 0; i < state.size; i += 13) {
+        assert(!xkb_keymap_new_from_buffer(ctx, state.data, i,
+                                           XKB_KEYMAP_FORMAT_BINARY_V1, 0));
+
+        for (int j = 0; j < 2; j++) {
+            memcpy(copy, state.data, state.size);
+            copy[i] = (j == 0 ? copy[i] ^ 0xff : 0);
+            loaded = xkb_keymap_new_from_buffer(ctx, copy, state.size,
+                                                XKB_KEYMAP_FORMAT_BINARY_V1,
+                                                0);
+            if (loaded)
+                press_all_keys(loaded);
+            xkb_keymap_unref(loaded);
+        }
+    }
+    free(copy);
+    xkb_context_set_log_level(ctx, level);
+
+    free(state.data);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -64,6 +340,10 @@ main(int argc, char *argv[])
         assert(0);
     }
 
+    test_write(keymap, original);
+    test_get_as_fd(keymap, original);
+    test_binary(ctx, keymap);
+
     free(original);
     free(dump);
     xkb_keymap_unref(keymap);
@@ -78,6 +358,8 @@ main(int argc, char *argv[])
     assert(keymap);
     dump = xkb_keymap_get_as_string(keymap, XKB_KEYMAP_USE_ORIGINAL_FORMAT);
     assert(dump);
+    test_binary(ctx, keymap);
+    test_binary_invalid(ctx);
     xkb_keymap_unref(keymap);
     keymap = test_compile_string(ctx, dump);
     assert(keymap);
@@ -21,6 +21,8 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <xcb/xkb.h>
+
 #include "test.h"
 #include "xkbcommon/xkbcommon-x11.h"
 
@@ -66,11 +68,76 @@ main(void)
     assert(dump);
     fputs(dump, stdout);
 
-    /* TODO: Write some X11-specific tests. */
+    /* The second time, the atoms' names come from the cache. */
+    {
+        struct xkb_keymap *again;
+        char *again_dump;
+
+        again = xkb_x11_keymap_new_from_device(ctx, conn, device_id,
+                                               XKB_KEYMAP_COMPILE_NO_FLAGS);
+        assert(again);
+        again_dump = xkb_keymap_get_as_string(again,
+                                              XKB_KEYMAP_FORMAT_TEXT_V1);
+        assert(again_dump);
+        assert(streq(dump, again_dump));
+        free(again_dump);
+        xkb_keymap_unref(again);
+    }
+
+    /*
+     * Nothing changed on the server, so updating the keymap from events
+     * about any of its keys or names must give the same keymap.
+     */
+    {
+        xcb_xkb_map_notify_event_t map_notify = {
+            .xkbType = XCB_XKB_MAP_NOTIFY,
+            .deviceID = device_id,
+            .changed = XCB_XKB_MAP_PART_KEY_SYMS |
+                       XCB_XKB_MAP_PART_KEY_ACTIONS,
+            .minKeyCode = xkb_keymap_min_keycode(keymap),
+            .maxKeyCode = xkb_keymap_max_keycode(keymap),
+            .firstKeySym = 24,
+            .nKeySyms = 10,
+            .firstKeyAct = 30,
+            .nKeyActs = 10,
+        };
+        xcb_xkb_names_notify_event_t names_notify = {
+            .xkbType = XCB_XKB_NAMES_NOTIFY,
+            .deviceID = device_id,
+            .changed = XCB_XKB_NAME_DETAIL_KEY_NAMES |
+                       XCB_XKB_NAME_DETAIL_GROUP_NAMES |
+                       XCB_XKB_NAME_DETAIL_SYMBOLS,
+        };
+        struct xkb_keymap *updated, *updated2;
+        char *updated_dump;
+
+        updated = xkb_x11_keymap_new_from_event(keymap, conn,
+            (xcb_generic_event_t *) &map_notify);
+        assert(updated && updated != keymap);
+        updated2 = xkb_x11_keymap_new_from_event(updated, conn,
+            (xcb_generic_event_t *) &names_notify);
+        assert(updated2 && updated2 != updated);
+        xkb_keymap_unref(updated);
+
+        updated_dump = xkb_keymap_get_as_string(updated2,
+                                                XKB_KEYMAP_FORMAT_TEXT_V1);
+        assert(updated_dump);
+        assert(streq(dump, updated_dump));
+        free(updated_dump);
+        xkb_keymap_unref(updated2);
+
+        /* Only the key behaviors changed, which aren't used. */
+        map_notify.changed = XCB_XKB_MAP_PART_KEY_BEHAVIORS;
+        updated = xkb_x11_keymap_new_from_event(keymap, conn,
+            (xcb_generic_event_t *) &map_notify);
+        assert(updated == keymap);
+        xkb_keymap_unref(updated);
+    }
 
     free(dump);
     xkb_state_unref(state);
     xkb_keymap_unref(keymap);
+    xkb_x11_context_forget_connection(ctx, conn);
     xcb_disconnect(conn);
     xkb_context_unref(ctx);
 
@@ -135,6 +135,7 @@ xkb_x11_get_core_keyboard_device_id(xcb_connection_t *connection);
  *
  * @returns A keymap retrieved from the X server, or NULL on failure.
  *
+ * @sa xkb_x11_context_forget_connection()
  * @memberof xkb_keymap
  */
 struct xkb_keymap *
@@ -143,6 +144,63 @@ xkb_x11_keymap_new_from_device(struct xkb_context *context,
                                int32_t device_id,
                                enum xkb_keymap_compile_flags flags);
 
+/**
+ * Forget what a context remembers about an X11 connection.
+ *
+ * So that fetching a keymap again is faster, the context remembers the
+ * names of the X atoms used by the keymaps fetched from a connection.
+ * These are only valid for that connection.  Call this function before
+ * closing the connection with xcb_disconnect(), since a later connection
+ * may get the same address.
+ *
+ * @param context
+ *     The context in which keymaps were created from @p connection.
+ * @param connection
+ *     An XCB connection to the X server.
+ *
+ * @memberof xkb_context
+ * @since 0.5.0
+ */
+void
+xkb_x11_context_forget_connection(struct xkb_context *context,
+                                  xcb_connection_t *connection);
+
+/**
+ * Create a keymap from another one and the changes reported by an XKB
+ * event.
+ *
+ * When the keymap of a keyboard device changes, the X server sends an
+ * XkbMapNotify event for the keys and an XkbNamesNotify event for the
+ * names which changed (if they were selected with
+ * xcb_xkb_select_events()). Instead of fetching the whole keymap again
+ * with xkb_x11_keymap_new_from_device(), this function fetches only what
+ * changed, and shares the rest with @p keymap.
+ *
+ * Changes which can't be applied by themselves, for instance to the key
+ * types, the virtual modifiers or the range of keycodes, cause the whole
+ * keymap to be fetched, as with xkb_x11_keymap_new_from_device().
+ *
+ * @param keymap
+ *     The current keymap of the device the event is for, as created by
+ *     xkb_x11_keymap_new_from_device() or this function.
+ * @param connection
+ *     An XCB connection to the X server.
+ * @param event
+ *     An XkbMapNotify or XkbNamesNotify event. Other events are an
+ *     error.
+ *
+ * @returns The updated keymap, or NULL on failure. If nothing this
+ *          library uses has changed, this is a new reference to @p
+ *          keymap.
+ *
+ * @memberof xkb_keymap
+ * @since 0.5.0
+ */
+struct xkb_keymap *
+xkb_x11_keymap_new_from_event(struct xkb_keymap *keymap,
+                              xcb_connection_t *connection,
+                              const xcb_generic_event_t *event);
+
 /**
  * Create a new keyboard state object from an X11 keyboard device.
  *
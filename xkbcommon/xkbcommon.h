@@ -470,6 +470,38 @@ xkb_keysym_from_name(const char *name, enum xkb_keysym_flags flags);
 int
 xkb_keysym_to_utf8(xkb_keysym_t keysym, char *buffer, size_t size);
 
+/**
+ * Get the Unicode/UTF-8 representation of an array of keysyms.
+ *
+ * The representations of the keysyms are concatenated; keysyms which do
+ * not have a Unicode representation are skipped.
+ *
+ * @param[in]  keysyms     The keysyms.
+ * @param[in]  num_keysyms The number of keysyms.
+ * @param[out] buffer      A buffer to write the UTF-8 string into.
+ * @param[in]  size        The size of buffer.
+ *
+ * @warning If the buffer passed is too small, the string is truncated
+ * (though still NUL-terminated), but never in the middle of the
+ * representation of a keysym.
+ *
+ * @returns The number of bytes required for the string, excluding the
+ * NUL byte.  If there is nothing to write, returns 0.
+ *
+ * You may check if truncation has occurred by comparing the return value
+ * with the size of @p buffer, similarly to the snprintf(3) function.
+ * You may safely pass NULL and 0 to @p buffer and @p size to find the
+ * required size (without the NUL-byte).
+ *
+ * This function does not perform any @ref keysym-transformations.
+ *
+ * @sa xkb_keysym_to_utf8()
+ * @since 0.5.0
+ */
+int
+xkb_keysyms_to_utf8(const xkb_keysym_t *keysyms, size_t num_keysyms,
+                    char *buffer, size_t size);
+
 /**
  * Get the Unicode/UTF-32 representation of a keysym.
  *
@@ -507,7 +539,39 @@ enum xkb_context_flags {
      * Don't take RMLVO names from the environment.
      * @since 0.3.0
      */
-    XKB_CONTEXT_NO_ENVIRONMENT_NAMES = (1 << 1)
+    XKB_CONTEXT_NO_ENVIRONMENT_NAMES = (1 << 1),
+    /**
+     * Share keymaps created with xkb_keymap_new_from_names() in this
+     * context.
+     *
+     * If a keymap compiled from equivalent RMLVO names and the same flags
+     * is still alive, xkb_keymap_new_from_names() returns a new reference
+     * to it instead of compiling a new one.  Keymaps are immutable, so
+     * this is transparent to the caller.  A keymap is dropped from the
+     * cache when its last reference is released, and the whole cache is
+     * dropped when the include path of the context changes.
+     *
+     * @since 0.5.0
+     */
+    XKB_CONTEXT_CACHE_KEYMAPS = (1 << 2),
+    /**
+     * Allow keymaps to be created in this context from several threads at
+     * once, e.g. by a pool of workers, sharing the interned names and the
+     * compiled rules files.
+     *
+     * The keymap creation functions, and the functions which only
+     * query the context, may then be called concurrently.  Changing the
+     * context itself (the include path, the logging settings, the user
+     * data) is still not thread-safe, and should be done before it is
+     * shared.  Keymaps are immutable, and may be used and referenced from
+     * any thread; keyboard states may not be shared.
+     *
+     * This requires compiler support for thread-local storage; without it,
+     * xkb_context_new() fails with this flag.
+     *
+     * @since 0.5.0
+     */
+    XKB_CONTEXT_THREAD_SAFE = (1 << 3)
 };
 
 /**
@@ -521,6 +585,11 @@ enum xkb_context_flags {
  * the context. See e.g. xkb_context_set_log_level() and
  * xkb_context_set_log_verbosity().
  *
+ * Rules files are compiled once per context. If the XKB_RULES_CACHE_DIR
+ * environment variable is set, the compiled rules are also cached in that
+ * directory, and reused by other contexts and processes as long as the
+ * rules file is not modified.
+ *
  * @memberof xkb_context
  */
 struct xkb_context *
@@ -587,6 +656,11 @@ xkb_context_get_user_data(struct xkb_context *context);
 /**
  * Append a new entry to the context's include path.
  *
+ * The entry is either a directory, or a regular file which is a packed
+ * archive of such a directory, as created by the xkb-pack tool.  Files are
+ * then read directly from the archive, without a file system lookup for
+ * each of them.  Support for archives is available since version 0.5.0.
+ *
  * @returns 1 on success, or 0 if the include path could not be added or is
  * inaccessible.
  *
@@ -645,6 +719,41 @@ xkb_context_num_include_paths(struct xkb_context *context);
 const char *
 xkb_context_include_path_get(struct xkb_context *context, unsigned int index);
 
+/**
+ * Set a function which provides files from memory.
+ *
+ * @param context    The context in which to use the function.
+ * @param include_fn The function that will be called whenever a file is
+ * needed, before the include path is searched.  Passing NULL removes it.
+ *
+ * This allows compiling keymaps from data bundled with the application,
+ * without accessing the file system.  @a type is the kind of file needed,
+ * which is also the name of the directory it would be found in under an
+ * include path: "rules", "keycodes", "types", "compat", "symbols",
+ * "geometry" or "keymap".  @a name is the name of the file, as given in an
+ * include statement or in the RMLVO names.
+ *
+ * If the function provides the file, it should set @a buffer_out and
+ * @a length_out to its contents and return 1.  The buffer must remain
+ * valid until the function which needed the file (e.g.
+ * xkb_keymap_new_from_names()) returns.  Otherwise, it should return 0,
+ * and the file is looked up in the include path as usual.
+ *
+ * You may use xkb_context_set_user_data() on the context, and then call
+ * xkb_context_get_user_data() from within the function to provide it with
+ * additional private context.
+ *
+ * @memberof xkb_context
+ * @since 0.5.0
+ */
+void
+xkb_context_set_include_fn(struct xkb_context *context,
+                           int (*include_fn)(struct xkb_context *context,
+                                             const char *type,
+                                             const char *name,
+                                             const char **buffer_out,
+                                             size_t *length_out));
+
 /** @} */
 
 /**
@@ -780,10 +889,107 @@ xkb_keymap_new_from_names(struct xkb_context *context,
                           const struct xkb_rule_names *names,
                           enum xkb_keymap_compile_flags flags);
 
+/**
+ * Create a keymap from RMLVO names, reusing parts of an existing keymap.
+ *
+ * This is like xkb_keymap_new_from_names(), but is much faster when the
+ * new RMLVO names differ from those @p base was created with only in
+ * ways which leave some of the keymap components unchanged, as is
+ * typical when toggling a single option.  Sections of @p base whose
+ * components are unchanged are reused instead of being compiled again;
+ * the symbols section is always compiled anew.
+ *
+ * The new keymap is created in the context of @p base.  If @p base was
+ * not created from RMLVO names, the new keymap is compiled from scratch.
+ *
+ * @param base  The keymap to derive the new keymap from.
+ * @param names The RMLVO names to use.  See xkb_rule_names.
+ * @param flags Optional flags for the keymap, or 0.
+ *
+ * @returns A keymap compiled according to the RMLVO names, or NULL if
+ * the compilation failed.
+ *
+ * @sa xkb_keymap_new_from_names()
+ * @memberof xkb_keymap
+ * @since 0.5.0
+ */
+struct xkb_keymap *
+xkb_keymap_new_from_names_derived(struct xkb_keymap *base,
+                                  const struct xkb_rule_names *names,
+                                  enum xkb_keymap_compile_flags flags);
+
+/**
+ * The keymap components which a set of RMLVO names resolve to, also known
+ * as KcCGST.  The geometry component is not used by this library and is
+ * not included.
+ *
+ * @sa xkb_context_resolve_rule_names()
+ * @since 0.5.0
+ */
+struct xkb_component_names {
+    /** The keycodes, e.g. "evdev+aliases(qwerty)". */
+    char *keycodes;
+    /** The key types, e.g. "complete". */
+    char *types;
+    /** The compatibility map, e.g. "complete". */
+    char *compat;
+    /** The symbols, e.g. "pc+us+inet(evdev)". */
+    char *symbols;
+};
+
+/**
+ * Resolve several sets of RMLVO names to the keymap components which
+ * xkb_keymap_new_from_names() would compile for them, without compiling
+ * anything.
+ *
+ * Each rules file is only looked up and parsed once for the whole batch;
+ * each set of names then only costs the matching against it.  This is
+ * useful to find out which keymaps a large number of configurations
+ * give, e.g. to generate them ahead of time.
+ *
+ * @param context        The context in which to look up the rules.
+ * @param names          An array of @p num_names sets of RMLVO names.
+ * Empty fields take default values, as with xkb_keymap_new_from_names().
+ * @param num_names      The number of sets of names.
+ * @param components_out An array of @p num_names components, each
+ * filled with the components of the matching names.  The strings are
+ * allocated, and should be freed with free() by the caller.  The entries
+ * for the names which could not be resolved are set to NULL.
+ *
+ * @returns The number of sets of names which were resolved.
+ *
+ * @sa xkb_rule_names xkb_component_names
+ * @memberof xkb_context
+ * @since 0.5.0
+ */
+size_t
+xkb_context_resolve_rule_names(struct xkb_context *context,
+                               const struct xkb_rule_names *names,
+                               size_t num_names,
+                               struct xkb_component_names *components_out);
+
 /** The possible keymap formats. */
 enum xkb_keymap_format {
     /** The current/classic XKB text format, as generated by xkbcomp -xkb. */
-    XKB_KEYMAP_FORMAT_TEXT_V1 = 1
+    XKB_KEYMAP_FORMAT_TEXT_V1 = 1,
+    /**
+     * A compact binary form of a compiled keymap, which is loaded without
+     * parsing or compiling anything, so much faster than the text format.
+     *
+     * Keymaps can be written in this format with xkb_keymap_write(),
+     * xkb_keymap_write_to_fd() or xkb_keymap_get_as_fd(), and loaded with
+     * xkb_keymap_new_from_buffer() or xkb_keymap_new_from_file().  It
+     * contains NUL bytes, so xkb_keymap_get_as_string() and
+     * xkb_keymap_new_from_string() do not support it; anything following
+     * the keymap in the buffer, such as a terminating NUL byte, is ignored.
+     *
+     * Keymaps loaded this way have nothing to share with
+     * xkb_keymap_new_from_names_derived(), which compiles the new keymap
+     * from scratch.
+     *
+     * @since 0.5.0
+     */
+    XKB_KEYMAP_FORMAT_BINARY_V1 = 2
 };
 
 /**
@@ -872,7 +1078,8 @@ xkb_keymap_unref(struct xkb_keymap *keymap);
  * in the special value XKB_KEYMAP_USE_ORIGINAL_FORMAT to use the format
  * from which the keymap was originally created.
  *
- * @returns The keymap as a NUL-terminated string, or NULL if unsuccessful.
+ * @returns The keymap as a NUL-terminated string, or NULL if unsuccessful,
+ * including if the format is not a text format.
  *
  * The returned string may be fed back into xkb_map_new_from_string() to get
  * the exact same keymap (possibly in another process, etc.).
@@ -886,6 +1093,82 @@ char *
 xkb_keymap_get_as_string(struct xkb_keymap *keymap,
                          enum xkb_keymap_format format);
 
+/**
+ * Write the compiled keymap, as returned by xkb_keymap_get_as_string(),
+ * through a function.
+ *
+ * @param keymap    The keymap to write.
+ * @param format    The keymap format to use, or
+ * XKB_KEYMAP_USE_ORIGINAL_FORMAT.
+ * @param write_fn  Called with consecutive pieces of the string, which
+ * are not NUL-terminated, in order.  It should return 1 on success, or 0
+ * to stop the writing.
+ * @param user_data Passed to write_fn.
+ *
+ * @returns 1 on success, or 0 if unsuccessful, including if write_fn
+ * returned 0.  In that case, part of the keymap may have been written.
+ *
+ * Unlike xkb_keymap_get_as_string(), this does not need memory for the
+ * whole string, and does not write the terminating NUL byte.
+ *
+ * @memberof xkb_keymap
+ * @since 0.5.0
+ */
+int
+xkb_keymap_write(struct xkb_keymap *keymap, enum xkb_keymap_format format,
+                 int (*write_fn)(void *user_data, const char *data,
+                                 size_t length),
+                 void *user_data);
+
+/**
+ * Write the compiled keymap, as returned by xkb_keymap_get_as_string(),
+ * to a file descriptor, e.g. one which is shared with a client.
+ *
+ * @returns 1 on success, or 0 if unsuccessful.  If writing to the file
+ * descriptor failed, errno is set.
+ *
+ * The terminating NUL byte is not written.
+ *
+ * @sa xkb_keymap_write()
+ * @memberof xkb_keymap
+ * @since 0.5.0
+ */
+int
+xkb_keymap_write_to_fd(struct xkb_keymap *keymap,
+                       enum xkb_keymap_format format, int fd);
+
+/**
+ * Get the compiled keymap, as written by xkb_keymap_write() and followed
+ * by a NUL byte, in a sealed, read-only file descriptor, suitable for
+ * sharing with clients, e.g. over the Wayland wl_keyboard.keymap event.
+ *
+ * @param keymap    The keymap to get.
+ * @param format    The keymap format to use, or
+ * XKB_KEYMAP_USE_ORIGINAL_FORMAT.
+ * @param size_out  If not NULL, set to the size of the contents,
+ * including the NUL byte.
+ *
+ * @returns A file descriptor, or -1 if unsuccessful, in which case errno
+ * is set.  It is ENOSYS if sealed file descriptors are not supported by
+ * the system.
+ *
+ * The file descriptor is owned by the keymap, and is the same on every
+ * call with the same format; it must not be closed, and remains valid
+ * until the keymap is freed.  It cannot be written to, resized or
+ * resealed, so it can be handed to any number of clients, which should
+ * map it with mmap() and MAP_PRIVATE rather than read() it, since its
+ * file offset is shared.
+ *
+ * The keymap is serialized only once per format, for this and for
+ * xkb_keymap_get_as_string().
+ *
+ * @memberof xkb_keymap
+ * @since 0.5.0
+ */
+int
+xkb_keymap_get_as_fd(struct xkb_keymap *keymap, enum xkb_keymap_format format,
+                     size_t *size_out);
+
 /** @} */
 
 /**